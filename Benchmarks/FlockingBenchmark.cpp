@@ -0,0 +1,185 @@
+/*
+Benchmarks for the Flocking module. Each case prints how long the new path takes next to the path it replaced.
+There is no build system here, so build it from the root of the repo with something like
+	g++ -O2 -std=c++11 -I. Benchmarks/FlockingBenchmark.cpp Flocking/SpatialGrid.cpp Flocking/FlockKernels.cpp Math/SIMD.cpp -o FlockingBenchmark
+
+Neighbor queries: finding every agent's neighbors with the SpatialGrid against comparing every pair of agents,
+which is what Flock::Update did with FlockingList. The agents are spread out so each one has about 20 neighbors.
+Comparing every pair takes minutes at 100k agents, so it is timed on the first PairSample agents and scaled up to the whole flock.
+
+Steering kernels: adding up one agent's neighbors with the scalar kernel against the SSE and AVX2 kernels.
+Kernels the CPU doesn't support are skipped.
+*/
+
+#include <chrono>
+#include <math.h>
+#include <random>
+#include <stdio.h>
+#include <vector>
+
+#include "Flocking/FlockKernels.h"
+#include "Flocking/SpatialGrid.h"
+#include "Math/SIMD.h"
+
+namespace
+{
+	typedef std::chrono::steady_clock Clock;
+
+	const size_t PairSample = 1000;
+	const float NeighborDistance = 1.0f;
+	const float NeighborsPerAgent = 20.0f;
+
+	// Results are stored here so the compiler can't skip the work that made them
+	volatile float s_Sink;
+
+	double Milliseconds(Clock::time_point i_Start)
+	{
+		return std::chrono::duration<double, std::milli>(Clock::now() - i_Start).count();
+	}
+
+	struct Agents
+	{
+		std::vector<float> x, y, z;
+	};
+
+	// Spreads count agents through a cube sized so each has about NeighborsPerAgent neighbors
+	void Scatter(size_t count, Agents& o_Agents)
+	{
+		const float volumePerAgent = (4.0f / 3.0f) * 3.14159265f * NeighborDistance * NeighborDistance * NeighborDistance / NeighborsPerAgent;
+		const float side = cbrtf(volumePerAgent * count);
+
+		std::mt19937 random(1234);
+		std::uniform_real_distribution<float> position(0.0f, side);
+		o_Agents.x.resize(count);
+		o_Agents.y.resize(count);
+		o_Agents.z.resize(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			o_Agents.x[i] = position(random);
+			o_Agents.y[i] = position(random);
+			o_Agents.z[i] = position(random);
+		}
+	}
+
+	void NeighborQueries()
+	{
+		printf("Neighbor queries (about %.0f neighbors each)\n", NeighborsPerAgent);
+		printf("%10s %14s %14s %10s\n", "agents", "grid ms", "all pairs ms", "speedup");
+
+		const size_t counts[] = { 1000, 5000, 10000, 50000, 100000 };
+		const float radiusSqr = NeighborDistance * NeighborDistance;
+		std::vector<size_t> neighbors;
+		for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++)
+		{
+			const size_t count = counts[c];
+			Agents agents;
+			Scatter(count, agents);
+
+			// A frame rebuilds the grid and then queries every agent
+			AI::SpatialGrid grid;
+			size_t gridFound = 0;
+			Clock::time_point start = Clock::now();
+			grid.Build(agents.x.data(), agents.y.data(), agents.z.data(), count, NeighborDistance);
+			for (size_t i = 0; i < count; i++)
+			{
+				neighbors.clear();
+				grid.Query(agents.x[i], agents.y[i], agents.z[i], radiusSqr, i, neighbors);
+				gridFound += neighbors.size();
+			}
+			const double gridTime = Milliseconds(start);
+
+			const size_t sample = count < PairSample ? count : PairSample;
+			size_t pairFound = 0;
+			start = Clock::now();
+			for (size_t i = 0; i < sample; i++)
+			{
+				for (size_t j = 0; j < count; j++)
+				{
+					const float dx = agents.x[j] - agents.x[i];
+					const float dy = agents.y[j] - agents.y[i];
+					const float dz = agents.z[j] - agents.z[i];
+					if (j != i && dx * dx + dy * dy + dz * dz < radiusSqr)
+					{
+						pairFound++;
+					}
+				}
+			}
+			const double pairTime = Milliseconds(start) * count / sample;
+
+			printf("%10zu %14.2f %14.2f %9.1fx   (%zu neighbors found, %zu in the pair sample)\n", count, gridTime, pairTime, pairTime / gridTime, gridFound, pairFound);
+		}
+		printf("\n");
+	}
+
+	void SteeringKernels()
+	{
+		const Math::SIMD::Level level = Math::SIMD::Supported();
+		struct Kernel
+		{
+			const char* name;
+			AI::FlockKernels::AccumulateFunction function;
+			bool supported;
+		};
+		const Kernel kernels[] =
+		{
+			{ "Scalar", AI::FlockKernels::AccumulateScalar, true },
+			{ "SSE", AI::FlockKernels::AccumulateSSE, level >= Math::SIMD::SSE2 },
+			{ "AVX2", AI::FlockKernels::AccumulateAVX2, level >= Math::SIMD::AVX2 },
+		};
+		const size_t kernelCount = sizeof(kernels) / sizeof(kernels[0]);
+
+		printf("Steering kernels (ns per agent)\n");
+		printf("%10s", "neighbors");
+		for (size_t k = 0; k < kernelCount; k++)
+		{
+			printf(" %10s", kernels[k].name);
+		}
+		printf("\n");
+
+		std::mt19937 random(99);
+		std::uniform_real_distribution<float> value(-5.0f, 5.0f);
+		const size_t counts[] = { 8, 20, 64, 256 };
+		for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++)
+		{
+			AI::NeighborBlock neighbors;
+			for (size_t i = 0; i < counts[c]; i++)
+			{
+				neighbors.Add(value(random), value(random), value(random), value(random), value(random), value(random));
+			}
+
+			// About the same number of neighbors are added up for every count
+			const size_t repeats = 20000000 / counts[c];
+			printf("%10zu", counts[c]);
+			for (size_t k = 0; k < kernelCount; k++)
+			{
+				if (!kernels[k].supported)
+				{
+					printf(" %10s", "skipped");
+					continue;
+				}
+
+				// Moving the agent a little each time keeps the compiler from hoisting the call out of the loop
+				AI::SteeringSums sums;
+				float total = 0;
+				const Clock::time_point start = Clock::now();
+				for (size_t r = 0; r < repeats; r++)
+				{
+					kernels[k].function(neighbors, r * 1e-6f, 0.5f, -0.5f, sums);
+					total += sums.separationX;
+				}
+				const double nanoseconds = Milliseconds(start) * 1e6 / repeats;
+				s_Sink = total;
+				printf(" %10.1f", nanoseconds);
+			}
+			printf("\n");
+		}
+		printf("\n");
+	}
+}
+
+int main()
+{
+	NeighborQueries();
+	SteeringKernels();
+	return 0;
+}
@@ -0,0 +1,174 @@
+/*
+Benchmarks for the Math module. Each case prints how long the new path takes next to the path it replaced.
+There is no build system here, so build it from the root of the repo with something like
+	g++ -O2 -std=c++14 -I. Benchmarks/MathBenchmark.cpp Math/Vector3.cpp Math/Functions.cpp Math/SIMD.cpp -o MathBenchmark
+
+Vector chain: r = (a + b) * s + c and then Dot(r, d) for a million sets of vectors, with the Vector3 that cached its length
+(copied below as it was, since it is gone from Math), today's Vector3 and AlignedVector3.
+
+Easing tables: easing a million random percents with the exact functions in Functions.h against an EasingTable<256>,
+followed by the error report for EasingTable.h: the largest error of every curve at resolutions 64, 256 and 1024.
+*/
+
+#include <chrono>
+#include <math.h>
+#include <random>
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+#include "Math/AlignedVector3.h"
+#include "Math/EasingTable.h"
+#include "Math/Functions.h"
+#include "Math/Vector3.h"
+
+namespace
+{
+	typedef std::chrono::steady_clock Clock;
+
+	// Results are stored here so the compiler can't skip the work that made them
+	volatile float s_Sink;
+
+	double Nanoseconds(Clock::time_point i_Start)
+	{
+		return std::chrono::duration<double, std::nano>(Clock::now() - i_Start).count();
+	}
+
+	// Vector3 before it dropped its cached length. Every new vector works out its length with a square root.
+	class CachedLengthVector3
+	{
+	public:
+		CachedLengthVector3() : _x(0), _y(0), _z(0), _length(0) {}
+		CachedLengthVector3(float x, float y, float z) : _x(x), _y(y), _z(z) { CalculateLength(); }
+
+		CachedLengthVector3 operator +(const CachedLengthVector3& rhs) const { return CachedLengthVector3(_x + rhs._x, _y + rhs._y, _z + rhs._z); }
+		CachedLengthVector3 operator *(const float rhs) const { return CachedLengthVector3(_x * rhs, _y * rhs, _z * rhs); }
+		friend float Dot(const CachedLengthVector3& lhs, const CachedLengthVector3& rhs) { return lhs._x * rhs._x + lhs._y * rhs._y + lhs._z * rhs._z; }
+
+	private:
+		void CalculateLength() { _length = sqrtf(_x * _x + _y * _y + _z * _z); }
+
+		float _x, _y, _z, _length;
+	};
+
+	template<typename Vector>
+	double Chain(const std::vector<float>& i_Values, size_t i_Count, size_t i_Repeats)
+	{
+		std::vector<Vector> a(i_Count), b(i_Count), c(i_Count), d(i_Count);
+		for (size_t i = 0; i < i_Count; i++)
+		{
+			const float* v = &i_Values[i * 12];
+			a[i] = Vector(v[0], v[1], v[2]);
+			b[i] = Vector(v[3], v[4], v[5]);
+			c[i] = Vector(v[6], v[7], v[8]);
+			d[i] = Vector(v[9], v[10], v[11]);
+		}
+
+		float total = 0;
+		const Clock::time_point start = Clock::now();
+		for (size_t r = 0; r < i_Repeats; r++)
+		{
+			const float scale = 0.5f + r * 0.001f;
+			for (size_t i = 0; i < i_Count; i++)
+			{
+				const Vector result = (a[i] + b[i]) * scale + c[i];
+				total += Dot(result, d[i]);
+			}
+		}
+		const double time = Nanoseconds(start) / (i_Count * i_Repeats);
+		s_Sink = total;
+		return time;
+	}
+
+	static const char* s_CurveNames[Math::Easing::CurveCount] =
+	{
+		"InSin", "OutSin", "InOutSin", "InCirc", "OutCirc", "InOutCirc", "InQuad", "OutQuad", "InOutQuad",
+	};
+
+	typedef float (*ExactEase)(float, float, float);
+	static const ExactEase s_Exact[Math::Easing::CurveCount] =
+	{
+		Math::EaseInSin, Math::EaseOutSin, Math::EaseInOutSin,
+		Math::EaseInCirc, Math::EaseOutCirc, Math::EaseInOutCirc,
+		Math::EaseInQuad, Math::EaseOutQuad, Math::EaseInOutQuad,
+	};
+
+	static const Math::EasingTable<64> s_Table64;
+	static const Math::EasingTable<256> s_Table256;
+	static const Math::EasingTable<1024> s_Table1024;
+
+	void EasingTables()
+	{
+		const size_t count = 1000000;
+		std::mt19937 random(8);
+		std::uniform_real_distribution<float> value(0.0f, 1.0f);
+		std::vector<float> percents(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			percents[i] = value(random);
+		}
+
+		printf("Easing one value (ns per value)\n");
+		printf("%10s %10s %10s\n", "curve", "exact", "table 256");
+		for (size_t c = 0; c < Math::Easing::CurveCount; c++)
+		{
+			const Math::Easing::Curve curve = static_cast<Math::Easing::Curve>(c);
+			const ExactEase exact = s_Exact[c];
+
+			float total = 0;
+			Clock::time_point start = Clock::now();
+			for (size_t i = 0; i < count; i++)
+			{
+				total += exact(-2.0f, 3.0f, percents[i]);
+			}
+			const double exactTime = Nanoseconds(start) / count;
+
+			start = Clock::now();
+			for (size_t i = 0; i < count; i++)
+			{
+				total += s_Table256.Ease(curve, -2.0f, 3.0f, percents[i]);
+			}
+			const double tableTime = Nanoseconds(start) / count;
+			s_Sink = total;
+
+			printf("%10s %10.2f %10.2f\n", s_CurveNames[c], exactTime, tableTime);
+		}
+		printf("\n");
+
+		printf("Largest error of the tables against the exact functions\n");
+		printf("%10s %10s %10s %10s\n", "curve", "64", "256", "1024");
+		for (size_t c = 0; c < Math::Easing::CurveCount; c++)
+		{
+			const Math::Easing::Curve curve = static_cast<Math::Easing::Curve>(c);
+			printf("%10s %10.1e %10.1e %10.1e\n", s_CurveNames[c], s_Table64.MaxError(curve), s_Table256.MaxError(curve), s_Table1024.MaxError(curve));
+		}
+		printf("%10s %10zu %10zu %10zu\n\n", "bytes", sizeof(s_Table64), sizeof(s_Table256), sizeof(s_Table1024));
+	}
+
+	void VectorChain()
+	{
+		const size_t count = 1000000;
+		const size_t repeats = 10;
+		std::mt19937 random(3);
+		std::uniform_real_distribution<float> value(-10.0f, 10.0f);
+		std::vector<float> values(count * 12);
+		for (size_t i = 0; i < values.size(); i++)
+		{
+			values[i] = value(random);
+		}
+
+		printf("Add, scale, add and dot chain (ns per chain)\n");
+		printf("%16s %16s %16s\n", "cached length", "Vector3", "AlignedVector3");
+		const double cached = Chain<CachedLengthVector3>(values, count, repeats);
+		const double plain = Chain<Math::Vector3>(values, count, repeats);
+		const double aligned = Chain<Math::AlignedVector3>(values, count, repeats);
+		printf("%16.2f %16.2f %16.2f\n\n", cached, plain, aligned);
+	}
+}
+
+int main()
+{
+	VectorChain();
+	EasingTables();
+	return 0;
+}
@@ -0,0 +1,384 @@
+/*
+Benchmarks for the SmallBlockAllocator module. Each case prints how long the new path takes next to the path it replaced.
+There is no build system here, so build it from the root of the repo with something like
+	g++ -O2 -std=c++17 -pthread -I. Benchmarks/SmallBlockAllocatorBenchmark.cpp -o SmallBlockAllocatorBenchmark
+
+Occupancy: a pool of 1M blocks is filled to 10, 50, 90 and 99 percent at random, then a random block is freed
+and a new one allocated over and over. The word scan column does the same with a plain array of words
+searched from the first word every time, which is what a search costs without the summary levels.
+
+Threads: 1 to 8 threads each allocate a block and free the one they allocated Window allocations ago, over and over,
+from one ConcurrentSmallBlockAllocator and from one SmallBlockAllocator behind a std::mutex.
+
+Page backing: every block of a 256 MiB pool is visited in a random order, each block holding the index of the next one,
+so every read misses the cache and most miss the TLB. The pool's blocks come from malloc, from an Arena with normal pages
+and from an Arena asking for huge pages. The huge page column says which kind of huge pages the Arena got.
+
+Batches: 65536 blocks are allocated and then freed, either with one AllocBatch and FreeBatch call or with a loop of Alloc and Free.
+
+Restore: a pool of 1M blocks holds a list of 32 byte nodes linked by Handle. Restore reads a file Save wrote and the list is walked.
+The rebuild column reads the same nodes from a plain file of records and allocates and links them one at a time,
+which is what a warm restart did before Save and Restore. Both files were just written, so both are read from the page cache.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <stdint.h>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+#include "Bitfield/BitOps.h"
+#include "SmallBlockAllocator/ConcurrentSmallBlockAllocator.h"
+#include "SmallBlockAllocator/SmallBlockAllocator.h"
+
+namespace
+{
+	typedef std::chrono::steady_clock Clock;
+
+	const size_t BlockSize = 32;
+	const size_t PoolBlocks = static_cast<size_t>(1) << 20;
+
+	// Results are stored here so the compiler can't skip the work that made them
+	volatile uintptr_t s_Sink;
+
+	double Nanoseconds(Clock::time_point i_Start)
+	{
+		return std::chrono::duration<double, std::nano>(Clock::now() - i_Start).count();
+	}
+
+	// Fills the pool and then frees blocks at random until only the percent asked for are left in use
+	void FillTo(Memory::SmallBlockAllocator& io_Allocator, double i_Occupancy, std::mt19937& io_Random, std::vector<void*>& o_Used)
+	{
+		o_Used.resize(PoolBlocks);
+		for (size_t i = 0; i < PoolBlocks; i++)
+		{
+			o_Used[i] = io_Allocator.Alloc(BlockSize);
+		}
+		const size_t keep = static_cast<size_t>(PoolBlocks * i_Occupancy);
+		while (o_Used.size() > keep)
+		{
+			const size_t pick = io_Random() % o_Used.size();
+			io_Allocator.Free(o_Used[pick]);
+			o_Used[pick] = o_Used.back();
+			o_Used.pop_back();
+		}
+	}
+
+	void Occupancy()
+	{
+		printf("Alloc and Free at different occupancies (%zu blocks, ns per Free and Alloc pair)\n", PoolBlocks);
+		printf("%10s %14s %14s\n", "occupancy", "summaries", "word scan");
+
+		const double occupancies[] = { 0.10, 0.50, 0.90, 0.99 };
+		const size_t rounds = 1000000;
+		for (size_t o = 0; o < sizeof(occupancies) / sizeof(occupancies[0]); o++)
+		{
+			std::mt19937 random(42);
+			Memory::SmallBlockAllocator* pAllocator = Memory::SmallBlockAllocator::Create(BlockSize, PoolBlocks);
+			std::vector<void*> used;
+			FillTo(*pAllocator, occupancies[o], random, used);
+
+			// The word scan starts from the same bits
+			const size_t wordCount = PoolBlocks / BitOps::BitsPerWord;
+			std::vector<uint64_t> words(wordCount, 0);
+			std::vector<size_t> usedIndices(used.size());
+			for (size_t i = 0; i < used.size(); i++)
+			{
+				const size_t index = (reinterpret_cast<char*>(used[i]) - reinterpret_cast<char*>(pAllocator->FromHandle(0))) / BlockSize;
+				usedIndices[i] = index;
+				words[index / BitOps::BitsPerWord] |= static_cast<uint64_t>(1) << (index % BitOps::BitsPerWord);
+			}
+
+			std::vector<size_t> picks(rounds);
+			for (size_t r = 0; r < rounds; r++)
+			{
+				picks[r] = random() % used.size();
+			}
+
+			Clock::time_point start = Clock::now();
+			for (size_t r = 0; r < rounds; r++)
+			{
+				pAllocator->Free(used[picks[r]]);
+				used[picks[r]] = pAllocator->Alloc(BlockSize);
+			}
+			const double summaries = Nanoseconds(start) / rounds;
+
+			start = Clock::now();
+			for (size_t r = 0; r < rounds; r++)
+			{
+				const size_t freed = usedIndices[picks[r]];
+				words[freed / BitOps::BitsPerWord] &= ~(static_cast<uint64_t>(1) << (freed % BitOps::BitsPerWord));
+
+				size_t word = 0;
+				while (words[word] == BitOps::AllSet)
+				{
+					word++;
+				}
+				const size_t bit = BitOps::CountTrailingZeros(~words[word]);
+				words[word] |= static_cast<uint64_t>(1) << bit;
+				usedIndices[picks[r]] = word * BitOps::BitsPerWord + bit;
+			}
+			const double wordScan = Nanoseconds(start) / rounds;
+			s_Sink = usedIndices[0];
+
+			printf("%9.0f%% %14.1f %14.1f\n", occupancies[o] * 100, summaries, wordScan);
+			delete pAllocator;
+		}
+		printf("\n");
+	}
+
+	// The SmallBlockAllocator with a lock around it, which is what threads had to share before the concurrent one
+	class LockedAllocator
+	{
+	public:
+		explicit LockedAllocator(Memory::SmallBlockAllocator* pAllocator) : _pAllocator(pAllocator) {}
+		~LockedAllocator() { delete _pAllocator; }
+
+		void* Alloc(size_t size)
+		{
+			std::lock_guard<std::mutex> lock(_Mutex);
+			return _pAllocator->Alloc(size);
+		}
+		void Free(void* ptr)
+		{
+			std::lock_guard<std::mutex> lock(_Mutex);
+			_pAllocator->Free(ptr);
+		}
+
+	private:
+		std::mutex _Mutex;
+		Memory::SmallBlockAllocator* _pAllocator;
+	};
+
+	// Runs threadCount threads that each churn through rounds allocations and returns the ns per allocation and free
+	template<typename Allocator>
+	double Churn(Allocator& io_Allocator, size_t threadCount, size_t rounds)
+	{
+		const size_t Window = 16;
+		std::vector<std::thread> threads;
+		const Clock::time_point start = Clock::now();
+		for (size_t t = 0; t < threadCount; t++)
+		{
+			threads.push_back(std::thread([&io_Allocator, rounds]()
+			{
+				void* held[Window] = {};
+				for (size_t r = 0; r < rounds; r++)
+				{
+					void*& slot = held[r % Window];
+					io_Allocator.Free(slot);
+					slot = io_Allocator.Alloc(BlockSize);
+				}
+				for (size_t i = 0; i < Window; i++)
+				{
+					io_Allocator.Free(held[i]);
+				}
+			}));
+		}
+		for (size_t t = 0; t < threadCount; t++)
+		{
+			threads[t].join();
+		}
+		return Nanoseconds(start) / (rounds * threadCount);
+	}
+
+	// Links every block into one random cycle and then follows it, returning the ns per block visited
+	double Chase(Memory::SmallBlockAllocator& io_Allocator, size_t i_BlockCount, std::mt19937& io_Random)
+	{
+		std::vector<size_t> order(i_BlockCount);
+		for (size_t i = 0; i < i_BlockCount; i++)
+		{
+			io_Allocator.Alloc(BlockSize);
+			order[i] = i;
+		}
+		std::shuffle(order.begin(), order.end(), io_Random);
+		for (size_t i = 0; i < i_BlockCount; i++)
+		{
+			*reinterpret_cast<size_t*>(io_Allocator.FromHandle(order[i])) = order[(i + 1) % i_BlockCount];
+		}
+
+		size_t handle = order[0];
+		const Clock::time_point start = Clock::now();
+		for (size_t i = 0; i < i_BlockCount; i++)
+		{
+			handle = *reinterpret_cast<size_t*>(io_Allocator.FromHandle(handle));
+		}
+		const double time = Nanoseconds(start) / i_BlockCount;
+		s_Sink = handle;
+		return time;
+	}
+
+	void PageBacking()
+	{
+		const size_t blockCount = (static_cast<size_t>(256) << 20) / BlockSize;
+		printf("Random reads over a 256 MiB pool (ns per block)\n");
+		printf("%14s %14s %14s\n", "malloc", "arena", "huge pages");
+
+		std::mt19937 random(5);
+		Memory::SmallBlockAllocator* pMalloc = Memory::SmallBlockAllocator::Create(BlockSize, blockCount);
+		const double fromMalloc = Chase(*pMalloc, blockCount, random);
+		delete pMalloc;
+
+		Memory::Arena::Options options;
+		Memory::SmallBlockAllocator* pArena = Memory::SmallBlockAllocator::Create(BlockSize, blockCount, options);
+		const double fromArena = Chase(*pArena, blockCount, random);
+		delete pArena;
+
+		options.hugePages = true;
+		Memory::SmallBlockAllocator* pHuge = Memory::SmallBlockAllocator::Create(BlockSize, blockCount, options);
+		const double fromHuge = Chase(*pHuge, blockCount, random);
+		const Memory::Arena::PageKind kind = pHuge->BlockArena()->HugePages();
+		delete pHuge;
+
+		static const char* s_Kinds[] = { "none", "transparent", "explicit" };
+		printf("%14.1f %14.1f %14.1f   (huge pages: %s)\n\n", fromMalloc, fromArena, fromHuge, s_Kinds[kind]);
+	}
+
+	void Batches()
+	{
+		const size_t blockCount = 65536;
+		const size_t repeats = 50;
+		printf("Allocating and freeing %zu blocks (ns per block)\n", blockCount);
+		printf("%14s %14s\n", "batch", "loop");
+
+		Memory::SmallBlockAllocator* pAllocator = Memory::SmallBlockAllocator::Create(BlockSize, blockCount);
+		std::vector<void*> ptrs(blockCount);
+
+		Clock::time_point start = Clock::now();
+		for (size_t r = 0; r < repeats; r++)
+		{
+			pAllocator->AllocBatch(blockCount, ptrs.data());
+			pAllocator->FreeBatch(ptrs.data(), blockCount);
+		}
+		const double batch = Nanoseconds(start) / (repeats * blockCount);
+
+		start = Clock::now();
+		for (size_t r = 0; r < repeats; r++)
+		{
+			for (size_t i = 0; i < blockCount; i++)
+			{
+				ptrs[i] = pAllocator->Alloc(BlockSize);
+			}
+			for (size_t i = 0; i < blockCount; i++)
+			{
+				pAllocator->Free(ptrs[i]);
+			}
+		}
+		const double loop = Nanoseconds(start) / (repeats * blockCount);
+		s_Sink = reinterpret_cast<uintptr_t>(ptrs[0]);
+
+		printf("%14.1f %14.1f\n\n", batch, loop);
+		delete pAllocator;
+	}
+
+	// A node of a list that is saved with its allocator, so it links to the next node by Handle instead of by pointer
+	struct Node
+	{
+		Memory::SmallBlockAllocator::Handle next;
+		uint64_t key;
+		uint64_t value[2];
+	};
+	static_assert(sizeof(Node) == BlockSize, "A node should fill a block");
+
+	uint64_t SumList(const Memory::SmallBlockAllocator& i_Allocator, Memory::SmallBlockAllocator::Handle i_Head)
+	{
+		uint64_t sum = 0;
+		for (Memory::SmallBlockAllocator::Handle handle = i_Head; handle != Memory::SmallBlockAllocator::InvalidHandle; )
+		{
+			const Node* pNode = reinterpret_cast<const Node*>(i_Allocator.FromHandle(handle));
+			sum += pNode->key + pNode->value[0];
+			handle = pNode->next;
+		}
+		return sum;
+	}
+
+	void Restore()
+	{
+		const char* savedPath = "SmallBlockAllocatorBenchmark.saved";
+		const char* recordsPath = "SmallBlockAllocatorBenchmark.records";
+		printf("Warm restart of a list of %zu nodes (ms)\n", PoolBlocks);
+		printf("%14s %14s\n", "restore", "rebuild");
+
+		// Build the list, then write it both ways
+		Memory::SmallBlockAllocator* pAllocator = Memory::SmallBlockAllocator::Create(BlockSize, PoolBlocks);
+		std::vector<Node> records(PoolBlocks);
+		Memory::SmallBlockAllocator::Handle head = Memory::SmallBlockAllocator::InvalidHandle;
+		for (size_t i = 0; i < PoolBlocks; i++)
+		{
+			Node* pNode = reinterpret_cast<Node*>(pAllocator->Alloc(BlockSize));
+			pNode->next = head;
+			pNode->key = i;
+			pNode->value[0] = i * 3;
+			pNode->value[1] = 0;
+			head = pAllocator->HandleOf(pNode);
+			records[i] = *pNode;
+		}
+		const uint64_t expected = SumList(*pAllocator, head);
+		pAllocator->Save(savedPath);
+		delete pAllocator;
+		FILE* pFile = fopen(recordsPath, "wb");
+		fwrite(records.data(), sizeof(Node), records.size(), pFile);
+		fclose(pFile);
+
+		Clock::time_point start = Clock::now();
+		pAllocator = Memory::SmallBlockAllocator::Restore(savedPath);
+		const uint64_t restoredSum = pAllocator != nullptr ? SumList(*pAllocator, head) : 0;
+		const double restore = Nanoseconds(start) / 1e6;
+		delete pAllocator;
+
+		start = Clock::now();
+		pAllocator = Memory::SmallBlockAllocator::Create(BlockSize, PoolBlocks);
+		pFile = fopen(recordsPath, "rb");
+		const size_t read = fread(records.data(), sizeof(Node), records.size(), pFile);
+		fclose(pFile);
+		Memory::SmallBlockAllocator::Handle rebuiltHead = Memory::SmallBlockAllocator::InvalidHandle;
+		for (size_t i = 0; i < read; i++)
+		{
+			Node* pNode = reinterpret_cast<Node*>(pAllocator->Alloc(BlockSize));
+			*pNode = records[i];
+			pNode->next = rebuiltHead;
+			rebuiltHead = pAllocator->HandleOf(pNode);
+		}
+		const uint64_t rebuiltSum = SumList(*pAllocator, rebuiltHead);
+		const double rebuild = Nanoseconds(start) / 1e6;
+		delete pAllocator;
+		s_Sink = static_cast<uintptr_t>(restoredSum + rebuiltSum);
+
+		remove(savedPath);
+		remove(recordsPath);
+		printf("%14.1f %14.1f%s\n\n", restore, rebuild, restoredSum == expected && rebuiltSum == expected ? "" : "   (the lists came back wrong)");
+	}
+
+	void Threads()
+	{
+		printf("Shared pool from many threads (%u hardware threads, ns per Alloc and Free pair)\n", std::thread::hardware_concurrency());
+		printf("%10s %14s %14s\n", "threads", "concurrent", "mutex");
+
+		const size_t rounds = 2000000;
+		const size_t threadCounts[] = { 1, 2, 4, 8 };
+		for (size_t c = 0; c < sizeof(threadCounts) / sizeof(threadCounts[0]); c++)
+		{
+			Memory::ConcurrentSmallBlockAllocator* pConcurrent = Memory::ConcurrentSmallBlockAllocator::Create(BlockSize, 4096);
+			const double concurrent = Churn(*pConcurrent, threadCounts[c], rounds / threadCounts[c]);
+			delete pConcurrent;
+
+			LockedAllocator locked(Memory::SmallBlockAllocator::Create(BlockSize, 4096));
+			const double mutex = Churn(locked, threadCounts[c], rounds / threadCounts[c]);
+
+			printf("%10zu %14.1f %14.1f\n", threadCounts[c], concurrent, mutex);
+		}
+		printf("\n");
+	}
+}
+
+int main()
+{
+	Occupancy();
+	Threads();
+	PageBacking();
+	Batches();
+	Restore();
+	return 0;
+}
@@ -0,0 +1,91 @@
+/*
+Small helpers for working on the 64 bit words of a Bitfield.
+They use the compiler's intrinsics so each one is a single instruction on modern CPUs.
+
+When compiled with AVX2 (/arch:AVX2 or -mavx2) counting the bits of many words at once works on 4 words at a time.
+Each byte is split into two 4 bit halves, and a shuffle looks up how many bits each half has in a 16 entry table.
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_MSC_VER)
+	#include <intrin.h>
+#endif
+#if defined(__AVX2__)
+	#include <immintrin.h>
+#endif
+
+namespace BitOps
+{
+	static const uint64_t AllSet = ~static_cast<uint64_t>(0);
+	static const size_t BitsPerWord = 64;
+
+	// Returns the index of the lowest set bit. value must not be 0.
+	inline unsigned int CountTrailingZeros(uint64_t value)
+	{
+#if defined(_MSC_VER) && defined(_M_X64)
+		unsigned long index;
+		_BitScanForward64(&index, value);
+		return static_cast<unsigned int>(index);
+#elif defined(_MSC_VER)
+		unsigned long index;
+		if (_BitScanForward(&index, static_cast<unsigned long>(value)))
+		{
+			return static_cast<unsigned int>(index);
+		}
+		_BitScanForward(&index, static_cast<unsigned long>(value >> 32));
+		return static_cast<unsigned int>(index) + 32;
+#else
+		return static_cast<unsigned int>(__builtin_ctzll(value));
+#endif
+	}
+
+	// Returns how many bits are set.
+	inline unsigned int PopCount(uint64_t value)
+	{
+#if defined(_MSC_VER) && defined(_M_X64)
+		return static_cast<unsigned int>(__popcnt64(value));
+#elif defined(_MSC_VER)
+		return __popcnt(static_cast<unsigned int>(value)) + __popcnt(static_cast<unsigned int>(value >> 32));
+#else
+		return static_cast<unsigned int>(__builtin_popcountll(value));
+#endif
+	}
+
+	// Returns how many bits are set in count words.
+	inline size_t PopCount(const uint64_t* pWords, size_t count)
+	{
+		size_t total = 0;
+		size_t i = 0;
+#if defined(__AVX2__)
+		const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+		const __m256i lowNibble = _mm256_set1_epi8(0x0F);
+		__m256i sums = _mm256_setzero_si256();
+		for (; i + 4 <= count; i += 4)
+		{
+			const __m256i words = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pWords + i));
+			const __m256i low = _mm256_shuffle_epi8(lookup, _mm256_and_si256(words, lowNibble));
+			const __m256i high = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(words, 4), lowNibble));
+			// Adds up the byte counts of each word into that word's lane
+			sums = _mm256_add_epi64(sums, _mm256_sad_epu8(_mm256_add_epi8(low, high), _mm256_setzero_si256()));
+		}
+		uint64_t lanes[4];
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), sums);
+		total = static_cast<size_t>(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+#endif
+		for (; i < count; i++)
+		{
+			total += PopCount(pWords[i]);
+		}
+		return total;
+	}
+
+	// Returns a word with the lowest count bits set. count must be 64 or less.
+	inline uint64_t LowMask(size_t count)
+	{
+		return count >= BitsPerWord ? AllSet : ((static_cast<uint64_t>(1) << count) - 1);
+	}
+}
@@ -6,13 +6,31 @@ The Bitfield is used to store multiple true/false values in one piece of data.
 While the bool data type is 1 byte, it can only hold 1 true/false value. 
 In reality, it only needs 1 bit. 
 A bitfield is good to use when you need to store many booleans at once.
+
+The bits are stored in 64 bit words so searching for a free or set bit can skip a whole word at a time,
+and then find the bit inside the word with a single bit scan instruction.
+The Bitfield also remembers where the first free and first set bits could be,
+so a search doesn't have to start back at bit 0 every time.
+
+Large Bitfields also keep summary levels on top of the words. Each summary bit stands for one word of the level below.
+The full summary has a bit set if that word is full, and the set summary has a bit set if that word has any bit set.
+A search starts at the top level and walks down one word per level,
+so finding a free or set bit costs the same no matter how full the field is.
 */
 
 #pragma once
 
+#include <stddef.h>
+#include <stdint.h>
+
 class Bitfield
 {
 public:
+	// Fields with more words than this keep summary levels.
+	static const size_t SummaryThreshold = 64;
+	// The most summary levels a field can have. 5 levels cover 2^36 bits with a single word at the top.
+	static const size_t MaxSummaryLevels = 5;
+
 	// Static failsafe constructors used to create a Bitfield. Will return NULL if no memory is available.
 	// fieldSize is how many bits are needed for our field.
 	static inline Bitfield* Create(const size_t fieldSize);
@@ -22,29 +40,118 @@ public:
 	// This should only be used when we know for certain there is enough memory, such as the initialization of a memory manager.
 	static inline Bitfield* Create(const size_t fieldSize, void*& io_pField);
 
+	// How much memory Create(fieldSize, io_pField) will use.
+	static inline size_t MemoryRequired(const size_t fieldSize);
+
+	// Wraps words that already hold a Bitfield, such as a saved Bitfield mapped in from a file. Nothing is copied or checked.
+	// pWords must hold StorageWords(fieldSize) words in the same order Words() gives them, and freeBits must match them.
+	// The Bitfield never frees pWords. Will return NULL if no memory is available.
+	static inline Bitfield* Attach(const size_t fieldSize, const size_t freeBits, uint64_t* pWords);
+	// Works out the free count and every summary level from the field's words again, replacing what was there.
+	// Use it after Attach when the words came from somewhere that can't be trusted, such as a file read back in.
+	// Returns false without changing anything if a bit past the end of the field is set.
+	inline bool Rescan();
+
+	// How many words a field of fieldSize bits keeps, counting its summary levels.
+	static inline size_t StorageWords(const size_t fieldSize);
+
 	inline ~Bitfield();
 
 	// Getters
 	const size_t FieldSize() const { return _FieldSize; }
 	const size_t FreeBits() const { return _FreeBits; }
+	const uint64_t* Words() const { return _pField; } // The words of the field followed by its summary levels. There are StorageWords(FieldSize()) of them.
 
 	// Overload operator [] to return true/false if bit is set/free.
-	inline bool operator[](size_t index);
+	inline bool operator[](size_t index) const;
 
 	// Accessors
-	inline bool FirstFreeBit(size_t& o_index); // Finds the first free bit. Returns false if no bit is free.
-	inline bool FirstSetBit(size_t& o_index); // Finds the first set bit. Returns false if no bit is set.
+	// These only move the search hints along, so they can be used on a const Bitfield such as MappedBitfield::Field(), but not from two threads at once.
+	inline bool FirstFreeBit(size_t& o_index) const; // Finds the first free bit. Returns false if no bit is free.
+	inline bool FirstSetBit(size_t& o_index) const; // Finds the first set bit. Returns false if no bit is set.
+	inline bool NextSetBit(size_t from, size_t& o_index) const; // Finds the first set bit at or after from. Returns false if there isn't one.
 	inline void SetBit(size_t i_index); // Sets a bit to 1.
 	inline void FreeBit(size_t i_index); // Sets a bit to 0.
 	inline void ToggleBit(size_t i_index); // Sets a bit to 1 if 0 and 0 if 1.
 
+	// Sets up to count free bits, a whole word at a time, lowest bits first so runs stay together.
+	// The index of each bit set is written to o_indices. Returns how many were set, which is less than count only if the field filled up.
+	inline size_t ClaimFreeBits(size_t count, size_t* o_indices);
+	// Sets every bit in indices to 0. Neighboring indices in the same word are cleared together.
+	inline void ReleaseBits(const size_t* indices, size_t count);
+
+	// Range operations on the bits [begin, begin + count). Bits past the end of the field are ignored.
+	// Whole words inside the range are filled or counted at once instead of bit by bit.
+	inline void SetRange(size_t begin, size_t count);
+	inline void ClearRange(size_t begin, size_t count);
+	inline size_t CountRange(size_t begin, size_t count) const; // Returns how many bits in the range are set.
+
+	// Combines every bit with the same bit of other. Bits past the end of other count as 0.
+	inline void And(const Bitfield& other);
+	inline void Or(const Bitfield& other);
+	inline void Xor(const Bitfield& other);
+	inline void AndNot(const Bitfield& other); // Clears every bit that is set in other.
+
+	// Calls function(index) for every set bit, lowest first. The function must not change this Bitfield.
+	template<typename Function>
+	inline void ForEachSetBit(Function function) const;
+
 private:
+	enum CombineOp
+	{
+		CombineAnd,
+		CombineOr,
+		CombineXor,
+		CombineAndNot,
+	};
+
 	// A private constructor is used
-	inline Bitfield(const size_t fieldSize, unsigned int* pField);
+	inline Bitfield(const size_t fieldSize, uint64_t* pField, bool ownsField);
+
+	// How many words are in the field
+	inline size_t WordCount() const;
+
+	// Works out how many words each summary level needs for a field of wordCount words.
+	// Returns the total number of summary words, for both the full and set summaries.
+	static inline size_t SummaryLayout(const size_t wordCount, size_t o_LevelWords[MaxSummaryLevels], size_t& o_Levels);
+	// Points the summary levels at memory and marks the padding past the end of each full level as full.
+	inline void InitSummaries(uint64_t* pSummary);
+	// Only points the summary levels at memory, for summaries that are already filled in.
+	inline void PointSummaries(uint64_t* pSummary);
+
+	// What a word looks like when every bit in it is set. Only the last word can be partly used.
+	inline uint64_t FullWord(size_t fieldNumber) const;
+
+	// Sets or clears the bits of mask in one word and keeps the counts, hints and summaries up to date.
+	inline void SetMask(size_t fieldNumber, uint64_t mask);
+	inline void ClearMask(size_t fieldNumber, uint64_t mask);
+
+	// Does the work of And, Or, Xor and AndNot.
+	inline void Combine(const Bitfield& other, CombineOp op);
+	// Works out the summary bits again for the words [firstWord, endWord) after they were written directly.
+	inline void RebuildSummaries(size_t firstWord, size_t endWord);
+
+	// Keep the summaries up to date when a word becomes or stops being full or empty.
+	inline void MarkFull(size_t fieldNumber);
+	inline void MarkNotFull(size_t fieldNumber);
+	inline void MarkNotEmpty(size_t fieldNumber);
+	inline void MarkEmpty(size_t fieldNumber);
+
+	// Walks down the summary levels to find the first word that isn't full (findFree) or isn't empty.
+	// Returns false if there isn't one.
+	inline bool SearchSummary(bool findFree, size_t& o_fieldNumber) const;
 
 	size_t _FreeBits; // The number of bits free in our bitfield.
 	size_t _FieldSize; // The number of bits in our bitfield.
-	unsigned int* _pField; // The location of the bitfield itself.
+	uint64_t* _pField; // The location of the bitfield itself.
+	mutable size_t _FreeHint; // Every word before this one is full. Lets FirstFreeBit skip them.
+	mutable size_t _SetHint; // Every word before this one is empty. Lets FirstSetBit skip them.
+	bool _OwnsField; // Did we allocate _pField, or was it given to us?
+
+	size_t _SummaryLevels; // 0 if the field is small enough to not need summaries.
+	size_t _TopWords; // How many words are in the top summary level.
+	uint64_t* _pFullSummary[MaxSummaryLevels]; // A set bit means the word below is full.
+	uint64_t* _pSetSummary[MaxSummaryLevels]; // A set bit means the word below has a set bit.
 };
 
 #include "Bitfield.inl"
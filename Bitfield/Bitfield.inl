@@ -3,120 +3,750 @@ Author: Ryan Kirschman
 Date: 3/30/2016
 
 An inline file used to define my inline functions for the Bitfield.
-All of the methods for my Bitfield are inlined as they are simple functions except for the static Create methods.
+All of the methods for my Bitfield are inlined as they are simple functions.
+
+When compiled with AVX2 (/arch:AVX2 or -mavx2) the searches check 4 words (256 bits) at a time
+while looking for a word that isn't full or isn't empty, and And, Or, Xor and AndNot combine 4 words at a time.
+Fields large enough to have summary levels search the summaries instead.
 */
 
-#define BITS_IN_BYTES 8
-#define MAXUINT32_T 4294967296
+#include <new>
+#include <string.h>
+
+#include "BitOps.h"
+
+#if defined(__AVX2__)
+	#include <immintrin.h>
+#endif
+
+inline Bitfield* Bitfield::Create(const size_t fieldSize)
+{
+	const size_t wordCount = (fieldSize + BitOps::BitsPerWord - 1) / BitOps::BitsPerWord;
+	size_t levelWords[MaxSummaryLevels];
+	size_t levels;
+	const size_t summaryWords = SummaryLayout(wordCount, levelWords, levels);
+
+	// Always allocate at least one word so _pField is never NULL. The summaries go right after the field.
+	const size_t fieldWords = wordCount > 0 ? wordCount : 1;
+	uint64_t* pField = new (std::nothrow) uint64_t[fieldWords + summaryWords]();
+	if (pField == nullptr)
+	{
+		return nullptr;
+	}
+
+	Bitfield* pBitfield = new (std::nothrow) Bitfield(fieldSize, pField, true);
+	if (pBitfield == nullptr)
+	{
+		delete[] pField;
+		return nullptr;
+	}
+	pBitfield->InitSummaries(pField + fieldWords);
+	return pBitfield;
+}
+
+inline Bitfield* Bitfield::Create(const size_t fieldSize, void*& io_pField)
+{
+	const size_t wordCount = (fieldSize + BitOps::BitsPerWord - 1) / BitOps::BitsPerWord;
+	size_t levelWords[MaxSummaryLevels];
+	size_t levels;
+	const size_t summaryWords = SummaryLayout(wordCount, levelWords, levels);
+
+	// The words need to be 8 byte aligned. The Bitfield is a multiple of 8 bytes, so the words can go right after it.
+	const uintptr_t address = (reinterpret_cast<uintptr_t>(io_pField) + sizeof(uint64_t) - 1) & ~static_cast<uintptr_t>(sizeof(uint64_t) - 1);
+	uint64_t* pField = reinterpret_cast<uint64_t*>(address + sizeof(Bitfield));
+	memset(pField, 0, (wordCount + summaryWords) * sizeof(uint64_t));
+
+	Bitfield* pBitfield = new (reinterpret_cast<void*>(address)) Bitfield(fieldSize, pField, false);
+	pBitfield->InitSummaries(pField + wordCount);
+	io_pField = reinterpret_cast<void*>(pField + wordCount + summaryWords);
+	return pBitfield;
+}
+
+inline size_t Bitfield::MemoryRequired(const size_t fieldSize)
+{
+	const size_t wordCount = (fieldSize + BitOps::BitsPerWord - 1) / BitOps::BitsPerWord;
+	size_t levelWords[MaxSummaryLevels];
+	size_t levels;
+	const size_t summaryWords = SummaryLayout(wordCount, levelWords, levels);
+	return (sizeof(uint64_t) - 1) + sizeof(Bitfield) + (wordCount + summaryWords) * sizeof(uint64_t);
+}
+
+inline Bitfield* Bitfield::Attach(const size_t fieldSize, const size_t freeBits, uint64_t* pWords)
+{
+	Bitfield* pBitfield = new (std::nothrow) Bitfield(fieldSize, pWords, false);
+	if (pBitfield == nullptr)
+	{
+		return nullptr;
+	}
+	pBitfield->_FreeBits = freeBits;
+	pBitfield->PointSummaries(pWords + pBitfield->WordCount());
+	return pBitfield;
+}
+
+inline bool Bitfield::Rescan()
+{
+	// The bits past the end of the field have to be free, or the last word could never look full
+	const size_t wordCount = WordCount();
+	if (wordCount > 0 && (_pField[wordCount - 1] & ~FullWord(wordCount - 1)) != 0)
+	{
+		return false;
+	}
+
+	_FreeBits = _FieldSize - BitOps::PopCount(_pField, wordCount);
+	_FreeHint = 0;
+	_SetHint = 0;
+	if (wordCount > 0)
+	{
+		RebuildSummaries(0, wordCount);
+	}
+	return true;
+}
 
-inline Bitfield::Bitfield(size_t fieldSize, unsigned int* pField) :
+inline size_t Bitfield::StorageWords(const size_t fieldSize)
+{
+	const size_t wordCount = (fieldSize + BitOps::BitsPerWord - 1) / BitOps::BitsPerWord;
+	size_t levelWords[MaxSummaryLevels];
+	size_t levels;
+	return wordCount + SummaryLayout(wordCount, levelWords, levels);
+}
+
+inline size_t Bitfield::SummaryLayout(const size_t wordCount, size_t o_LevelWords[MaxSummaryLevels], size_t& o_Levels)
+{
+	o_Levels = 0;
+	if (wordCount <= SummaryThreshold)
+	{
+		return 0;
+	}
+
+	// Each level has one bit per word in the level below, until a level fits in one word
+	size_t total = 0;
+	size_t children = wordCount;
+	while (o_Levels < MaxSummaryLevels)
+	{
+		const size_t words = (children + BitOps::BitsPerWord - 1) / BitOps::BitsPerWord;
+		o_LevelWords[o_Levels++] = words;
+		total += words * 2;
+		if (words == 1)
+		{
+			break;
+		}
+		children = words;
+	}
+	return total;
+}
+
+inline void Bitfield::PointSummaries(uint64_t* pSummary)
+{
+	size_t levelWords[MaxSummaryLevels];
+	SummaryLayout(WordCount(), levelWords, _SummaryLevels);
+	_TopWords = _SummaryLevels > 0 ? levelWords[_SummaryLevels - 1] : 0;
+
+	for (size_t level = 0; level < _SummaryLevels; level++)
+	{
+		_pFullSummary[level] = pSummary;
+		pSummary += levelWords[level];
+		_pSetSummary[level] = pSummary;
+		pSummary += levelWords[level];
+	}
+}
+
+inline void Bitfield::InitSummaries(uint64_t* pSummary)
+{
+	PointSummaries(pSummary);
+
+	size_t children = WordCount();
+	for (size_t level = 0; level < _SummaryLevels; level++)
+	{
+		// Words past the end of the level below don't exist. Count them as full so a search never walks into them.
+		const size_t levelWords = (children + BitOps::BitsPerWord - 1) / BitOps::BitsPerWord;
+		const size_t used = children % BitOps::BitsPerWord;
+		if (used != 0)
+		{
+			_pFullSummary[level][levelWords - 1] |= ~BitOps::LowMask(used);
+		}
+		children = levelWords;
+	}
+}
+
+inline Bitfield::Bitfield(size_t fieldSize, uint64_t* pField, bool ownsField) :
+	_FreeBits(fieldSize),
 	_FieldSize(fieldSize),
 	_pField(pField),
-	_FreeBits(fieldSize)
+	_FreeHint(0),
+	_SetHint(0),
+	_OwnsField(ownsField),
+	_SummaryLevels(0),
+	_TopWords(0)
 {}
 
 inline Bitfield::~Bitfield()
 { 
-	delete _pField; 
+	if (_OwnsField)
+	{
+		delete[] _pField;
+	}
 }
 
-inline bool Bitfield::operator[](size_t index) {
-	if (index < 0 || index >= _FieldSize) {
+inline size_t Bitfield::WordCount() const
+{
+	return (_FieldSize + BitOps::BitsPerWord - 1) / BitOps::BitsPerWord;
+}
+
+inline uint64_t Bitfield::FullWord(size_t fieldNumber) const
+{
+	return fieldNumber + 1 < WordCount() ? BitOps::AllSet : BitOps::LowMask(_FieldSize - fieldNumber * BitOps::BitsPerWord);
+}
+
+inline void Bitfield::MarkFull(size_t fieldNumber)
+{
+	// Set our bit at each level until we reach a summary word that still isn't full
+	size_t index = fieldNumber;
+	for (size_t level = 0; level < _SummaryLevels; level++)
+	{
+		uint64_t& summary = _pFullSummary[level][index / BitOps::BitsPerWord];
+		summary |= static_cast<uint64_t>(1) << (index % BitOps::BitsPerWord);
+		if (summary != BitOps::AllSet)
+		{
+			return;
+		}
+		index /= BitOps::BitsPerWord;
+	}
+}
+
+inline void Bitfield::MarkNotFull(size_t fieldNumber)
+{
+	// Clear our bit at each level until we reach a summary word that already wasn't full
+	size_t index = fieldNumber;
+	for (size_t level = 0; level < _SummaryLevels; level++)
+	{
+		uint64_t& summary = _pFullSummary[level][index / BitOps::BitsPerWord];
+		const bool wasFull = summary == BitOps::AllSet;
+		summary &= ~(static_cast<uint64_t>(1) << (index % BitOps::BitsPerWord));
+		if (!wasFull)
+		{
+			return;
+		}
+		index /= BitOps::BitsPerWord;
+	}
+}
+
+inline void Bitfield::MarkNotEmpty(size_t fieldNumber)
+{
+	// Set our bit at each level until we reach a summary word that already had a bit set
+	size_t index = fieldNumber;
+	for (size_t level = 0; level < _SummaryLevels; level++)
+	{
+		uint64_t& summary = _pSetSummary[level][index / BitOps::BitsPerWord];
+		const bool wasEmpty = summary == 0;
+		summary |= static_cast<uint64_t>(1) << (index % BitOps::BitsPerWord);
+		if (!wasEmpty)
+		{
+			return;
+		}
+		index /= BitOps::BitsPerWord;
+	}
+}
+
+inline void Bitfield::MarkEmpty(size_t fieldNumber)
+{
+	// Clear our bit at each level until we reach a summary word that still has a bit set
+	size_t index = fieldNumber;
+	for (size_t level = 0; level < _SummaryLevels; level++)
+	{
+		uint64_t& summary = _pSetSummary[level][index / BitOps::BitsPerWord];
+		summary &= ~(static_cast<uint64_t>(1) << (index % BitOps::BitsPerWord));
+		if (summary != 0)
+		{
+			return;
+		}
+		index /= BitOps::BitsPerWord;
+	}
+}
+
+inline bool Bitfield::SearchSummary(bool findFree, size_t& o_fieldNumber) const
+{
+	uint64_t* const* pLevels = findFree ? _pFullSummary : _pSetSummary;
+	const uint64_t flip = findFree ? BitOps::AllSet : 0;
+
+	// The top level usually has a single word, but very large fields can have a few
+	const uint64_t* pTop = pLevels[_SummaryLevels - 1];
+	size_t index = 0;
+	size_t word = 0;
+	while (word < _TopWords && (pTop[word] ^ flip) == 0) {
+		word++;
+	}
+	if (word == _TopWords) {
 		return false;
 	}
+	index = word * BitOps::BitsPerWord + BitOps::CountTrailingZeros(pTop[word] ^ flip);
 
-	//which index in m_pField does i_index lie
-	size_t fieldNumber = index / (sizeof(int) * BITS_IN_BYTES);
-	//which bit does it correspond to in m_pField[fieldNumber]
-	unsigned int offset = index - (fieldNumber * sizeof(int)* BITS_IN_BYTES);
+	// Each level tells us which word to look at in the level below
+	for (size_t level = _SummaryLevels - 1; level-- > 0;) {
+		index = index * BitOps::BitsPerWord + BitOps::CountTrailingZeros(pLevels[level][index] ^ flip);
+	}
+
+	o_fieldNumber = index;
+	return true;
+}
+
+inline bool Bitfield::operator[](size_t index) const {
+	if (index >= _FieldSize) {
+		return false;
+	}
+
+	//which word does index lie in, and which bit in that word does it correspond to
+	const size_t fieldNumber = index / BitOps::BitsPerWord;
+	const size_t offset = index % BitOps::BitsPerWord;
 
 	//shift by offset and see if it's set or free
-	return !!((_pField[fieldNumber]) & (1 << offset));
+	return !!(_pField[fieldNumber] & (static_cast<uint64_t>(1) << offset));
 }
 
-inline bool Bitfield::FirstFreeBit(size_t& o_index) {
-	size_t fieldNumber = 0;
+inline bool Bitfield::FirstFreeBit(size_t& o_index) const {
+	if (_SummaryLevels > 0) {
+		size_t fieldNumber;
+		if (SearchSummary(true, fieldNumber)) {
+			o_index = fieldNumber * BitOps::BitsPerWord + BitOps::CountTrailingZeros(~_pField[fieldNumber]);
+			return true;
+		}
+		o_index = -1;
+		return false;
+	}
 
-	while (fieldNumber < (_FieldSize / (sizeof(unsigned int) * BITS_IN_BYTES + 1))) {
-		if (_pField[fieldNumber] == MAXUINT32_T)
-		{
-			fieldNumber++;
-			continue;
+	const size_t wordCount = WordCount();
+	size_t fieldNumber = _FreeHint;
+
+#if defined(__AVX2__)
+	// Skip 256 full bits at a time
+	const __m256i allSet = _mm256_set1_epi64x(-1);
+	while (fieldNumber + 4 <= wordCount &&
+		_mm256_testc_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(_pField + fieldNumber)), allSet)) {
+		fieldNumber += 4;
+	}
+#endif
+	while (fieldNumber < wordCount && _pField[fieldNumber] == BitOps::AllSet) {
+		fieldNumber++;
+	}
+
+	// Everything we skipped is full, so the next search can start here
+	_FreeHint = fieldNumber;
+
+	if (fieldNumber < wordCount) {
+		// The bits past the end of the field are always free, so make sure we didn't find one of them
+		const size_t index = fieldNumber * BitOps::BitsPerWord + BitOps::CountTrailingZeros(~_pField[fieldNumber]);
+		if (index < _FieldSize) {
+			o_index = index;
+			return true;
 		}
-		for (size_t i = 0; i < sizeof(int); i++) {
-			//check to see if we are out of range of bitfield while still in array
-			if (fieldNumber * (sizeof(unsigned int) * BITS_IN_BYTES) + i >= _FieldSize)
-			{
-				o_index = -1;
-				return false;
-			}
-			if (!((_pField[fieldNumber]) & (1 << i))) {
-				o_index = fieldNumber * sizeof(unsigned int) * BITS_IN_BYTES + i;
-				return true;
-			}
+	}
+	o_index = -1;
+	return false;
+}
+
+inline bool Bitfield::FirstSetBit(size_t& o_index) const {
+	if (_SummaryLevels > 0) {
+		size_t fieldNumber;
+		if (SearchSummary(false, fieldNumber)) {
+			o_index = fieldNumber * BitOps::BitsPerWord + BitOps::CountTrailingZeros(_pField[fieldNumber]);
+			return true;
 		}
 		o_index = -1;
 		return false;
 	}
+
+	const size_t wordCount = WordCount();
+	size_t fieldNumber = _SetHint;
+
+#if defined(__AVX2__)
+	// Skip 256 empty bits at a time
+	while (fieldNumber + 4 <= wordCount) {
+		const __m256i words = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(_pField + fieldNumber));
+		if (!_mm256_testz_si256(words, words)) {
+			break;
+		}
+		fieldNumber += 4;
+	}
+#endif
+	while (fieldNumber < wordCount && _pField[fieldNumber] == 0) {
+		fieldNumber++;
+	}
+
+	// Everything we skipped is empty, so the next search can start here
+	_SetHint = fieldNumber;
+
+	if (fieldNumber < wordCount) {
+		o_index = fieldNumber * BitOps::BitsPerWord + BitOps::CountTrailingZeros(_pField[fieldNumber]);
+		return true;
+	}
 	o_index = -1;
 	return false;
 }
 
-inline bool Bitfield::FirstSetBit(size_t& o_index) {
-	size_t fieldNumber = 0;
+inline bool Bitfield::NextSetBit(size_t from, size_t& o_index) const {
+	if (from >= _FieldSize) {
+		return false;
+	}
+
+	// Ignore the bits before from in the first word, then skip empty words
+	const size_t wordCount = WordCount();
+	size_t fieldNumber = from / BitOps::BitsPerWord;
+	uint64_t word = _pField[fieldNumber] & ~BitOps::LowMask(from % BitOps::BitsPerWord);
+	while (word == 0) {
+		if (++fieldNumber >= wordCount) {
+			return false;
+		}
+		word = _pField[fieldNumber];
+	}
+
+	o_index = fieldNumber * BitOps::BitsPerWord + BitOps::CountTrailingZeros(word);
+	return true;
+}
+
+inline void Bitfield::SetBit(size_t index) {
+	if (index >= _FieldSize) {
+		return;
+	}
+
+	SetMask(index / BitOps::BitsPerWord, static_cast<uint64_t>(1) << (index % BitOps::BitsPerWord));
+}
+
+inline void Bitfield::FreeBit(size_t index) {
+	if (index >= _FieldSize) {
+		return;
+	}
+
+	ClearMask(index / BitOps::BitsPerWord, static_cast<uint64_t>(1) << (index % BitOps::BitsPerWord));
+}
+
+inline void Bitfield::SetMask(size_t fieldNumber, uint64_t mask)
+{
+	// Only the bits that are actually changing count
+	const uint64_t before = _pField[fieldNumber];
+	mask &= ~before;
+	if (mask == 0) {
+		return;
+	}
+
+	_pField[fieldNumber] = before | mask;
+	_FreeBits -= BitOps::PopCount(mask);
+	if (fieldNumber < _SetHint) {
+		_SetHint = fieldNumber;
+	}
+
+	if (_SummaryLevels > 0) {
+		if (before == 0) {
+			MarkNotEmpty(fieldNumber);
+		}
+		if (_pField[fieldNumber] == FullWord(fieldNumber)) {
+			MarkFull(fieldNumber);
+		}
+	}
+}
+
+inline void Bitfield::ClearMask(size_t fieldNumber, uint64_t mask)
+{
+	const uint64_t before = _pField[fieldNumber];
+	mask &= before;
+	if (mask == 0) {
+		return;
+	}
+
+	_pField[fieldNumber] = before & ~mask;
+	_FreeBits += BitOps::PopCount(mask);
+	if (fieldNumber < _FreeHint) {
+		_FreeHint = fieldNumber;
+	}
 
-	while (fieldNumber < (_FieldSize / (sizeof(unsigned int) * BITS_IN_BYTES + 1))) {
+	if (_SummaryLevels > 0) {
+		if (before == FullWord(fieldNumber)) {
+			MarkNotFull(fieldNumber);
+		}
 		if (_pField[fieldNumber] == 0) {
-			fieldNumber++;
-			continue;
+			MarkEmpty(fieldNumber);
 		}
-		for (size_t i = 0; i < sizeof(int); i++) {
-			//check to see if we are out of range of bitfield while still in array
-			if (fieldNumber * (sizeof(unsigned int) * BITS_IN_BYTES) + i >= _FieldSize)
-			{
-				o_index = -1;
-				return false;
-			}
+	}
+}
+
+inline size_t Bitfield::ClaimFreeBits(size_t count, size_t* o_indices)
+{
+	size_t claimed = 0;
+	size_t index;
+	while (claimed < count && FirstFreeBit(index)) {
+		const size_t fieldNumber = index / BitOps::BitsPerWord;
+		uint64_t take = ~_pField[fieldNumber] & FullWord(fieldNumber);
 
-			if (_pField[fieldNumber] & (1 << i)) {
-				o_index = fieldNumber * sizeof(unsigned int) * BITS_IN_BYTES + i;
-				return true;
+		// Only take as many of the lowest free bits as we still need
+		const size_t need = count - claimed;
+		if (need < BitOps::BitsPerWord && BitOps::PopCount(take) > need) {
+			uint64_t keep = 0;
+			for (size_t i = 0; i < need; i++) {
+				const uint64_t lowest = take & (~take + 1);
+				keep |= lowest;
+				take ^= lowest;
 			}
+			take = keep;
+		}
+
+		SetMask(fieldNumber, take);
+
+		while (take != 0) {
+			o_indices[claimed++] = fieldNumber * BitOps::BitsPerWord + BitOps::CountTrailingZeros(take);
+			take &= take - 1;
 		}
-		o_index = -1;
-		return false;
 	}
-	o_index = -1;
-	return false;
+	return claimed;
 }
 
-inline void Bitfield::SetBit(size_t index) {
-	size_t fieldNumber = index / (sizeof(unsigned int) * BITS_IN_BYTES);
-	unsigned int offset = index - (fieldNumber * sizeof(unsigned int) * BITS_IN_BYTES);
+inline void Bitfield::ReleaseBits(const size_t* indices, size_t count)
+{
+	size_t i = 0;
+	while (i < count) {
+		if (indices[i] >= _FieldSize) {
+			i++;
+			continue;
+		}
 
-	if (!this->operator[](index))
-	{
-		_pField[fieldNumber] |= (1 << offset);
-		_FreeBits--;
+		// Gather every following index that lands in the same word and clear them all at once
+		const size_t fieldNumber = indices[i] / BitOps::BitsPerWord;
+		uint64_t mask = 0;
+		while (i < count && indices[i] < _FieldSize && indices[i] / BitOps::BitsPerWord == fieldNumber) {
+			mask |= static_cast<uint64_t>(1) << (indices[i] % BitOps::BitsPerWord);
+			i++;
+		}
+		ClearMask(fieldNumber, mask);
 	}
 }
 
-inline void Bitfield::FreeBit(size_t index) {
-	size_t fieldNumber = index / (sizeof(unsigned int) * BITS_IN_BYTES);
-	unsigned int offset = index - (fieldNumber * sizeof(unsigned int) * 8);
+inline void Bitfield::ToggleBit(size_t index)
+{
+	if (this->operator[](index)) {
+		FreeBit(index);
+	}
+	else {
+		SetBit(index);
+	}
+}
 
-	if (this->operator[](index))
-	{
-		_pField[fieldNumber] &= ~(1 << offset);
-		_FreeBits++;
+inline void Bitfield::SetRange(size_t begin, size_t count)
+{
+	if (begin >= _FieldSize || count == 0) {
+		return;
+	}
+
+	const size_t end = count < _FieldSize - begin ? begin + count : _FieldSize;
+	const size_t firstWord = begin / BitOps::BitsPerWord;
+	const size_t lastWord = (end - 1) / BitOps::BitsPerWord;
+	const uint64_t firstMask = ~BitOps::LowMask(begin % BitOps::BitsPerWord);
+	const uint64_t lastMask = BitOps::LowMask(end - lastWord * BitOps::BitsPerWord);
+	if (firstWord == lastWord) {
+		SetMask(firstWord, firstMask & lastMask);
+		return;
+	}
+
+	SetMask(firstWord, firstMask);
+
+	// Fill every whole word in between at once, then fix the summaries over them in one pass
+	const size_t middle = lastWord - firstWord - 1;
+	if (middle > 0) {
+		_FreeBits -= middle * BitOps::BitsPerWord - BitOps::PopCount(_pField + firstWord + 1, middle);
+		memset(_pField + firstWord + 1, 0xFF, middle * sizeof(uint64_t));
+		if (firstWord + 1 < _SetHint) {
+			_SetHint = firstWord + 1;
+		}
+		RebuildSummaries(firstWord + 1, lastWord);
 	}
+
+	SetMask(lastWord, lastMask);
 }
 
-inline void Bitfield::ToggleBit(size_t index)
+inline void Bitfield::ClearRange(size_t begin, size_t count)
+{
+	if (begin >= _FieldSize || count == 0) {
+		return;
+	}
+
+	const size_t end = count < _FieldSize - begin ? begin + count : _FieldSize;
+	const size_t firstWord = begin / BitOps::BitsPerWord;
+	const size_t lastWord = (end - 1) / BitOps::BitsPerWord;
+	const uint64_t firstMask = ~BitOps::LowMask(begin % BitOps::BitsPerWord);
+	const uint64_t lastMask = BitOps::LowMask(end - lastWord * BitOps::BitsPerWord);
+	if (firstWord == lastWord) {
+		ClearMask(firstWord, firstMask & lastMask);
+		return;
+	}
+
+	ClearMask(firstWord, firstMask);
+
+	// Empty every whole word in between at once, then fix the summaries over them in one pass
+	const size_t middle = lastWord - firstWord - 1;
+	if (middle > 0) {
+		_FreeBits += BitOps::PopCount(_pField + firstWord + 1, middle);
+		memset(_pField + firstWord + 1, 0, middle * sizeof(uint64_t));
+		if (firstWord + 1 < _FreeHint) {
+			_FreeHint = firstWord + 1;
+		}
+		RebuildSummaries(firstWord + 1, lastWord);
+	}
+
+	ClearMask(lastWord, lastMask);
+}
+
+inline size_t Bitfield::CountRange(size_t begin, size_t count) const
+{
+	if (begin >= _FieldSize || count == 0) {
+		return 0;
+	}
+
+	const size_t end = count < _FieldSize - begin ? begin + count : _FieldSize;
+	const size_t firstWord = begin / BitOps::BitsPerWord;
+	const size_t lastWord = (end - 1) / BitOps::BitsPerWord;
+	const uint64_t firstMask = ~BitOps::LowMask(begin % BitOps::BitsPerWord);
+	const uint64_t lastMask = BitOps::LowMask(end - lastWord * BitOps::BitsPerWord);
+	if (firstWord == lastWord) {
+		return BitOps::PopCount(_pField[firstWord] & firstMask & lastMask);
+	}
+
+	return BitOps::PopCount(_pField[firstWord] & firstMask) +
+		BitOps::PopCount(_pField + firstWord + 1, lastWord - firstWord - 1) +
+		BitOps::PopCount(_pField[lastWord] & lastMask);
+}
+
+inline void Bitfield::And(const Bitfield& other)
+{
+	Combine(other, CombineAnd);
+}
+
+inline void Bitfield::Or(const Bitfield& other)
+{
+	Combine(other, CombineOr);
+}
+
+inline void Bitfield::Xor(const Bitfield& other)
+{
+	Combine(other, CombineXor);
+}
+
+inline void Bitfield::AndNot(const Bitfield& other)
+{
+	Combine(other, CombineAndNot);
+}
+
+inline void Bitfield::Combine(const Bitfield& other, CombineOp op)
 {
-	size_t fieldNumber = index / (sizeof(unsigned int) * BITS_IN_BYTES);
-	unsigned int offset = index - (fieldNumber * sizeof(unsigned int) * 8);
-		
-	_pField[fieldNumber] ^=  ~(1 << offset);
-	_FreeBits++;
-}
\ No newline at end of file
+	const size_t wordCount = WordCount();
+	const size_t otherWords = other.WordCount();
+	const size_t common = wordCount < otherWords ? wordCount : otherWords;
+	uint64_t* const pField = _pField;
+	const uint64_t* const pOther = other._pField;
+
+	size_t fieldNumber = 0;
+#if defined(__AVX2__)
+	// 256 bits at a time
+	for (; fieldNumber + 4 <= common; fieldNumber += 4) {
+		const __m256i words = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pField + fieldNumber));
+		const __m256i others = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pOther + fieldNumber));
+		__m256i result;
+		switch (op) {
+		case CombineAnd: result = _mm256_and_si256(words, others); break;
+		case CombineOr: result = _mm256_or_si256(words, others); break;
+		case CombineXor: result = _mm256_xor_si256(words, others); break;
+		default: result = _mm256_andnot_si256(others, words); break;
+		}
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(pField + fieldNumber), result);
+	}
+#endif
+	for (; fieldNumber < common; fieldNumber++) {
+		switch (op) {
+		case CombineAnd: pField[fieldNumber] &= pOther[fieldNumber]; break;
+		case CombineOr: pField[fieldNumber] |= pOther[fieldNumber]; break;
+		case CombineXor: pField[fieldNumber] ^= pOther[fieldNumber]; break;
+		default: pField[fieldNumber] &= ~pOther[fieldNumber]; break;
+		}
+	}
+
+	// Past the end of other every bit of other is 0, which only changes our bits for And
+	if (op == CombineAnd && common < wordCount) {
+		memset(pField + common, 0, (wordCount - common) * sizeof(uint64_t));
+	}
+
+	if (wordCount > 0) {
+		// A larger other can't be allowed to set the bits past the end of our field
+		pField[wordCount - 1] &= FullWord(wordCount - 1);
+
+		// Bits may have changed anywhere, so count everything again
+		_FreeBits = _FieldSize - BitOps::PopCount(pField, wordCount);
+		_FreeHint = 0;
+		_SetHint = 0;
+		RebuildSummaries(0, wordCount);
+	}
+}
+
+inline void Bitfield::RebuildSummaries(size_t firstWord, size_t endWord)
+{
+	// Each level only needs the summary words over the range that changed in the level below
+	size_t first = firstWord;
+	size_t end = endWord;
+	size_t children = WordCount();
+	for (size_t level = 0; level < _SummaryLevels; level++) {
+		// The children are the field's words for the first level, and the summary words of the level below after that
+		const uint64_t* pFullChildren = level == 0 ? _pField : _pFullSummary[level - 1];
+		const uint64_t* pSetChildren = level == 0 ? _pField : _pSetSummary[level - 1];
+		// Only the field's last word can be full without every bit set. Summary words past the end are already marked full.
+		const uint64_t lastFull = level == 0 ? FullWord(children - 1) : BitOps::AllSet;
+
+		const size_t firstSummary = first / BitOps::BitsPerWord;
+		const size_t endSummary = (end + BitOps::BitsPerWord - 1) / BitOps::BitsPerWord;
+		for (size_t summaryWord = firstSummary; summaryWord < endSummary; summaryWord++) {
+			const size_t firstChild = summaryWord * BitOps::BitsPerWord;
+			const size_t childCount = children - firstChild < BitOps::BitsPerWord ? children - firstChild : BitOps::BitsPerWord;
+
+			// Children past the end count as full, the same as InitSummaries marks them
+			uint64_t full = ~BitOps::LowMask(childCount);
+			uint64_t set = 0;
+			for (size_t bit = 0; bit < childCount; bit++) {
+				const size_t child = firstChild + bit;
+				const uint64_t fullValue = child + 1 == children ? lastFull : BitOps::AllSet;
+				full |= static_cast<uint64_t>(pFullChildren[child] == fullValue) << bit;
+				set |= static_cast<uint64_t>(pSetChildren[child] != 0) << bit;
+			}
+			_pFullSummary[level][summaryWord] = full;
+			_pSetSummary[level][summaryWord] = set;
+		}
+
+		first = firstSummary;
+		end = endSummary;
+		children = (children + BitOps::BitsPerWord - 1) / BitOps::BitsPerWord;
+	}
+}
+
+template<typename Function>
+inline void Bitfield::ForEachSetBit(Function function) const
+{
+	const size_t wordCount = WordCount();
+	if (_SummaryLevels == 0) {
+		for (size_t fieldNumber = 0; fieldNumber < wordCount; fieldNumber++) {
+			uint64_t word = _pField[fieldNumber];
+			while (word != 0) {
+				function(fieldNumber * BitOps::BitsPerWord + BitOps::CountTrailingZeros(word));
+				word &= word - 1;
+			}
+		}
+		return;
+	}
+
+	// The first set summary level has a bit for every word that isn't empty, so empty words are skipped 64 at a time
+	const size_t summaryWords = (wordCount + BitOps::BitsPerWord - 1) / BitOps::BitsPerWord;
+	for (size_t summaryWord = 0; summaryWord < summaryWords; summaryWord++) {
+		uint64_t summary = _pSetSummary[0][summaryWord];
+		while (summary != 0) {
+			const size_t fieldNumber = summaryWord * BitOps::BitsPerWord + BitOps::CountTrailingZeros(summary);
+			summary &= summary - 1;
+
+			uint64_t word = _pField[fieldNumber];
+			while (word != 0) {
+				function(fieldNumber * BitOps::BitsPerWord + BitOps::CountTrailingZeros(word));
+				word &= word - 1;
+			}
+		}
+	}
+}
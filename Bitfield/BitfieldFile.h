@@ -0,0 +1,93 @@
+/*
+Saves Bitfields and CompressedBitfields to files, and loads them back.
+
+A saved Bitfield is a 64 byte header followed by the Bitfield's words and summary levels exactly as they are in memory.
+MappedBitfield maps the file into memory and points a Bitfield straight at those words,
+so opening a saved field of any size costs the same: nothing is copied, rebuilt or read until it is used.
+The header is checked when the file is opened (its size, the version and the byte order) but the bits are trusted.
+A ReadOnly field must not be changed. A CopyOnWrite field can be, and only the pages that are written to are copied.
+The file itself is never changed either way.
+
+A saved CompressedBitfield uses the same header followed by what CompressedBitfield::Save writes.
+Its chunks are kept in growable arrays, so LoadCompressed copies each chunk once instead of mapping it,
+and checks each chunk's bits as it copies them. Only MappedBitfield trusts the bits in a file.
+
+Files are written in the byte order of the machine that saves them. A machine with the other byte order can't open them.
+The Version goes up whenever the layout changes, including changes to how Bitfield lays out its summary levels,
+and files with a different version can't be opened.
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Bitfield.h"
+#include "CompressedBitfield.h"
+
+namespace BitfieldFile
+{
+	static const uint32_t Version = 1;
+
+	enum Kind
+	{
+		Dense = 1, // A Bitfield
+		Compressed = 2, // A CompressedBitfield
+	};
+
+	// The start of every saved file.
+	struct Header
+	{
+		char magic[8]; // "BITFIELD"
+		uint32_t version;
+		uint32_t kind;
+		uint32_t byteOrder; // 0x01020304 as written by the machine that saved the file.
+		uint32_t headerSize; // Where the saved field starts.
+		uint64_t fieldSize;
+		uint64_t freeBits;
+		uint64_t payloadBytes; // How many bytes the saved field takes after the header.
+		uint64_t reserved[2];
+	};
+
+	// Saves a field to path, replacing anything already there. Returns false if the file couldn't be written.
+	inline bool Save(const Bitfield& field, const char* path);
+	inline bool Save(const CompressedBitfield& field, const char* path);
+
+	// Loads a saved CompressedBitfield. Returns NULL if the file can't be read or doesn't hold one.
+	inline CompressedBitfield* LoadCompressed(const char* path);
+}
+
+class MappedBitfield
+{
+public:
+	enum Mode
+	{
+		ReadOnly, // The field's memory can't be written to.
+		CopyOnWrite, // The field can be changed. Changes are private to this process and never saved.
+	};
+
+	// Static failsafe constructor. Maps a saved Bitfield into memory.
+	// Will return NULL if the file can't be mapped, isn't a saved Bitfield, or was saved with a different version or byte order.
+	static inline MappedBitfield* Open(const char* path, Mode mode = ReadOnly);
+
+	inline ~MappedBitfield();
+
+	// Getters
+	const Bitfield& Field() const { return *_pField; }
+	Bitfield* MutableField() { return _Mode == CopyOnWrite ? _pField : nullptr; } // NULL for a ReadOnly mapping.
+	Mode GetMode() const { return _Mode; }
+
+	MappedBitfield(const MappedBitfield&) = delete;
+	MappedBitfield& operator=(const MappedBitfield&) = delete;
+
+private:
+	inline MappedBitfield(void* pMapping, size_t mappingSize, void* pHandle, Mode mode);
+
+	void* _pMapping; // Where the file is mapped.
+	size_t _MappingSize; // How many bytes are mapped.
+	void* _pHandle; // The file mapping handle on Windows. Unused everywhere else.
+	Mode _Mode;
+	Bitfield* _pField; // Points into the mapping.
+};
+
+#include "BitfieldFile.inl"
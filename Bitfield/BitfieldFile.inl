@@ -0,0 +1,229 @@
+/*
+An inline file used to define my inline functions for saving and loading Bitfields.
+*/
+
+#include <new>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace BitfieldFile
+{
+	static const uint32_t ByteOrderMark = 0x01020304;
+
+	inline void FillHeader(Header& o_header, Kind kind, size_t fieldSize, size_t freeBits, size_t payloadBytes)
+	{
+		memset(&o_header, 0, sizeof(o_header));
+		memcpy(o_header.magic, "BITFIELD", sizeof(o_header.magic));
+		o_header.version = Version;
+		o_header.kind = kind;
+		o_header.byteOrder = ByteOrderMark;
+		o_header.headerSize = sizeof(Header);
+		o_header.fieldSize = fieldSize;
+		o_header.freeBits = freeBits;
+		o_header.payloadBytes = payloadBytes;
+	}
+
+	// Returns the header if the mapped file starts with one of the right kind and is long enough to hold what it says it does.
+	inline const Header* CheckHeader(const void* pFile, size_t fileSize, Kind kind)
+	{
+		if (fileSize < sizeof(Header)) {
+			return nullptr;
+		}
+
+		const Header* pHeader = reinterpret_cast<const Header*>(pFile);
+		if (memcmp(pHeader->magic, "BITFIELD", sizeof(pHeader->magic)) != 0 ||
+			pHeader->version != Version ||
+			pHeader->kind != static_cast<uint32_t>(kind) ||
+			pHeader->byteOrder != ByteOrderMark ||
+			pHeader->headerSize != sizeof(Header) ||
+			pHeader->freeBits > pHeader->fieldSize ||
+			pHeader->payloadBytes > fileSize - sizeof(Header)) {
+			return nullptr;
+		}
+		return pHeader;
+	}
+
+	// Maps a whole file into memory. The mapping can only be written to if copyOnWrite is true, and writes never reach the file.
+	// o_pHandle is the mapping handle on Windows, and NULL everywhere else.
+	inline bool MapFile(const char* path, bool copyOnWrite, void*& o_pMapping, size_t& o_size, void*& o_pHandle)
+	{
+		o_pHandle = nullptr;
+#if defined(_WIN32)
+		HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE) {
+			return false;
+		}
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+			CloseHandle(file);
+			return false;
+		}
+
+		// The mapping keeps the file open, so the file handle isn't needed once the mapping exists
+		HANDLE mapping = CreateFileMappingA(file, nullptr, copyOnWrite ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, nullptr);
+		CloseHandle(file);
+		if (mapping == nullptr) {
+			return false;
+		}
+
+		void* pView = MapViewOfFile(mapping, copyOnWrite ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0);
+		if (pView == nullptr) {
+			CloseHandle(mapping);
+			return false;
+		}
+
+		o_pMapping = pView;
+		o_size = static_cast<size_t>(size.QuadPart);
+		o_pHandle = mapping;
+		return true;
+#else
+		const int file = open(path, O_RDONLY);
+		if (file < 0) {
+			return false;
+		}
+
+		struct stat status;
+		if (fstat(file, &status) != 0 || status.st_size <= 0) {
+			close(file);
+			return false;
+		}
+
+		// The mapping keeps the file open, so the descriptor isn't needed once it exists
+		const size_t size = static_cast<size_t>(status.st_size);
+		void* pView = mmap(nullptr, size, PROT_READ | (copyOnWrite ? PROT_WRITE : 0), MAP_PRIVATE, file, 0);
+		close(file);
+		if (pView == MAP_FAILED) {
+			return false;
+		}
+
+		o_pMapping = pView;
+		o_size = size;
+		return true;
+#endif
+	}
+
+	inline void UnmapFile(void* pMapping, size_t size, void* pHandle)
+	{
+#if defined(_WIN32)
+		(void)size;
+		UnmapViewOfFile(pMapping);
+		CloseHandle(pHandle);
+#else
+		(void)pHandle;
+		munmap(pMapping, size);
+#endif
+	}
+
+	// Writes the header and then the payload, and only reports success if every byte made it to the file.
+	inline bool WriteFile(const char* path, const Header& header, const void* pPayload)
+	{
+		FILE* pFile = fopen(path, "wb");
+		if (pFile == nullptr) {
+			return false;
+		}
+
+		bool written = fwrite(&header, sizeof(header), 1, pFile) == 1;
+		if (written && header.payloadBytes > 0) {
+			written = fwrite(pPayload, static_cast<size_t>(header.payloadBytes), 1, pFile) == 1;
+		}
+		return fclose(pFile) == 0 && written;
+	}
+
+	inline bool Save(const Bitfield& field, const char* path)
+	{
+		Header header;
+		FillHeader(header, Dense, field.FieldSize(), field.FreeBits(), Bitfield::StorageWords(field.FieldSize()) * sizeof(uint64_t));
+		return WriteFile(path, header, field.Words());
+	}
+
+	inline bool Save(const CompressedBitfield& field, const char* path)
+	{
+		// Saved as uint64_t so the buffer is 8 byte aligned
+		std::vector<uint64_t> payload((field.SavedSize() + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+		field.Save(payload.data());
+
+		Header header;
+		FillHeader(header, Compressed, field.FieldSize(), field.FreeBits(), field.SavedSize());
+		return WriteFile(path, header, payload.data());
+	}
+
+	inline CompressedBitfield* LoadCompressed(const char* path)
+	{
+		void* pMapping;
+		size_t size;
+		void* pHandle;
+		if (!MapFile(path, false, pMapping, size, pHandle)) {
+			return nullptr;
+		}
+
+		CompressedBitfield* pField = nullptr;
+		const Header* pHeader = CheckHeader(pMapping, size, Compressed);
+		if (pHeader != nullptr) {
+			pField = CompressedBitfield::Load(static_cast<size_t>(pHeader->fieldSize), reinterpret_cast<const uint8_t*>(pMapping) + sizeof(Header), static_cast<size_t>(pHeader->payloadBytes));
+			if (pField != nullptr && pField->FreeBits() != pHeader->freeBits) {
+				delete pField;
+				pField = nullptr;
+			}
+		}
+
+		UnmapFile(pMapping, size, pHandle);
+		return pField;
+	}
+}
+
+inline MappedBitfield* MappedBitfield::Open(const char* path, Mode mode)
+{
+	void* pMapping;
+	size_t size;
+	void* pHandle;
+	if (!BitfieldFile::MapFile(path, mode == CopyOnWrite, pMapping, size, pHandle)) {
+		return nullptr;
+	}
+
+	// The words have to be exactly what a Bitfield of this size keeps, or the summaries would point at the wrong place.
+	// The payload fits in the file, so a field with no more bits than the payload can't overflow working out its size.
+	const BitfieldFile::Header* pHeader = BitfieldFile::CheckHeader(pMapping, size, BitfieldFile::Dense);
+	if (pHeader == nullptr || pHeader->fieldSize > pHeader->payloadBytes * 8 || pHeader->payloadBytes != Bitfield::StorageWords(static_cast<size_t>(pHeader->fieldSize)) * sizeof(uint64_t)) {
+		BitfieldFile::UnmapFile(pMapping, size, pHandle);
+		return nullptr;
+	}
+
+	MappedBitfield* pMapped = new (std::nothrow) MappedBitfield(pMapping, size, pHandle, mode);
+	if (pMapped == nullptr) {
+		BitfieldFile::UnmapFile(pMapping, size, pHandle);
+		return nullptr;
+	}
+
+	uint64_t* pWords = reinterpret_cast<uint64_t*>(reinterpret_cast<uint8_t*>(pMapping) + sizeof(BitfieldFile::Header));
+	pMapped->_pField = Bitfield::Attach(static_cast<size_t>(pHeader->fieldSize), static_cast<size_t>(pHeader->freeBits), pWords);
+	if (pMapped->_pField == nullptr) {
+		delete pMapped;
+		return nullptr;
+	}
+	return pMapped;
+}
+
+inline MappedBitfield::MappedBitfield(void* pMapping, size_t mappingSize, void* pHandle, Mode mode) :
+	_pMapping(pMapping),
+	_MappingSize(mappingSize),
+	_pHandle(pHandle),
+	_Mode(mode),
+	_pField(nullptr)
+{}
+
+inline MappedBitfield::~MappedBitfield()
+{
+	delete _pField;
+	BitfieldFile::UnmapFile(_pMapping, _MappingSize, _pHandle);
+}
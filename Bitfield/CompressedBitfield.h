@@ -0,0 +1,154 @@
+/*
+The CompressedBitfield stores a mostly empty field in a fraction of the memory a Bitfield needs.
+A Bitfield always costs one bit for every bit in the field, even if only a handful of them are set.
+
+The field is split into chunks of 65536 bits, and a chunk with no bits set takes no memory at all.
+Every other chunk picks whichever way of storing its bits is smallest:
+	Array: a sorted list of the set bits, 2 bytes each. Best for up to 4096 set bits.
+	Bitmap: one bit per bit, the same as a Bitfield. Always 8 KiB, so best when more than 4096 bits are set.
+	Run: a sorted list of runs of set bits, 4 bytes each. Best when the set bits are bunched together.
+Chunks move between arrays and bitmaps on their own as bits are set and freed. Optimize turns chunks into runs where that is smaller.
+
+Or and And work a chunk at a time, so chunks that only one side has are copied or dropped without looking at their bits.
+Two arrays are merged, an array and a bitmap check each array entry against the bitmap, and two bitmaps combine a word at a time.
+Runs are combined with other runs as runs, and fill or mask whole stretches of a bitmap, so they are never expanded a bit at a time unless the result is an array.
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+class CompressedBitfield
+{
+public:
+	// How many bits each chunk covers.
+	static const size_t ChunkBits = 65536;
+	// An array chunk with more set bits than this is turned into a bitmap, as the bitmap is smaller.
+	static const size_t ArrayMax = 4096;
+
+	// Static failsafe constructor used to create a CompressedBitfield. Will return NULL if no memory is available.
+	// fieldSize is how many bits are needed for our field.
+	static inline CompressedBitfield* Create(const size_t fieldSize);
+
+	// Getters
+	size_t FieldSize() const { return _FieldSize; }
+	size_t FreeBits() const { return _FieldSize - _SetBits; }
+	size_t SetBits() const { return _SetBits; }
+	size_t ChunkCount() const { return _Chunks.size(); }
+	inline size_t MemoryUsed() const; // How many bytes the CompressedBitfield is using, including itself.
+
+	// Overload operator [] to return true/false if bit is set/free.
+	inline bool operator[](size_t index) const;
+
+	// Accessors
+	inline bool NextSetBit(size_t from, size_t& o_index) const; // Finds the first set bit at or after from. Returns false if there isn't one.
+	inline bool SetBit(size_t index); // Sets a bit to 1. Returns true if it was 0.
+	inline bool FreeBit(size_t index); // Sets a bit to 0. Returns true if it was 1.
+	inline void ToggleBit(size_t index); // Sets a bit to 1 if 0 and 0 if 1.
+
+	// Combines every bit with the same bit of other. Bits past the end of other count as 0, and bits of other past the end of this field are ignored.
+	inline void Or(const CompressedBitfield& other);
+	inline void And(const CompressedBitfield& other);
+	// How many bits are set in both, without building the result.
+	inline size_t AndCount(const CompressedBitfield& other) const;
+
+	// Turns every chunk into whichever of array, bitmap or runs is smallest.
+	inline void Optimize();
+
+	// Save writes SavedSize() bytes to o_pBuffer, which must be 8 byte aligned.
+	// Load builds a CompressedBitfield from what Save wrote, copying each chunk's bits in one go.
+	// Returns NULL if the buffer isn't laid out like a saved CompressedBitfield of fieldSize bits or no memory is available.
+	// Every chunk is checked as it is copied: arrays sorted, runs inside the chunk and in order, no bits past the field.
+	// The counts are worked out from the bits, so a buffer that was changed after Save can't leave the field inconsistent.
+	inline size_t SavedSize() const;
+	inline void Save(void* o_pBuffer) const;
+	static inline CompressedBitfield* Load(const size_t fieldSize, const void* pBuffer, const size_t size);
+
+	// Calls function(index) for every set bit, lowest first. The function must not change this CompressedBitfield.
+	template<typename Function>
+	inline void ForEachSetBit(Function function) const;
+
+private:
+	// How many words a bitmap chunk has.
+	static const size_t BitmapWords = ChunkBits / 64;
+
+	enum ContainerType
+	{
+		ArrayContainer,
+		BitmapContainer,
+		RunContainer,
+	};
+
+	struct Chunk
+	{
+		size_t key; // Which chunk of the field this is. The chunk's first bit is key * ChunkBits.
+		ContainerType type;
+		size_t count; // How many bits are set.
+		std::vector<uint16_t> values; // Array: the set bits, sorted. Run: pairs of the first bit and the length - 1, sorted.
+		std::vector<uint64_t> words; // Bitmap: one bit per bit.
+	};
+
+	// How Save describes each chunk. The chunks' bits follow every description, each padded to 8 bytes.
+	struct SavedChunk
+	{
+		uint64_t key;
+		uint32_t type;
+		uint32_t count;
+		uint64_t entries; // How many uint16_t values, or uint64_t words for a bitmap.
+	};
+
+	// A private constructor is used
+	inline CompressedBitfield(size_t fieldSize);
+
+	// Works out a loaded chunk's count from its bits. Returns false if the bits aren't laid out the way the chunk's type keeps them.
+	static inline bool CountLoaded(Chunk& io_chunk);
+
+	// How many bytes a chunk's bits take when saved.
+	static inline size_t SavedBytes(const Chunk& chunk);
+
+	// The index of the first chunk with a key at or after key.
+	inline size_t LowerChunk(size_t key) const;
+	// Adds up the counts of every chunk again after Or or And.
+	inline void Recount();
+
+	// Calls function(bit) for every set bit in a chunk, lowest first.
+	template<typename Function>
+	static inline void ForEachInChunk(const Chunk& chunk, Function function);
+	static inline bool ChunkContains(const Chunk& chunk, uint16_t bit);
+	static inline bool ChunkNext(const Chunk& chunk, size_t from, size_t& o_bit);
+	static inline size_t CountRuns(const Chunk& chunk);
+
+	// Change how a chunk stores its bits without changing which bits are set.
+	static inline void ToArray(Chunk& io_chunk);
+	static inline void ToBitmap(Chunk& io_chunk);
+	static inline void ToRuns(Chunk& io_chunk);
+	// Turns a run chunk into an array or a bitmap, whichever fits, so it can be changed a bit at a time.
+	static inline void Unpack(Chunk& io_chunk);
+	// Clears every bit at or after limit.
+	static inline void ClearFrom(Chunk& io_chunk, size_t limit);
+
+	// Run chunks are combined with these directly instead of being expanded first.
+	// The last bit of run number run.
+	static inline size_t RunEnd(const std::vector<uint16_t>& runs, size_t run);
+	// How many runs start at or before bit. The only run that can hold bit is the one before those.
+	static inline size_t RunsStartingBy(const Chunk& chunk, size_t bit);
+	// Sets or clears the bits [first, last] of a bitmap.
+	static inline void FillRun(uint64_t* pWords, size_t first, size_t last, bool set);
+	// Adds the entries of an array that are inside the runs to o_kept.
+	static inline void ArrayInRuns(const std::vector<uint16_t>& values, const std::vector<uint16_t>& runs, std::vector<uint16_t>& o_kept);
+	// Write the union or intersection of two lists of runs to o_runs, and return how many bits it holds.
+	static inline size_t UniteRuns(const std::vector<uint16_t>& lhs, const std::vector<uint16_t>& rhs, std::vector<uint16_t>& o_runs);
+	static inline size_t IntersectRuns(const std::vector<uint16_t>& lhs, const std::vector<uint16_t>& rhs, std::vector<uint16_t>& o_runs);
+
+	static inline void OrChunk(Chunk& io_chunk, const Chunk& other);
+	static inline void AndChunk(Chunk& io_chunk, const Chunk& other);
+	static inline size_t AndCountChunk(const Chunk& lhs, const Chunk& rhs);
+
+	size_t _FieldSize; // The number of bits in our bitfield.
+	size_t _SetBits; // The number of bits set in our bitfield.
+	std::vector<Chunk> _Chunks; // Only the chunks with a bit set, sorted by key.
+};
+
+#include "CompressedBitfield.inl"
@@ -0,0 +1,938 @@
+/*
+An inline file used to define my inline functions for the CompressedBitfield.
+*/
+
+#include <algorithm>
+#include <iterator>
+#include <new>
+#include <string.h>
+#include <utility>
+
+#include "BitOps.h"
+
+inline CompressedBitfield* CompressedBitfield::Create(const size_t fieldSize)
+{
+	return new (std::nothrow) CompressedBitfield(fieldSize);
+}
+
+inline CompressedBitfield::CompressedBitfield(size_t fieldSize) :
+	_FieldSize(fieldSize),
+	_SetBits(0)
+{}
+
+inline size_t CompressedBitfield::MemoryUsed() const
+{
+	size_t bytes = sizeof(CompressedBitfield) + _Chunks.capacity() * sizeof(Chunk);
+	for (size_t i = 0; i < _Chunks.size(); i++) {
+		bytes += _Chunks[i].values.capacity() * sizeof(uint16_t) + _Chunks[i].words.capacity() * sizeof(uint64_t);
+	}
+	return bytes;
+}
+
+inline size_t CompressedBitfield::LowerChunk(size_t key) const
+{
+	size_t low = 0;
+	size_t high = _Chunks.size();
+	while (low < high) {
+		const size_t middle = low + (high - low) / 2;
+		if (_Chunks[middle].key < key) {
+			low = middle + 1;
+		}
+		else {
+			high = middle;
+		}
+	}
+	return low;
+}
+
+inline void CompressedBitfield::Recount()
+{
+	_SetBits = 0;
+	for (size_t i = 0; i < _Chunks.size(); i++) {
+		_SetBits += _Chunks[i].count;
+	}
+}
+
+/******    Chunks    ******/
+
+template<typename Function>
+inline void CompressedBitfield::ForEachInChunk(const Chunk& chunk, Function function)
+{
+	switch (chunk.type) {
+	case ArrayContainer:
+		for (size_t i = 0; i < chunk.values.size(); i++) {
+			function(static_cast<size_t>(chunk.values[i]));
+		}
+		break;
+	case BitmapContainer:
+		for (size_t word = 0; word < BitmapWords; word++) {
+			uint64_t bits = chunk.words[word];
+			while (bits != 0) {
+				function(word * BitOps::BitsPerWord + BitOps::CountTrailingZeros(bits));
+				bits &= bits - 1;
+			}
+		}
+		break;
+	case RunContainer:
+		for (size_t i = 0; i < chunk.values.size(); i += 2) {
+			const size_t end = static_cast<size_t>(chunk.values[i]) + chunk.values[i + 1];
+			for (size_t bit = chunk.values[i]; bit <= end; bit++) {
+				function(bit);
+			}
+		}
+		break;
+	}
+}
+
+inline bool CompressedBitfield::ChunkContains(const Chunk& chunk, uint16_t bit)
+{
+	switch (chunk.type) {
+	case ArrayContainer:
+		return std::binary_search(chunk.values.begin(), chunk.values.end(), bit);
+	case BitmapContainer:
+		return !!(chunk.words[bit / BitOps::BitsPerWord] & (static_cast<uint64_t>(1) << (bit % BitOps::BitsPerWord)));
+	case RunContainer:
+	{
+		// Only the last run that starts at or before bit can hold it
+		const size_t runs = RunsStartingBy(chunk, bit);
+		return runs > 0 && bit <= RunEnd(chunk.values, runs - 1);
+	}
+	}
+	return false;
+}
+
+inline bool CompressedBitfield::ChunkNext(const Chunk& chunk, size_t from, size_t& o_bit)
+{
+	switch (chunk.type) {
+	case ArrayContainer:
+	{
+		if (from >= ChunkBits) {
+			return false;
+		}
+		std::vector<uint16_t>::const_iterator it = std::lower_bound(chunk.values.begin(), chunk.values.end(), static_cast<uint16_t>(from));
+		if (it == chunk.values.end()) {
+			return false;
+		}
+		o_bit = *it;
+		return true;
+	}
+	case BitmapContainer:
+	{
+		if (from >= ChunkBits) {
+			return false;
+		}
+		size_t word = from / BitOps::BitsPerWord;
+		uint64_t bits = chunk.words[word] & ~BitOps::LowMask(from % BitOps::BitsPerWord);
+		while (bits == 0) {
+			if (++word == BitmapWords) {
+				return false;
+			}
+			bits = chunk.words[word];
+		}
+		o_bit = word * BitOps::BitsPerWord + BitOps::CountTrailingZeros(bits);
+		return true;
+	}
+	case RunContainer:
+	{
+		// from is either inside the last run that starts at or before it, or the next run starts the next set bit
+		const size_t runs = RunsStartingBy(chunk, from);
+		if (runs > 0 && from <= RunEnd(chunk.values, runs - 1)) {
+			o_bit = from;
+			return true;
+		}
+		if (runs * 2 < chunk.values.size()) {
+			o_bit = chunk.values[runs * 2];
+			return true;
+		}
+		return false;
+	}
+	}
+	return false;
+}
+
+inline size_t CompressedBitfield::CountRuns(const Chunk& chunk)
+{
+	switch (chunk.type) {
+	case ArrayContainer:
+	{
+		size_t runs = chunk.values.empty() ? 0 : 1;
+		for (size_t i = 1; i < chunk.values.size(); i++) {
+			runs += chunk.values[i] != chunk.values[i - 1] + 1;
+		}
+		return runs;
+	}
+	case BitmapContainer:
+	{
+		// A run starts at every set bit whose lower neighbor is free
+		size_t runs = 0;
+		uint64_t carry = 0;
+		for (size_t word = 0; word < BitmapWords; word++) {
+			const uint64_t bits = chunk.words[word];
+			runs += BitOps::PopCount(bits & ~((bits << 1) | carry));
+			carry = bits >> 63;
+		}
+		return runs;
+	}
+	case RunContainer:
+		return chunk.values.size() / 2;
+	}
+	return 0;
+}
+
+inline void CompressedBitfield::ToArray(Chunk& io_chunk)
+{
+	if (io_chunk.type == ArrayContainer) {
+		return;
+	}
+
+	std::vector<uint16_t> values;
+	values.reserve(io_chunk.count);
+	ForEachInChunk(io_chunk, [&values](size_t bit) { values.push_back(static_cast<uint16_t>(bit)); });
+	io_chunk.values.swap(values);
+	std::vector<uint64_t>().swap(io_chunk.words);
+	io_chunk.type = ArrayContainer;
+}
+
+inline void CompressedBitfield::ToBitmap(Chunk& io_chunk)
+{
+	if (io_chunk.type == BitmapContainer) {
+		return;
+	}
+
+	std::vector<uint64_t> words(BitmapWords, 0);
+	ForEachInChunk(io_chunk, [&words](size_t bit) { words[bit / BitOps::BitsPerWord] |= static_cast<uint64_t>(1) << (bit % BitOps::BitsPerWord); });
+	io_chunk.words.swap(words);
+	std::vector<uint16_t>().swap(io_chunk.values);
+	io_chunk.type = BitmapContainer;
+}
+
+inline void CompressedBitfield::ToRuns(Chunk& io_chunk)
+{
+	if (io_chunk.type == RunContainer) {
+		return;
+	}
+
+	std::vector<uint16_t> runs;
+	runs.reserve(CountRuns(io_chunk) * 2);
+	ForEachInChunk(io_chunk, [&runs](size_t bit) {
+		// Grow the last run if this bit is right after it, or start a new one
+		if (!runs.empty() && static_cast<size_t>(runs[runs.size() - 2]) + runs.back() + 1 == bit) {
+			runs.back()++;
+		}
+		else {
+			runs.push_back(static_cast<uint16_t>(bit));
+			runs.push_back(0);
+		}
+	});
+	io_chunk.values.swap(runs);
+	std::vector<uint64_t>().swap(io_chunk.words);
+	io_chunk.type = RunContainer;
+}
+
+inline void CompressedBitfield::Unpack(Chunk& io_chunk)
+{
+	if (io_chunk.type != RunContainer) {
+		return;
+	}
+	if (io_chunk.count > ArrayMax) {
+		ToBitmap(io_chunk);
+	}
+	else {
+		ToArray(io_chunk);
+	}
+}
+
+inline void CompressedBitfield::ClearFrom(Chunk& io_chunk, size_t limit)
+{
+	Unpack(io_chunk);
+	if (io_chunk.type == ArrayContainer) {
+		io_chunk.values.erase(std::lower_bound(io_chunk.values.begin(), io_chunk.values.end(), static_cast<uint16_t>(limit)), io_chunk.values.end());
+		io_chunk.count = io_chunk.values.size();
+		return;
+	}
+
+	const size_t word = limit / BitOps::BitsPerWord;
+	io_chunk.words[word] &= BitOps::LowMask(limit % BitOps::BitsPerWord);
+	std::fill(io_chunk.words.begin() + word + 1, io_chunk.words.end(), 0);
+	io_chunk.count = BitOps::PopCount(io_chunk.words.data(), BitmapWords);
+	if (io_chunk.count <= ArrayMax) {
+		ToArray(io_chunk);
+	}
+}
+
+inline size_t CompressedBitfield::RunEnd(const std::vector<uint16_t>& runs, size_t run)
+{
+	return static_cast<size_t>(runs[run * 2]) + runs[run * 2 + 1];
+}
+
+inline size_t CompressedBitfield::RunsStartingBy(const Chunk& chunk, size_t bit)
+{
+	size_t low = 0;
+	size_t high = chunk.values.size() / 2;
+	while (low < high) {
+		const size_t middle = low + (high - low) / 2;
+		if (chunk.values[middle * 2] <= bit) {
+			low = middle + 1;
+		}
+		else {
+			high = middle;
+		}
+	}
+	return low;
+}
+
+inline void CompressedBitfield::FillRun(uint64_t* pWords, size_t first, size_t last, bool set)
+{
+	const size_t firstWord = first / BitOps::BitsPerWord;
+	const size_t lastWord = last / BitOps::BitsPerWord;
+	for (size_t word = firstWord; word <= lastWord; word++) {
+		uint64_t mask = BitOps::AllSet;
+		if (word == firstWord) {
+			mask &= ~BitOps::LowMask(first % BitOps::BitsPerWord);
+		}
+		if (word == lastWord) {
+			mask &= BitOps::LowMask(last % BitOps::BitsPerWord + 1);
+		}
+		pWords[word] = set ? pWords[word] | mask : pWords[word] & ~mask;
+	}
+}
+
+inline void CompressedBitfield::ArrayInRuns(const std::vector<uint16_t>& values, const std::vector<uint16_t>& runs, std::vector<uint16_t>& o_kept)
+{
+	// Both are sorted, so walk them together
+	o_kept.reserve(values.size());
+	size_t run = 0;
+	for (size_t i = 0; i < values.size(); i++) {
+		while (run * 2 < runs.size() && RunEnd(runs, run) < values[i]) {
+			run++;
+		}
+		if (run * 2 == runs.size()) {
+			break;
+		}
+		if (runs[run * 2] <= values[i]) {
+			o_kept.push_back(values[i]);
+		}
+	}
+}
+
+inline size_t CompressedBitfield::UniteRuns(const std::vector<uint16_t>& lhs, const std::vector<uint16_t>& rhs, std::vector<uint16_t>& o_runs)
+{
+	// Take whichever run starts first, and grow the last run if it overlaps or touches it
+	o_runs.reserve(lhs.size() + rhs.size());
+	size_t count = 0;
+	size_t i = 0;
+	size_t j = 0;
+	while (i < lhs.size() || j < rhs.size()) {
+		const bool fromLhs = j == rhs.size() || (i < lhs.size() && lhs[i] <= rhs[j]);
+		const size_t first = fromLhs ? lhs[i] : rhs[j];
+		const size_t last = fromLhs ? RunEnd(lhs, i / 2) : RunEnd(rhs, j / 2);
+		(fromLhs ? i : j) += 2;
+
+		if (!o_runs.empty() && first <= RunEnd(o_runs, o_runs.size() / 2 - 1) + 1) {
+			const size_t end = RunEnd(o_runs, o_runs.size() / 2 - 1);
+			if (last > end) {
+				count += last - end;
+				o_runs.back() = static_cast<uint16_t>(last - o_runs[o_runs.size() - 2]);
+			}
+		}
+		else {
+			o_runs.push_back(static_cast<uint16_t>(first));
+			o_runs.push_back(static_cast<uint16_t>(last - first));
+			count += last - first + 1;
+		}
+	}
+	return count;
+}
+
+inline size_t CompressedBitfield::IntersectRuns(const std::vector<uint16_t>& lhs, const std::vector<uint16_t>& rhs, std::vector<uint16_t>& o_runs)
+{
+	// Each overlap of two runs is a run of the result. Then move past whichever run ends first.
+	size_t count = 0;
+	size_t i = 0;
+	size_t j = 0;
+	while (i < lhs.size() && j < rhs.size()) {
+		const size_t lhsEnd = RunEnd(lhs, i / 2);
+		const size_t rhsEnd = RunEnd(rhs, j / 2);
+		const size_t first = std::max(lhs[i], rhs[j]);
+		const size_t last = std::min(lhsEnd, rhsEnd);
+		if (first <= last) {
+			o_runs.push_back(static_cast<uint16_t>(first));
+			o_runs.push_back(static_cast<uint16_t>(last - first));
+			count += last - first + 1;
+		}
+		(lhsEnd < rhsEnd ? i : j) += 2;
+	}
+	return count;
+}
+
+inline void CompressedBitfield::OrChunk(Chunk& io_chunk, const Chunk& other)
+{
+	// Runs are combined without expanding either side
+	if (io_chunk.type == RunContainer && other.type == RunContainer) {
+		std::vector<uint16_t> runs;
+		io_chunk.count = UniteRuns(io_chunk.values, other.values, runs);
+		io_chunk.values.swap(runs);
+		return;
+	}
+
+	Unpack(io_chunk);
+	if (other.type == RunContainer) {
+		if (io_chunk.type == ArrayContainer && io_chunk.count + other.count <= ArrayMax) {
+			// Add every bit of each run in between the array entries around it
+			std::vector<uint16_t> merged;
+			merged.reserve(io_chunk.count + other.count);
+			size_t i = 0;
+			for (size_t run = 0; run * 2 < other.values.size(); run++) {
+				const size_t first = other.values[run * 2];
+				const size_t last = RunEnd(other.values, run);
+				for (; i < io_chunk.values.size() && io_chunk.values[i] < first; i++) {
+					merged.push_back(io_chunk.values[i]);
+				}
+				for (size_t bit = first; bit <= last; bit++) {
+					merged.push_back(static_cast<uint16_t>(bit));
+				}
+				for (; i < io_chunk.values.size() && io_chunk.values[i] <= last; i++) {}
+			}
+			merged.insert(merged.end(), io_chunk.values.begin() + i, io_chunk.values.end());
+			io_chunk.values.swap(merged);
+			io_chunk.count = io_chunk.values.size();
+			return;
+		}
+
+		ToBitmap(io_chunk);
+		for (size_t run = 0; run * 2 < other.values.size(); run++) {
+			FillRun(io_chunk.words.data(), other.values[run * 2], RunEnd(other.values, run), true);
+		}
+		io_chunk.count = BitOps::PopCount(io_chunk.words.data(), BitmapWords);
+		if (io_chunk.count <= ArrayMax) {
+			ToArray(io_chunk);
+		}
+		return;
+	}
+
+	if (io_chunk.type == ArrayContainer && other.type == ArrayContainer) {
+		std::vector<uint16_t> merged;
+		merged.reserve(io_chunk.values.size() + other.values.size());
+		std::set_union(io_chunk.values.begin(), io_chunk.values.end(), other.values.begin(), other.values.end(), std::back_inserter(merged));
+		io_chunk.values.swap(merged);
+		io_chunk.count = io_chunk.values.size();
+		if (io_chunk.count > ArrayMax) {
+			ToBitmap(io_chunk);
+		}
+		return;
+	}
+
+	// Either one is a bitmap, so the result is too
+	ToBitmap(io_chunk);
+	if (other.type == BitmapContainer) {
+		for (size_t word = 0; word < BitmapWords; word++) {
+			io_chunk.words[word] |= other.words[word];
+		}
+	}
+	else {
+		for (size_t i = 0; i < other.values.size(); i++) {
+			io_chunk.words[other.values[i] / BitOps::BitsPerWord] |= static_cast<uint64_t>(1) << (other.values[i] % BitOps::BitsPerWord);
+		}
+	}
+	io_chunk.count = BitOps::PopCount(io_chunk.words.data(), BitmapWords);
+}
+
+inline void CompressedBitfield::AndChunk(Chunk& io_chunk, const Chunk& other)
+{
+	// Runs are combined without expanding either side, and an array only needs each entry checked against the runs
+	if (io_chunk.type == RunContainer && other.type != BitmapContainer) {
+		std::vector<uint16_t> kept;
+		if (other.type == RunContainer) {
+			io_chunk.count = IntersectRuns(io_chunk.values, other.values, kept);
+		}
+		else {
+			ArrayInRuns(other.values, io_chunk.values, kept);
+			io_chunk.count = kept.size();
+			io_chunk.type = ArrayContainer;
+		}
+		io_chunk.values.swap(kept);
+		return;
+	}
+
+	Unpack(io_chunk);
+	if (other.type == RunContainer) {
+		if (io_chunk.type == ArrayContainer) {
+			std::vector<uint16_t> kept;
+			ArrayInRuns(io_chunk.values, other.values, kept);
+			io_chunk.values.swap(kept);
+			io_chunk.count = io_chunk.values.size();
+			return;
+		}
+
+		// Clear the gaps before, between and after the runs
+		size_t next = 0;
+		for (size_t run = 0; run * 2 < other.values.size(); run++) {
+			if (other.values[run * 2] > next) {
+				FillRun(io_chunk.words.data(), next, other.values[run * 2] - 1, false);
+			}
+			next = RunEnd(other.values, run) + 1;
+		}
+		if (next < ChunkBits) {
+			FillRun(io_chunk.words.data(), next, ChunkBits - 1, false);
+		}
+		io_chunk.count = BitOps::PopCount(io_chunk.words.data(), BitmapWords);
+		if (io_chunk.count <= ArrayMax) {
+			ToArray(io_chunk);
+		}
+		return;
+	}
+
+	if (io_chunk.type == BitmapContainer && other.type == BitmapContainer) {
+		for (size_t word = 0; word < BitmapWords; word++) {
+			io_chunk.words[word] &= other.words[word];
+		}
+		io_chunk.count = BitOps::PopCount(io_chunk.words.data(), BitmapWords);
+		if (io_chunk.count <= ArrayMax) {
+			ToArray(io_chunk);
+		}
+		return;
+	}
+
+	// At least one is an array, so the result is an array no bigger than it
+	std::vector<uint16_t> kept;
+	if (io_chunk.type == ArrayContainer && other.type == ArrayContainer) {
+		kept.reserve(std::min(io_chunk.values.size(), other.values.size()));
+		std::set_intersection(io_chunk.values.begin(), io_chunk.values.end(), other.values.begin(), other.values.end(), std::back_inserter(kept));
+	}
+	else {
+		const Chunk& array = io_chunk.type == ArrayContainer ? io_chunk : other;
+		const Chunk& bitmap = io_chunk.type == ArrayContainer ? other : io_chunk;
+		kept.reserve(array.values.size());
+		for (size_t i = 0; i < array.values.size(); i++) {
+			if (ChunkContains(bitmap, array.values[i])) {
+				kept.push_back(array.values[i]);
+			}
+		}
+	}
+	io_chunk.values.swap(kept);
+	std::vector<uint64_t>().swap(io_chunk.words);
+	io_chunk.type = ArrayContainer;
+	io_chunk.count = io_chunk.values.size();
+}
+
+inline size_t CompressedBitfield::AndCountChunk(const Chunk& lhs, const Chunk& rhs)
+{
+	if (lhs.type == BitmapContainer && rhs.type == BitmapContainer) {
+		size_t count = 0;
+		for (size_t word = 0; word < BitmapWords; word++) {
+			count += BitOps::PopCount(lhs.words[word] & rhs.words[word]);
+		}
+		return count;
+	}
+	if (lhs.type == ArrayContainer && rhs.type == ArrayContainer) {
+		size_t count = 0;
+		size_t i = 0;
+		size_t j = 0;
+		while (i < lhs.values.size() && j < rhs.values.size()) {
+			if (lhs.values[i] < rhs.values[j]) {
+				i++;
+			}
+			else if (rhs.values[j] < lhs.values[i]) {
+				j++;
+			}
+			else {
+				count++;
+				i++;
+				j++;
+			}
+		}
+		return count;
+	}
+
+	// Check every bit of the smaller side against the other
+	const Chunk& smaller = lhs.count <= rhs.count ? lhs : rhs;
+	const Chunk& larger = lhs.count <= rhs.count ? rhs : lhs;
+	size_t count = 0;
+	ForEachInChunk(smaller, [&count, &larger](size_t bit) { count += ChunkContains(larger, static_cast<uint16_t>(bit)); });
+	return count;
+}
+
+/******    Field    ******/
+
+inline bool CompressedBitfield::operator[](size_t index) const {
+	if (index >= _FieldSize) {
+		return false;
+	}
+
+	const size_t chunk = LowerChunk(index / ChunkBits);
+	return chunk < _Chunks.size() && _Chunks[chunk].key == index / ChunkBits && ChunkContains(_Chunks[chunk], static_cast<uint16_t>(index % ChunkBits));
+}
+
+inline bool CompressedBitfield::NextSetBit(size_t from, size_t& o_index) const {
+	if (from >= _FieldSize) {
+		return false;
+	}
+
+	for (size_t chunk = LowerChunk(from / ChunkBits); chunk < _Chunks.size(); chunk++) {
+		const size_t start = _Chunks[chunk].key * ChunkBits;
+		size_t bit;
+		if (ChunkNext(_Chunks[chunk], from > start ? from - start : 0, bit)) {
+			o_index = start + bit;
+			return true;
+		}
+	}
+	return false;
+}
+
+inline bool CompressedBitfield::SetBit(size_t index) {
+	if (index >= _FieldSize) {
+		return false;
+	}
+
+	const size_t key = index / ChunkBits;
+	const uint16_t bit = static_cast<uint16_t>(index % ChunkBits);
+	const size_t position = LowerChunk(key);
+	if (position == _Chunks.size() || _Chunks[position].key != key) {
+		Chunk chunk;
+		chunk.key = key;
+		chunk.type = ArrayContainer;
+		chunk.count = 1;
+		chunk.values.push_back(bit);
+		_Chunks.insert(_Chunks.begin() + position, chunk);
+		_SetBits++;
+		return true;
+	}
+
+	Chunk& chunk = _Chunks[position];
+	if (ChunkContains(chunk, bit)) {
+		return false;
+	}
+
+	Unpack(chunk);
+	if (chunk.type == ArrayContainer) {
+		chunk.values.insert(std::lower_bound(chunk.values.begin(), chunk.values.end(), bit), bit);
+		if (chunk.values.size() > ArrayMax) {
+			chunk.count++;
+			ToBitmap(chunk);
+			_SetBits++;
+			return true;
+		}
+	}
+	else {
+		chunk.words[bit / BitOps::BitsPerWord] |= static_cast<uint64_t>(1) << (bit % BitOps::BitsPerWord);
+	}
+	chunk.count++;
+	_SetBits++;
+	return true;
+}
+
+inline bool CompressedBitfield::FreeBit(size_t index) {
+	if (index >= _FieldSize) {
+		return false;
+	}
+
+	const size_t key = index / ChunkBits;
+	const uint16_t bit = static_cast<uint16_t>(index % ChunkBits);
+	const size_t position = LowerChunk(key);
+	if (position == _Chunks.size() || _Chunks[position].key != key || !ChunkContains(_Chunks[position], bit)) {
+		return false;
+	}
+
+	Chunk& chunk = _Chunks[position];
+	Unpack(chunk);
+	if (chunk.type == ArrayContainer) {
+		chunk.values.erase(std::lower_bound(chunk.values.begin(), chunk.values.end(), bit));
+	}
+	else {
+		chunk.words[bit / BitOps::BitsPerWord] &= ~(static_cast<uint64_t>(1) << (bit % BitOps::BitsPerWord));
+	}
+	chunk.count--;
+	_SetBits--;
+
+	// Empty chunks take no memory, and small bitmaps go back to being arrays
+	if (chunk.count == 0) {
+		_Chunks.erase(_Chunks.begin() + position);
+	}
+	else if (chunk.type == BitmapContainer && chunk.count <= ArrayMax) {
+		ToArray(chunk);
+	}
+	return true;
+}
+
+inline void CompressedBitfield::ToggleBit(size_t index) {
+	if (!FreeBit(index)) {
+		SetBit(index);
+	}
+}
+
+inline void CompressedBitfield::Or(const CompressedBitfield& other)
+{
+	// The last chunk may only be partly inside the field
+	const size_t endKey = (_FieldSize + ChunkBits - 1) / ChunkBits;
+	const size_t lastBits = _FieldSize - (endKey > 0 ? endKey - 1 : 0) * ChunkBits;
+
+	std::vector<Chunk> merged;
+	merged.reserve(_Chunks.size() + other._Chunks.size());
+	size_t i = 0;
+	size_t j = 0;
+	while (i < _Chunks.size() || j < other._Chunks.size()) {
+		if (j == other._Chunks.size() || (i < _Chunks.size() && _Chunks[i].key < other._Chunks[j].key)) {
+			merged.push_back(std::move(_Chunks[i++]));
+			continue;
+		}
+
+		const Chunk& theirs = other._Chunks[j++];
+		if (theirs.key >= endKey) {
+			continue;
+		}
+		if (i < _Chunks.size() && _Chunks[i].key == theirs.key) {
+			OrChunk(_Chunks[i], theirs);
+			merged.push_back(std::move(_Chunks[i++]));
+		}
+		else {
+			merged.push_back(theirs);
+		}
+
+		if (theirs.key + 1 == endKey && lastBits < ChunkBits) {
+			ClearFrom(merged.back(), lastBits);
+			if (merged.back().count == 0) {
+				merged.pop_back();
+			}
+		}
+	}
+	_Chunks.swap(merged);
+	Recount();
+}
+
+inline void CompressedBitfield::And(const CompressedBitfield& other)
+{
+	// Only chunks both sides have can keep any bits
+	size_t kept = 0;
+	size_t j = 0;
+	for (size_t i = 0; i < _Chunks.size(); i++) {
+		while (j < other._Chunks.size() && other._Chunks[j].key < _Chunks[i].key) {
+			j++;
+		}
+		if (j == other._Chunks.size() || other._Chunks[j].key != _Chunks[i].key) {
+			continue;
+		}
+
+		AndChunk(_Chunks[i], other._Chunks[j]);
+		if (_Chunks[i].count > 0) {
+			if (kept != i) {
+				_Chunks[kept] = std::move(_Chunks[i]);
+			}
+			kept++;
+		}
+	}
+	_Chunks.resize(kept);
+	Recount();
+}
+
+inline size_t CompressedBitfield::AndCount(const CompressedBitfield& other) const
+{
+	size_t count = 0;
+	size_t i = 0;
+	size_t j = 0;
+	while (i < _Chunks.size() && j < other._Chunks.size()) {
+		if (_Chunks[i].key < other._Chunks[j].key) {
+			i++;
+		}
+		else if (other._Chunks[j].key < _Chunks[i].key) {
+			j++;
+		}
+		else {
+			count += AndCountChunk(_Chunks[i++], other._Chunks[j++]);
+		}
+	}
+	return count;
+}
+
+inline void CompressedBitfield::Optimize()
+{
+	for (size_t i = 0; i < _Chunks.size(); i++) {
+		Chunk& chunk = _Chunks[i];
+		const size_t runBytes = CountRuns(chunk) * 2 * sizeof(uint16_t);
+		const size_t arrayBytes = chunk.count * sizeof(uint16_t);
+		const size_t bitmapBytes = BitmapWords * sizeof(uint64_t);
+
+		// Arrays and bitmaps are faster to change, so runs have to be strictly smaller
+		if (runBytes < (chunk.count <= ArrayMax ? arrayBytes : bitmapBytes)) {
+			ToRuns(chunk);
+		}
+		else if (chunk.count <= ArrayMax) {
+			ToArray(chunk);
+		}
+		else {
+			ToBitmap(chunk);
+		}
+		chunk.values.shrink_to_fit();
+	}
+	_Chunks.shrink_to_fit();
+}
+
+inline size_t CompressedBitfield::SavedBytes(const Chunk& chunk)
+{
+	const size_t bytes = chunk.type == BitmapContainer ? BitmapWords * sizeof(uint64_t) : chunk.values.size() * sizeof(uint16_t);
+	return (bytes + sizeof(uint64_t) - 1) & ~(sizeof(uint64_t) - 1);
+}
+
+inline size_t CompressedBitfield::SavedSize() const
+{
+	size_t bytes = sizeof(uint64_t) + _Chunks.size() * sizeof(SavedChunk);
+	for (size_t i = 0; i < _Chunks.size(); i++) {
+		bytes += SavedBytes(_Chunks[i]);
+	}
+	return bytes;
+}
+
+inline void CompressedBitfield::Save(void* o_pBuffer) const
+{
+	uint8_t* pOut = reinterpret_cast<uint8_t*>(o_pBuffer);
+	const uint64_t chunkCount = _Chunks.size();
+	memcpy(pOut, &chunkCount, sizeof(chunkCount));
+	pOut += sizeof(chunkCount);
+
+	for (size_t i = 0; i < _Chunks.size(); i++) {
+		SavedChunk saved;
+		saved.key = _Chunks[i].key;
+		saved.type = static_cast<uint32_t>(_Chunks[i].type);
+		saved.count = static_cast<uint32_t>(_Chunks[i].count);
+		saved.entries = _Chunks[i].type == BitmapContainer ? BitmapWords : _Chunks[i].values.size();
+		memcpy(pOut, &saved, sizeof(saved));
+		pOut += sizeof(saved);
+	}
+
+	for (size_t i = 0; i < _Chunks.size(); i++) {
+		const Chunk& chunk = _Chunks[i];
+		const size_t bytes = SavedBytes(chunk);
+		memset(pOut, 0, bytes);
+		if (chunk.type == BitmapContainer) {
+			memcpy(pOut, chunk.words.data(), BitmapWords * sizeof(uint64_t));
+		}
+		else if (!chunk.values.empty()) {
+			memcpy(pOut, chunk.values.data(), chunk.values.size() * sizeof(uint16_t));
+		}
+		pOut += bytes;
+	}
+}
+
+inline bool CompressedBitfield::CountLoaded(Chunk& io_chunk)
+{
+	switch (io_chunk.type) {
+	case ArrayContainer:
+		// Sorted with no repeats
+		for (size_t i = 1; i < io_chunk.values.size(); i++) {
+			if (io_chunk.values[i] <= io_chunk.values[i - 1]) {
+				return false;
+			}
+		}
+		io_chunk.count = io_chunk.values.size();
+		return true;
+	case BitmapContainer:
+		io_chunk.count = BitOps::PopCount(io_chunk.words.data(), BitmapWords);
+		if (io_chunk.count == 0) {
+			return false;
+		}
+		// Every other change turns a bitmap this small back into an array, so do the same here
+		if (io_chunk.count <= ArrayMax) {
+			ToArray(io_chunk);
+		}
+		return true;
+	case RunContainer:
+	{
+		// Each run has to end inside the chunk and start after the run before it ends
+		size_t count = 0;
+		for (size_t run = 0; run * 2 < io_chunk.values.size(); run++) {
+			const size_t end = RunEnd(io_chunk.values, run);
+			if (end >= ChunkBits || (run > 0 && io_chunk.values[run * 2] <= RunEnd(io_chunk.values, run - 1))) {
+				return false;
+			}
+			count += end - io_chunk.values[run * 2] + 1;
+		}
+		io_chunk.count = count;
+		return true;
+	}
+	}
+	return false;
+}
+
+inline CompressedBitfield* CompressedBitfield::Load(const size_t fieldSize, const void* pBuffer, const size_t size)
+{
+	const uint8_t* pIn = reinterpret_cast<const uint8_t*>(pBuffer);
+	uint64_t chunkCount;
+	if (size < sizeof(chunkCount)) {
+		return nullptr;
+	}
+	memcpy(&chunkCount, pIn, sizeof(chunkCount));
+
+	// Check every description before trusting any of them
+	const size_t endKey = (fieldSize + ChunkBits - 1) / ChunkBits;
+	if (chunkCount > endKey || (size - sizeof(chunkCount)) / sizeof(SavedChunk) < chunkCount) {
+		return nullptr;
+	}
+	const uint8_t* pDescriptions = pIn + sizeof(chunkCount);
+	const uint8_t* pData = pDescriptions + chunkCount * sizeof(SavedChunk);
+	const uint8_t* const pEnd = pIn + size;
+
+	CompressedBitfield* pBitfield = Create(fieldSize);
+	if (pBitfield == nullptr) {
+		return nullptr;
+	}
+	pBitfield->_Chunks.resize(static_cast<size_t>(chunkCount));
+
+	for (size_t i = 0; i < chunkCount; i++) {
+		SavedChunk saved;
+		memcpy(&saved, pDescriptions + i * sizeof(SavedChunk), sizeof(saved));
+
+		// The saved count isn't used. CountLoaded works it out from the bits instead.
+		const bool ordered = saved.key < endKey && (i == 0 || saved.key > pBitfield->_Chunks[i - 1].key);
+		const bool shaped =
+			(saved.type == ArrayContainer && saved.entries > 0 && saved.entries <= ArrayMax) ||
+			(saved.type == BitmapContainer && saved.entries == BitmapWords) ||
+			(saved.type == RunContainer && saved.entries % 2 == 0 && saved.entries > 0 && saved.entries <= ChunkBits);
+		if (!ordered || !shaped) {
+			delete pBitfield;
+			return nullptr;
+		}
+
+		Chunk& chunk = pBitfield->_Chunks[i];
+		chunk.key = static_cast<size_t>(saved.key);
+		chunk.type = static_cast<ContainerType>(saved.type);
+		chunk.count = 0;
+		if (chunk.type == BitmapContainer) {
+			chunk.words.resize(BitmapWords);
+		}
+		else {
+			chunk.values.resize(static_cast<size_t>(saved.entries));
+		}
+
+		const size_t bytes = SavedBytes(chunk);
+		if (static_cast<size_t>(pEnd - pData) < bytes) {
+			delete pBitfield;
+			return nullptr;
+		}
+		if (chunk.type == BitmapContainer) {
+			memcpy(chunk.words.data(), pData, BitmapWords * sizeof(uint64_t));
+		}
+		else {
+			memcpy(chunk.values.data(), pData, chunk.values.size() * sizeof(uint16_t));
+		}
+		pData += bytes;
+
+		// The last chunk can't have bits past the end of the field
+		size_t pastEnd;
+		const size_t lastBits = fieldSize - chunk.key * ChunkBits;
+		if (!CountLoaded(chunk) || (lastBits < ChunkBits && ChunkNext(chunk, lastBits, pastEnd))) {
+			delete pBitfield;
+			return nullptr;
+		}
+	}
+
+	pBitfield->Recount();
+	return pBitfield;
+}
+
+template<typename Function>
+inline void CompressedBitfield::ForEachSetBit(Function function) const
+{
+	for (size_t i = 0; i < _Chunks.size(); i++) {
+		const size_t start = _Chunks[i].key * ChunkBits;
+		ForEachInChunk(_Chunks[i], [&function, start](size_t bit) { function(start + bit); });
+	}
+}
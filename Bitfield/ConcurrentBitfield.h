@@ -0,0 +1,74 @@
+/*
+The ConcurrentBitfield is a Bitfield that many threads can set and clear bits in at once without a lock.
+Every word of bits is atomic, so setting a bit is a fetch_or on its word and clearing one is a fetch_and.
+Each of them returns whether the bit actually changed, so they double as test and set and test and clear.
+ClaimFreeBit finds a free bit and sets it with a compare and swap. If another thread changes the word first, it simply tries again.
+
+The number of free bits is split across a few counters that each sit on their own cache line,
+so threads working on different words don't all fight over a single counter.
+A word always updates the same counter, so every counter is exact once the threads touching it are done.
+FreeBits adds them up, so while other threads are working it is only a close estimate.
+
+It has no summary levels or search hints like the Bitfield has, as they can't be kept exact without a lock.
+Searches start where the last successful claim was instead.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+class ConcurrentBitfield
+{
+public:
+	// How many counters the free bits are split across.
+	static const size_t CountStripes = 8;
+
+	// Static failsafe constructor used to create a ConcurrentBitfield. Will return NULL if no memory is available.
+	// fieldSize is how many bits are needed for our field.
+	static inline ConcurrentBitfield* Create(const size_t fieldSize);
+
+	inline ~ConcurrentBitfield();
+
+	// Getters
+	size_t FieldSize() const { return _FieldSize; }
+	inline size_t FreeBits() const; // Other threads may change this as soon as it is read.
+
+	// Returns true if the bit is set. Safe to call from any thread.
+	inline bool operator[](size_t index) const;
+
+	// Accessors. All of them are safe to call from any thread.
+	inline bool SetBit(size_t index); // Sets a bit to 1. Returns true if it was 0, so only one thread setting a bit gets true.
+	inline bool FreeBit(size_t index); // Sets a bit to 0. Returns true if it was 1.
+	inline bool ToggleBit(size_t index); // Flips a bit. Returns what the bit is now.
+
+	// Finds a free bit and sets it. Returns false if a full pass over the field didn't find one.
+	inline bool ClaimFreeBit(size_t& o_index);
+	// Sets up to count free bits, taking as many as it can from each word with one compare and swap.
+	// The index of each bit set is written to o_indices. Returns how many were set, which is less than count only if a full pass didn't find enough.
+	inline size_t ClaimFreeBits(size_t count, size_t* o_indices);
+	// Sets every bit in indices to 0. Neighboring indices in the same word are cleared together. Returns how many were 1.
+	inline size_t ReleaseBits(const size_t* indices, size_t count);
+
+private:
+	// Each counter gets a cache line to itself
+	struct alignas(64) Stripe
+	{
+		std::atomic<ptrdiff_t> freeBits; // Can dip below 0 for a moment while one thread sets a bit another thread just cleared.
+	};
+
+	inline ConcurrentBitfield(size_t fieldSize, std::atomic<uint64_t>* pWords);
+
+	// Moves the free count of the counter that fieldNumber belongs to.
+	inline void AddFree(size_t fieldNumber, ptrdiff_t change);
+
+	size_t _FieldSize; // The number of bits in our bitfield.
+	size_t _WordCount; // How many words of bits?
+	std::atomic<uint64_t>* _pWords; // The bits. The bits past the end of the field are always set so they can never be claimed.
+
+	alignas(64) std::atomic<size_t> _SearchStart; // The word the next claim starts at.
+	Stripe _Stripes[CountStripes];
+};
+
+#include "ConcurrentBitfield.inl"
@@ -0,0 +1,225 @@
+/*
+An inline file used to define my inline functions for the ConcurrentBitfield.
+Setting a bit uses acquire and release ordering, so a thread that sees a bit set also sees what was written before it was set.
+*/
+
+#include <new>
+
+#include "BitOps.h"
+
+inline ConcurrentBitfield* ConcurrentBitfield::Create(const size_t fieldSize)
+{
+	const size_t wordCount = (fieldSize + BitOps::BitsPerWord - 1) / BitOps::BitsPerWord;
+	std::atomic<uint64_t>* pWords = new (std::nothrow) std::atomic<uint64_t>[wordCount > 0 ? wordCount : 1];
+	if (pWords == nullptr)
+	{
+		return nullptr;
+	}
+
+	ConcurrentBitfield* pBitfield = new (std::nothrow) ConcurrentBitfield(fieldSize, pWords);
+	if (pBitfield == nullptr)
+	{
+		delete[] pWords;
+		return nullptr;
+	}
+	return pBitfield;
+}
+
+inline ConcurrentBitfield::ConcurrentBitfield(size_t fieldSize, std::atomic<uint64_t>* pWords) :
+	_FieldSize(fieldSize),
+	_WordCount((fieldSize + BitOps::BitsPerWord - 1) / BitOps::BitsPerWord),
+	_pWords(pWords),
+	_SearchStart(0)
+{
+	for (size_t i = 0; i < _WordCount; i++)
+	{
+		_pWords[i].store(0, std::memory_order_relaxed);
+	}
+	// Bits past the end of the field are marked as set so they can never be claimed
+	if (fieldSize % BitOps::BitsPerWord != 0)
+	{
+		_pWords[_WordCount - 1].store(~BitOps::LowMask(fieldSize % BitOps::BitsPerWord), std::memory_order_relaxed);
+	}
+
+	for (size_t stripe = 0; stripe < CountStripes; stripe++)
+	{
+		_Stripes[stripe].freeBits.store(0, std::memory_order_relaxed);
+	}
+	for (size_t i = 0; i < _WordCount; i++)
+	{
+		AddFree(i, BitOps::PopCount(~_pWords[i].load(std::memory_order_relaxed)));
+	}
+}
+
+inline ConcurrentBitfield::~ConcurrentBitfield()
+{
+	delete[] _pWords;
+}
+
+inline void ConcurrentBitfield::AddFree(size_t fieldNumber, ptrdiff_t change)
+{
+	_Stripes[fieldNumber % CountStripes].freeBits.fetch_add(change, std::memory_order_relaxed);
+}
+
+inline size_t ConcurrentBitfield::FreeBits() const
+{
+	ptrdiff_t total = 0;
+	for (size_t stripe = 0; stripe < CountStripes; stripe++)
+	{
+		total += _Stripes[stripe].freeBits.load(std::memory_order_relaxed);
+	}
+	return total > 0 ? static_cast<size_t>(total) : 0;
+}
+
+inline bool ConcurrentBitfield::operator[](size_t index) const {
+	if (index >= _FieldSize) {
+		return false;
+	}
+
+	const uint64_t mask = static_cast<uint64_t>(1) << (index % BitOps::BitsPerWord);
+	return (_pWords[index / BitOps::BitsPerWord].load(std::memory_order_acquire) & mask) != 0;
+}
+
+inline bool ConcurrentBitfield::SetBit(size_t index) {
+	if (index >= _FieldSize) {
+		return false;
+	}
+
+	const size_t fieldNumber = index / BitOps::BitsPerWord;
+	const uint64_t mask = static_cast<uint64_t>(1) << (index % BitOps::BitsPerWord);
+	const uint64_t before = _pWords[fieldNumber].fetch_or(mask, std::memory_order_acq_rel);
+	if (before & mask) {
+		return false;
+	}
+	AddFree(fieldNumber, -1);
+	return true;
+}
+
+inline bool ConcurrentBitfield::FreeBit(size_t index) {
+	if (index >= _FieldSize) {
+		return false;
+	}
+
+	const size_t fieldNumber = index / BitOps::BitsPerWord;
+	const uint64_t mask = static_cast<uint64_t>(1) << (index % BitOps::BitsPerWord);
+	const uint64_t before = _pWords[fieldNumber].fetch_and(~mask, std::memory_order_acq_rel);
+	if (!(before & mask)) {
+		return false;
+	}
+	AddFree(fieldNumber, 1);
+	return true;
+}
+
+inline bool ConcurrentBitfield::ToggleBit(size_t index) {
+	if (index >= _FieldSize) {
+		return false;
+	}
+
+	const size_t fieldNumber = index / BitOps::BitsPerWord;
+	const uint64_t mask = static_cast<uint64_t>(1) << (index % BitOps::BitsPerWord);
+	const bool set = !(_pWords[fieldNumber].fetch_xor(mask, std::memory_order_acq_rel) & mask);
+	AddFree(fieldNumber, set ? -1 : 1);
+	return set;
+}
+
+inline bool ConcurrentBitfield::ClaimFreeBit(size_t& o_index) {
+	size_t word = _SearchStart.load(std::memory_order_relaxed);
+	if (word >= _WordCount) {
+		word = 0;
+	}
+
+	for (size_t visited = 0; visited < _WordCount; visited++) {
+		uint64_t bits = _pWords[word].load(std::memory_order_relaxed);
+		while (bits != BitOps::AllSet) {
+			const uint64_t mask = static_cast<uint64_t>(1) << BitOps::CountTrailingZeros(~bits);
+			// If another thread changed the word first, bits is reloaded and we try again
+			if (_pWords[word].compare_exchange_weak(bits, bits | mask, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+				AddFree(word, -1);
+				_SearchStart.store(word, std::memory_order_relaxed);
+				o_index = word * BitOps::BitsPerWord + BitOps::CountTrailingZeros(mask);
+				return true;
+			}
+		}
+
+		// This word is full, try the next one
+		if (++word == _WordCount) {
+			word = 0;
+		}
+	}
+
+	o_index = -1;
+	return false;
+}
+
+inline size_t ConcurrentBitfield::ClaimFreeBits(size_t count, size_t* o_indices) {
+	size_t word = _SearchStart.load(std::memory_order_relaxed);
+	if (word >= _WordCount) {
+		word = 0;
+	}
+
+	size_t claimed = 0;
+	for (size_t visited = 0; visited < _WordCount && claimed < count; visited++) {
+		uint64_t bits = _pWords[word].load(std::memory_order_relaxed);
+		while (bits != BitOps::AllSet) {
+			// Take as many of the free bits in this word as we still need, lowest first
+			uint64_t want = 0;
+			uint64_t freeBits = ~bits;
+			size_t wanted = 0;
+			while (freeBits != 0 && claimed + wanted < count) {
+				want |= freeBits & (~freeBits + 1);
+				freeBits &= freeBits - 1;
+				wanted++;
+			}
+
+			if (_pWords[word].compare_exchange_weak(bits, bits | want, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+				AddFree(word, -static_cast<ptrdiff_t>(wanted));
+				while (want != 0) {
+					o_indices[claimed++] = word * BitOps::BitsPerWord + BitOps::CountTrailingZeros(want);
+					want &= want - 1;
+				}
+				break;
+			}
+		}
+
+		// Either we have everything we need or this word is full now
+		if (claimed < count && ++word == _WordCount) {
+			word = 0;
+		}
+	}
+	if (_WordCount > 0) {
+		_SearchStart.store(word, std::memory_order_relaxed);
+	}
+
+	return claimed;
+}
+
+inline size_t ConcurrentBitfield::ReleaseBits(const size_t* indices, size_t count) {
+	size_t released = 0;
+	size_t word = 0;
+	uint64_t mask = 0;
+
+	// Gather every following index that lands in the same word and clear them all with one atomic operation
+	for (size_t i = 0; i <= count; i++) {
+		const bool valid = i < count && indices[i] < _FieldSize;
+		if (valid && mask != 0 && indices[i] / BitOps::BitsPerWord == word) {
+			mask |= static_cast<uint64_t>(1) << (indices[i] % BitOps::BitsPerWord);
+			continue;
+		}
+
+		if (mask != 0) {
+			// Only count the bits that were actually set, so releasing twice doesn't count twice
+			const uint64_t before = _pWords[word].fetch_and(~mask, std::memory_order_acq_rel);
+			const size_t cleared = BitOps::PopCount(before & mask);
+			if (cleared > 0) {
+				AddFree(word, static_cast<ptrdiff_t>(cleared));
+				released += cleared;
+			}
+			mask = 0;
+		}
+		if (valid) {
+			word = indices[i] / BitOps::BitsPerWord;
+			mask = static_cast<uint64_t>(1) << (indices[i] % BitOps::BitsPerWord);
+		}
+	}
+	return released;
+}
@@ -5,6 +5,7 @@ Date: 3/30/2016
 The Flock Component is an IComponent used to simulate flocking behavior.
 It communicates with its GameObject's Rigidbody, which handles the physics of the movement.
 The GameObject stores the Object's Position, which is used to separate and group objects that are flocking.
+Each Flock is a handle into the FlockSystem, which updates the whole flock at once when the game loop calls FlockSystem::Update.
 
 This Sample Code is from my own engine written in C++. It uses my own custom SmartPointer,
 a custom cVector class for a mathematical vector, as well as the Vector container from the Standard Library.
@@ -19,6 +20,10 @@ namespace Physics
 {
 	class Rigidbody;
 }
+namespace AI
+{
+	class FlockSystem;
+}
 
 namespace Component
 {
@@ -32,6 +37,7 @@ namespace Component
 		
 		~Flock();
 
+		// Does nothing. The game loop calls AI::FlockSystem::Update once per frame, which steers every Flock.
 		void Update(float i_TimeSinceLastFrame);
 
 		SmartPointer<Physics::Rigidbody> m_Rigidbody;		
@@ -49,9 +55,11 @@ namespace Component
 		float cohesionWeight;
 
 	private:
+		friend class AI::FlockSystem;
+
 		Flock(SmartPointer<World::GameObject> i_pActor);
 
-		std::vector<SmartPointer<World::GameObject>> neighbors;
+		size_t m_SystemIndex; // Where our agent is in the FlockSystem.
 
 		// Store the max speed squared.
 		// Used to make sure the flocking object is not going too quickly
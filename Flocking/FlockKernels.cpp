@@ -0,0 +1,225 @@
+/*
+	This is the complementary cpp file for FlockKernels.h
+	The SSE kernel handles 4 neighbors at a time and the AVX2 kernel handles 8.
+	Both finish off the last few neighbors with the scalar loop.
+*/
+
+#include "FlockKernels.h"
+
+#include "../Math/SIMD.h"
+
+#if MATH_SIMD_X86
+	#include <immintrin.h>
+#endif
+
+namespace AI
+{
+	void NeighborBlock::Clear()
+	{
+		positionX.clear();
+		positionY.clear();
+		positionZ.clear();
+		velocityX.clear();
+		velocityY.clear();
+		velocityZ.clear();
+	}
+
+	namespace FlockKernels
+	{
+		// Adds neighbors [i_Begin, Count) to o_Sums one at a time
+		static inline void AccumulateRange(const NeighborBlock& i_Neighbors, size_t i_Begin, float i_X, float i_Y, float i_Z, SteeringSums& o_Sums)
+		{
+			for (size_t i = i_Begin; i < i_Neighbors.Count(); i++)
+			{
+				const float dx = i_X - i_Neighbors.positionX[i];
+				const float dy = i_Y - i_Neighbors.positionY[i];
+				const float dz = i_Z - i_Neighbors.positionZ[i];
+				const float lengthSqr = dx * dx + dy * dy + dz * dz;
+				if (lengthSqr != 0)
+				{
+					const float recip = 1.0f / lengthSqr;
+					o_Sums.separationX += dx * recip;
+					o_Sums.separationY += dy * recip;
+					o_Sums.separationZ += dz * recip;
+				}
+
+				o_Sums.velocityX += i_Neighbors.velocityX[i];
+				o_Sums.velocityY += i_Neighbors.velocityY[i];
+				o_Sums.velocityZ += i_Neighbors.velocityZ[i];
+
+				o_Sums.positionX += i_Neighbors.positionX[i];
+				o_Sums.positionY += i_Neighbors.positionY[i];
+				o_Sums.positionZ += i_Neighbors.positionZ[i];
+			}
+		}
+
+		void AccumulateScalar(const NeighborBlock& i_Neighbors, float i_X, float i_Y, float i_Z, SteeringSums& o_Sums)
+		{
+			o_Sums = SteeringSums();
+			AccumulateRange(i_Neighbors, 0, i_X, i_Y, i_Z, o_Sums);
+		}
+
+#if MATH_SIMD_X86
+		// Adds the 4 lanes of a register together
+		static inline float HorizontalSum(__m128 i_Value)
+		{
+			const __m128 high = _mm_movehl_ps(i_Value, i_Value);
+			const __m128 pairs = _mm_add_ps(i_Value, high);
+			return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+		}
+
+		void AccumulateSSE(const NeighborBlock& i_Neighbors, float i_X, float i_Y, float i_Z, SteeringSums& o_Sums)
+		{
+			const __m128 x = _mm_set1_ps(i_X);
+			const __m128 y = _mm_set1_ps(i_Y);
+			const __m128 z = _mm_set1_ps(i_Z);
+			const __m128 two = _mm_set1_ps(2.0f);
+			const __m128 zero = _mm_setzero_ps();
+
+			__m128 separationX = zero, separationY = zero, separationZ = zero;
+			__m128 velocityX = zero, velocityY = zero, velocityZ = zero;
+			__m128 positionX = zero, positionY = zero, positionZ = zero;
+
+			const size_t count = i_Neighbors.Count() & ~static_cast<size_t>(3);
+			for (size_t i = 0; i < count; i += 4)
+			{
+				const __m128 px = _mm_loadu_ps(&i_Neighbors.positionX[i]);
+				const __m128 py = _mm_loadu_ps(&i_Neighbors.positionY[i]);
+				const __m128 pz = _mm_loadu_ps(&i_Neighbors.positionZ[i]);
+
+				const __m128 dx = _mm_sub_ps(x, px);
+				const __m128 dy = _mm_sub_ps(y, py);
+				const __m128 dz = _mm_sub_ps(z, pz);
+				const __m128 lengthSqr = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+
+				// Approximate 1 / lengthSqr, then refine it with a Newton-Raphson step: r = r * (2 - a * r)
+				__m128 recip = _mm_rcp_ps(lengthSqr);
+				recip = _mm_mul_ps(recip, _mm_sub_ps(two, _mm_mul_ps(lengthSqr, recip)));
+				// Neighbors sitting right on top of us don't push
+				recip = _mm_and_ps(recip, _mm_cmpneq_ps(lengthSqr, zero));
+
+				separationX = _mm_add_ps(separationX, _mm_mul_ps(dx, recip));
+				separationY = _mm_add_ps(separationY, _mm_mul_ps(dy, recip));
+				separationZ = _mm_add_ps(separationZ, _mm_mul_ps(dz, recip));
+
+				velocityX = _mm_add_ps(velocityX, _mm_loadu_ps(&i_Neighbors.velocityX[i]));
+				velocityY = _mm_add_ps(velocityY, _mm_loadu_ps(&i_Neighbors.velocityY[i]));
+				velocityZ = _mm_add_ps(velocityZ, _mm_loadu_ps(&i_Neighbors.velocityZ[i]));
+
+				positionX = _mm_add_ps(positionX, px);
+				positionY = _mm_add_ps(positionY, py);
+				positionZ = _mm_add_ps(positionZ, pz);
+			}
+
+			o_Sums.separationX = HorizontalSum(separationX);
+			o_Sums.separationY = HorizontalSum(separationY);
+			o_Sums.separationZ = HorizontalSum(separationZ);
+			o_Sums.velocityX = HorizontalSum(velocityX);
+			o_Sums.velocityY = HorizontalSum(velocityY);
+			o_Sums.velocityZ = HorizontalSum(velocityZ);
+			o_Sums.positionX = HorizontalSum(positionX);
+			o_Sums.positionY = HorizontalSum(positionY);
+			o_Sums.positionZ = HorizontalSum(positionZ);
+
+			AccumulateRange(i_Neighbors, count, i_X, i_Y, i_Z, o_Sums);
+		}
+
+		// Adds the 8 lanes of a register together
+		MATH_TARGET_AVX2 static inline float HorizontalSum(__m256 i_Value)
+		{
+			const __m128 low = _mm256_castps256_ps128(i_Value);
+			const __m128 high = _mm256_extractf128_ps(i_Value, 1);
+			const __m128 quad = _mm_add_ps(low, high);
+			const __m128 pairs = _mm_add_ps(quad, _mm_movehl_ps(quad, quad));
+			return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+		}
+
+		MATH_TARGET_AVX2 void AccumulateAVX2(const NeighborBlock& i_Neighbors, float i_X, float i_Y, float i_Z, SteeringSums& o_Sums)
+		{
+			const __m256 x = _mm256_set1_ps(i_X);
+			const __m256 y = _mm256_set1_ps(i_Y);
+			const __m256 z = _mm256_set1_ps(i_Z);
+			const __m256 two = _mm256_set1_ps(2.0f);
+			const __m256 zero = _mm256_setzero_ps();
+
+			__m256 separationX = zero, separationY = zero, separationZ = zero;
+			__m256 velocityX = zero, velocityY = zero, velocityZ = zero;
+			__m256 positionX = zero, positionY = zero, positionZ = zero;
+
+			const size_t count = i_Neighbors.Count() & ~static_cast<size_t>(7);
+			for (size_t i = 0; i < count; i += 8)
+			{
+				const __m256 px = _mm256_loadu_ps(&i_Neighbors.positionX[i]);
+				const __m256 py = _mm256_loadu_ps(&i_Neighbors.positionY[i]);
+				const __m256 pz = _mm256_loadu_ps(&i_Neighbors.positionZ[i]);
+
+				const __m256 dx = _mm256_sub_ps(x, px);
+				const __m256 dy = _mm256_sub_ps(y, py);
+				const __m256 dz = _mm256_sub_ps(z, pz);
+				const __m256 lengthSqr = _mm256_fmadd_ps(dz, dz, _mm256_fmadd_ps(dy, dy, _mm256_mul_ps(dx, dx)));
+
+				// Approximate 1 / lengthSqr, then refine it with a Newton-Raphson step: r = r * (2 - a * r)
+				__m256 recip = _mm256_rcp_ps(lengthSqr);
+				recip = _mm256_mul_ps(recip, _mm256_fnmadd_ps(lengthSqr, recip, two));
+				// Neighbors sitting right on top of us don't push
+				recip = _mm256_and_ps(recip, _mm256_cmp_ps(lengthSqr, zero, _CMP_NEQ_OQ));
+
+				separationX = _mm256_fmadd_ps(dx, recip, separationX);
+				separationY = _mm256_fmadd_ps(dy, recip, separationY);
+				separationZ = _mm256_fmadd_ps(dz, recip, separationZ);
+
+				velocityX = _mm256_add_ps(velocityX, _mm256_loadu_ps(&i_Neighbors.velocityX[i]));
+				velocityY = _mm256_add_ps(velocityY, _mm256_loadu_ps(&i_Neighbors.velocityY[i]));
+				velocityZ = _mm256_add_ps(velocityZ, _mm256_loadu_ps(&i_Neighbors.velocityZ[i]));
+
+				positionX = _mm256_add_ps(positionX, px);
+				positionY = _mm256_add_ps(positionY, py);
+				positionZ = _mm256_add_ps(positionZ, pz);
+			}
+
+			o_Sums.separationX = HorizontalSum(separationX);
+			o_Sums.separationY = HorizontalSum(separationY);
+			o_Sums.separationZ = HorizontalSum(separationZ);
+			o_Sums.velocityX = HorizontalSum(velocityX);
+			o_Sums.velocityY = HorizontalSum(velocityY);
+			o_Sums.velocityZ = HorizontalSum(velocityZ);
+			o_Sums.positionX = HorizontalSum(positionX);
+			o_Sums.positionY = HorizontalSum(positionY);
+			o_Sums.positionZ = HorizontalSum(positionZ);
+
+			AccumulateRange(i_Neighbors, count, i_X, i_Y, i_Z, o_Sums);
+		}
+#else
+		// Without x86 there are no SIMD kernels, so fall back to the scalar one
+		void AccumulateSSE(const NeighborBlock& i_Neighbors, float i_X, float i_Y, float i_Z, SteeringSums& o_Sums)
+		{
+			AccumulateScalar(i_Neighbors, i_X, i_Y, i_Z, o_Sums);
+		}
+
+		void AccumulateAVX2(const NeighborBlock& i_Neighbors, float i_X, float i_Y, float i_Z, SteeringSums& o_Sums)
+		{
+			AccumulateScalar(i_Neighbors, i_X, i_Y, i_Z, o_Sums);
+		}
+#endif
+
+		static AccumulateFunction PickAccumulate()
+		{
+			switch (Math::SIMD::Supported())
+			{
+			case Math::SIMD::AVX512:
+			case Math::SIMD::AVX2:
+				return AccumulateAVX2;
+			case Math::SIMD::SSE2:
+				return AccumulateSSE;
+			default:
+				return AccumulateScalar;
+			}
+		}
+
+		void Accumulate(const NeighborBlock& i_Neighbors, float i_X, float i_Y, float i_Z, SteeringSums& o_Sums)
+		{
+			static const AccumulateFunction s_Accumulate = PickAccumulate();
+			s_Accumulate(i_Neighbors, i_X, i_Y, i_Z, o_Sums);
+		}
+	}
+}
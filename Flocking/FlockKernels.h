@@ -0,0 +1,65 @@
+/*
+The FlockKernels add up everything an agent needs from its neighbors in one pass:
+the separation push, the sum of their velocities and the sum of their positions.
+The neighbors are copied into a NeighborBlock first so the kernels can read them with SIMD loads.
+
+Separation used to be the normalized distance divided by the length, which costs a square root and two divides per neighbor.
+It is the same as the distance divided by the length squared, so the kernels only need one reciprocal per neighbor.
+The SIMD kernels use the approximate reciprocal instruction refined with one Newton-Raphson step,
+which keeps each separation term within 1e-6 of the exact value relative to its size.
+That holds as long as the squared distance to the neighbor is a normal float, so neighbors closer than about 1e-19 aren't covered.
+Tests/FlockKernelsTest.cpp checks the bound.
+
+The best kernel for the CPU is picked the first time Accumulate is called.
+Each kernel adds in its own order, so the sums can differ in the last few bits between kernels, but a given kernel always gives the same answer.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace AI
+{
+	// The neighbors of one agent stored as separate arrays.
+	struct NeighborBlock
+	{
+		std::vector<float> positionX, positionY, positionZ;
+		std::vector<float> velocityX, velocityY, velocityZ;
+
+		void Clear();
+		inline void Add(float i_PositionX, float i_PositionY, float i_PositionZ, float i_VelocityX, float i_VelocityY, float i_VelocityZ);
+		size_t Count() const { return positionX.size(); }
+	};
+
+	// What the kernels add up for an agent.
+	struct SteeringSums
+	{
+		float separationX, separationY, separationZ;
+		float velocityX, velocityY, velocityZ;
+		float positionX, positionY, positionZ;
+	};
+
+	namespace FlockKernels
+	{
+		typedef void (*AccumulateFunction)(const NeighborBlock& i_Neighbors, float i_X, float i_Y, float i_Z, SteeringSums& o_Sums);
+
+		// Adds up the steering sums for an agent at (i_X, i_Y, i_Z) using the fastest kernel this CPU supports.
+		void Accumulate(const NeighborBlock& i_Neighbors, float i_X, float i_Y, float i_Z, SteeringSums& o_Sums);
+
+		// The individual kernels. The SIMD kernels must only be called if the CPU supports them.
+		void AccumulateScalar(const NeighborBlock& i_Neighbors, float i_X, float i_Y, float i_Z, SteeringSums& o_Sums);
+		void AccumulateSSE(const NeighborBlock& i_Neighbors, float i_X, float i_Y, float i_Z, SteeringSums& o_Sums);
+		void AccumulateAVX2(const NeighborBlock& i_Neighbors, float i_X, float i_Y, float i_Z, SteeringSums& o_Sums);
+	}
+
+	inline void NeighborBlock::Add(float i_PositionX, float i_PositionY, float i_PositionZ, float i_VelocityX, float i_VelocityY, float i_VelocityZ)
+	{
+		positionX.push_back(i_PositionX);
+		positionY.push_back(i_PositionY);
+		positionZ.push_back(i_PositionZ);
+		velocityX.push_back(i_VelocityX);
+		velocityY.push_back(i_VelocityY);
+		velocityZ.push_back(i_VelocityZ);
+	}
+}
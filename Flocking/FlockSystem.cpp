@@ -0,0 +1,292 @@
+/*
+	This is the complementary cpp file for FlockSystem.h
+	The steering math matches what each Flock used to calculate on its own,
+	but reads every neighbor out of the system's arrays and adds them up with the FlockKernels.
+*/
+
+#include "FlockSystem.h"
+
+#include <math.h>
+
+#include "Flock.h"
+#include "../GameObject.h"
+#include "../../Physics/Rigidbody.h"
+#include "../Threading/WorkerPool.h"
+#include "Math/cVector.h"
+#include "Math/Functions.h"
+
+namespace AI
+{
+	FlockSystem& FlockSystem::Get()
+	{
+		static FlockSystem s_System;
+		return s_System;
+	}
+
+	FlockSystem::FlockSystem() :
+		m_Read(0),
+		m_pWorkers(nullptr),
+		m_Scratch(1)
+	{
+	}
+
+	FlockSystem::~FlockSystem()
+	{
+		delete m_pWorkers;
+	}
+
+	void FlockSystem::AgentState::Resize(size_t count)
+	{
+		positionX.resize(count);
+		positionY.resize(count);
+		positionZ.resize(count);
+		velocityX.resize(count);
+		velocityY.resize(count);
+		velocityZ.resize(count);
+	}
+
+	bool FlockSystem::ThreadCount(size_t threadCount)
+	{
+		delete m_pWorkers;
+		m_pWorkers = nullptr;
+		m_Scratch.resize(1);
+
+		if (threadCount <= 1)
+		{
+			return true;
+		}
+
+		m_pWorkers = Threading::WorkerPool::Create(threadCount);
+		if (m_pWorkers == nullptr)
+		{
+			return false;
+		}
+		m_Scratch.resize(m_pWorkers->ThreadCount());
+		return true;
+	}
+
+	size_t FlockSystem::ThreadCount() const
+	{
+		return m_pWorkers == nullptr ? 1 : m_pWorkers->ThreadCount();
+	}
+
+	void FlockSystem::Add(Component::Flock* i_pFlock)
+	{
+		i_pFlock->m_SystemIndex = m_Flocks.size();
+		m_Flocks.push_back(i_pFlock);
+	}
+
+	void FlockSystem::Remove(Component::Flock* i_pFlock)
+	{
+		const size_t index = i_pFlock->m_SystemIndex;
+		if (index >= m_Flocks.size() || m_Flocks[index] != i_pFlock)
+		{
+			return;
+		}
+
+		// Move the last agent into the empty slot so the arrays stay packed
+		m_Flocks[index] = m_Flocks.back();
+		m_Flocks[index]->m_SystemIndex = index;
+		m_Flocks.pop_back();
+	}
+
+	void FlockSystem::Update(float i_DeltaTime)
+	{
+		Gather();
+
+		const AgentState& read = m_State[m_Read];
+		const size_t count = m_Flocks.size();
+		if (count > BruteForceLimit)
+		{
+			// Size the cells to the largest neighbor radius so a query only has to look at the surrounding cells
+			float maxDistanceSqr = 0;
+			for (size_t i = 0; i < count; i++)
+			{
+				if (m_Active[i] && m_NeighborDistanceSqr[i] > maxDistanceSqr)
+				{
+					maxDistanceSqr = m_NeighborDistanceSqr[i];
+				}
+			}
+			m_Grid.Build(read.positionX.data(), read.positionY.data(), read.positionZ.data(), count, sqrtf(maxDistanceSqr));
+		}
+
+		// Every agent only writes its own slot, so it does not matter which thread steers it
+		if (m_pWorkers == nullptr)
+		{
+			for (size_t i = 0; i < count; i++)
+			{
+				Steer(i, m_Scratch[0]);
+			}
+		}
+		else
+		{
+			m_pWorkers->ParallelFor(count, AgentsPerChunk, [this](size_t i_Begin, size_t i_End, size_t i_Worker)
+			{
+				for (size_t i = i_Begin; i < i_End; i++)
+				{
+					Steer(i, m_Scratch[i_Worker]);
+				}
+			});
+		}
+
+		Scatter();
+
+		// This frame's state is what next frame reads
+		m_Read = 1 - m_Read;
+	}
+
+	void FlockSystem::Gather()
+	{
+		const size_t count = m_Flocks.size();
+
+		AgentState& read = m_State[m_Read];
+		read.Resize(count);
+		m_State[1 - m_Read].Resize(count);
+		m_Active.resize(count);
+		m_NeighborDistanceSqr.resize(count);
+		m_SeparationWeight.resize(count);
+		m_AlignmentWeight.resize(count);
+		m_CohesionWeight.resize(count);
+		m_MaxSpeedSqr.resize(count);
+
+		for (size_t i = 0; i < count; i++)
+		{
+			Component::Flock* pFlock = m_Flocks[i];
+			m_Active[i] = pFlock->gameObject.HavePtr() && pFlock->m_Rigidbody.HavePtr();
+			if (!m_Active[i])
+			{
+				read.positionX[i] = read.positionY[i] = read.positionZ[i] = 0;
+				read.velocityX[i] = read.velocityY[i] = read.velocityZ[i] = 0;
+				continue;
+			}
+
+			const Math::cVector position = pFlock->gameObject->Position();
+			const Math::cVector velocity = pFlock->m_Rigidbody->Velocity();
+			read.positionX[i] = position.x;
+			read.positionY[i] = position.y;
+			read.positionZ[i] = position.z;
+			read.velocityX[i] = velocity.x;
+			read.velocityY[i] = velocity.y;
+			read.velocityZ[i] = velocity.z;
+
+			m_NeighborDistanceSqr[i] = pFlock->neighborDistanceSqr;
+			m_SeparationWeight[i] = pFlock->separationWeight;
+			m_AlignmentWeight[i] = pFlock->alignmentWeight;
+			m_CohesionWeight[i] = pFlock->cohesionWeight;
+			m_MaxSpeedSqr[i] = pFlock->MaxSpeedSqr();
+		}
+	}
+
+	void FlockSystem::Steer(size_t i, Scratch& io_Scratch)
+	{
+		const AgentState& read = m_State[m_Read];
+		AgentState& write = m_State[1 - m_Read];
+
+		write.positionX[i] = read.positionX[i];
+		write.positionY[i] = read.positionY[i];
+		write.positionZ[i] = read.positionZ[i];
+		write.velocityX[i] = read.velocityX[i];
+		write.velocityY[i] = read.velocityY[i];
+		write.velocityZ[i] = read.velocityZ[i];
+		if (!m_Active[i])
+		{
+			return;
+		}
+
+		const float x = read.positionX[i];
+		const float y = read.positionY[i];
+		const float z = read.positionZ[i];
+
+		// Get a list of neighbors (other agents within our neighbor distance)
+		io_Scratch.indices.clear();
+		if (m_Flocks.size() > BruteForceLimit)
+		{
+			m_Grid.Query(x, y, z, m_NeighborDistanceSqr[i], i, io_Scratch.indices);
+		}
+		else
+		{
+			for (size_t j = 0; j < m_Flocks.size(); j++)
+			{
+				const float dx = read.positionX[j] - x;
+				const float dy = read.positionY[j] - y;
+				const float dz = read.positionZ[j] - z;
+				if (j != i && dx * dx + dy * dy + dz * dz < m_NeighborDistanceSqr[i])
+				{
+					io_Scratch.indices.push_back(j);
+				}
+			}
+		}
+
+		// Copy the neighbors next to each other so the kernel can add them all up in one pass
+		NeighborBlock& neighbors = io_Scratch.neighbors;
+		neighbors.Clear();
+		for (size_t n = 0; n < io_Scratch.indices.size(); n++)
+		{
+			const size_t j = io_Scratch.indices[n];
+			if (m_Active[j])
+			{
+				neighbors.Add(read.positionX[j], read.positionY[j], read.positionZ[j], read.velocityX[j], read.velocityY[j], read.velocityZ[j]);
+			}
+		}
+		const size_t neighborCount = neighbors.Count();
+		if (neighborCount == 0)
+		{
+			// No neighbors so nothing to create a flocking pattern
+			return;
+		}
+
+		SteeringSums sums;
+		FlockKernels::Accumulate(neighbors, x, y, z, sums);
+
+		// Create our Alignment Vector. The average velocity points the same way as the sum, so just normalize the sum.
+		Math::cVector alignment;
+		{
+			const Math::cVector velocitySum(sums.velocityX, sums.velocityY, sums.velocityZ);
+			if (velocitySum.GetLengthSqr() > Math::s_epsilon)
+			{
+				alignment = velocitySum.CreateNormalized();
+			}
+		}
+
+		// Create our Cohesion Vector
+		Math::cVector cohesion;
+		{
+			const float recip = 1.0f / neighborCount;
+			const Math::cVector toAverage(sums.positionX * recip - x, sums.positionY * recip - y, sums.positionZ * recip - z);
+			if (toAverage.GetLengthSqr() != 0)
+			{
+				cohesion = toAverage.CreateNormalized();
+			}
+		}
+
+		// Add our 3 vectors with the appropriate weights
+		const Math::cVector separation(sums.separationX, sums.separationY, sums.separationZ);
+		Math::cVector steering = (separation * m_SeparationWeight[i]) + (alignment * m_AlignmentWeight[i]) + (cohesion * m_CohesionWeight[i]);
+		if (steering.GetLengthSqr() != 0)
+		{
+			steering.Normalize();
+		}
+
+		Math::cVector velocity(read.velocityX[i] + steering.x, read.velocityY[i] + steering.y, read.velocityZ[i] + steering.z);
+		if (velocity.GetLengthSqr() > m_MaxSpeedSqr[i])
+		{
+			velocity = velocity.CreateNormalized() * sqrtf(m_MaxSpeedSqr[i]);
+		}
+
+		write.velocityX[i] = velocity.x;
+		write.velocityY[i] = velocity.y;
+		write.velocityZ[i] = velocity.z;
+	}
+
+	void FlockSystem::Scatter()
+	{
+		const AgentState& write = m_State[1 - m_Read];
+		for (size_t i = 0; i < m_Flocks.size(); i++)
+		{
+			if (m_Active[i])
+			{
+				m_Flocks[i]->m_Rigidbody->Velocity(Math::cVector(write.velocityX[i], write.velocityY[i], write.velocityZ[i]));
+			}
+		}
+	}
+}
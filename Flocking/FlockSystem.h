@@ -0,0 +1,109 @@
+/*
+The FlockSystem updates every Flock component at once instead of letting each one update itself.
+Once per frame it copies every agent's position, velocity and weights into contiguous arrays (structure of arrays),
+computes the separation, alignment and cohesion of the whole flock in one pass over those arrays,
+and then writes the new velocities back to each agent's Rigidbody.
+
+Reading neighbors out of flat arrays is much friendlier to the cache than following a SmartPointer
+to a GameObject and then to its Rigidbody for every neighbor of every agent.
+Flock components register themselves with the system and only act as a handle into it.
+The game loop calls Update once per frame, so a frame never depends on how many Flocks happened to update.
+
+Agent state is double buffered. Steering only reads the state gathered at the start of the frame and
+only writes the agent's own slot in the other buffer, so agents can be split across a WorkerPool
+and the result is the same no matter how many threads there are.
+*/
+
+#pragma once
+
+#include <vector>
+
+#include "FlockKernels.h"
+#include "SpatialGrid.h"
+
+// Forward Declaration
+namespace Threading
+{
+	class WorkerPool;
+}
+namespace Component
+{
+	class Flock;
+}
+
+namespace AI
+{
+	class FlockSystem
+	{
+	public:
+		// Flocks with this many agents or fewer just check every agent for neighbors instead of using the grid.
+		static const size_t BruteForceLimit = 64;
+		// How many agents a worker steers at a time.
+		static const size_t AgentsPerChunk = 256;
+
+		// The system every Flock component registers with.
+		static FlockSystem& Get();
+
+		// Adds and removes agents. Removing an agent moves the last agent into its place.
+		void Add(Component::Flock* i_pFlock);
+		void Remove(Component::Flock* i_pFlock);
+
+		// Updates every agent in the flock. The game loop calls this once per frame.
+		// Flocks can be added or removed between calls, and agents that skip their own Update are still steered.
+		void Update(float i_DeltaTime);
+
+		// How many threads steer the flock. 1 steers everything on the calling thread.
+		// Returns false and stays single threaded if the threads could not be started.
+		bool ThreadCount(size_t threadCount);
+		size_t ThreadCount() const;
+
+		// Getters
+		size_t Count() const { return m_Flocks.size(); }
+
+	private:
+		// The state of every agent at one point in time
+		struct AgentState
+		{
+			std::vector<float> positionX, positionY, positionZ;
+			std::vector<float> velocityX, velocityY, velocityZ;
+
+			void Resize(size_t count);
+		};
+
+		// Memory each worker reuses while steering
+		struct Scratch
+		{
+			std::vector<size_t> indices; // The index of each neighbor.
+			NeighborBlock neighbors; // The state of each neighbor, copied out of the read buffer.
+		};
+
+		FlockSystem();
+		~FlockSystem();
+
+		// Copies the state of every agent into the read buffer.
+		void Gather();
+		// Finds the neighbors of agent i in the read buffer and writes its new velocity to the write buffer.
+		void Steer(size_t i, Scratch& io_Scratch);
+		// Writes the new velocities back to the Rigidbodies.
+		void Scatter();
+
+		std::vector<Component::Flock*> m_Flocks; // The handle for each agent. Index i of every array below belongs to m_Flocks[i].
+
+		// Agent state. m_State[m_Read] is last frame's state and is only read while steering.
+		AgentState m_State[2];
+		size_t m_Read;
+		std::vector<unsigned char> m_Active; // Agents without a GameObject are skipped.
+
+		// Agent settings
+		std::vector<float> m_NeighborDistanceSqr;
+		std::vector<float> m_SeparationWeight;
+		std::vector<float> m_AlignmentWeight;
+		std::vector<float> m_CohesionWeight;
+		std::vector<float> m_MaxSpeedSqr;
+
+		SpatialGrid m_Grid;
+
+		Threading::WorkerPool* m_pWorkers; // NULL when single threaded.
+		std::vector<Scratch> m_Scratch; // One for each worker.
+	};
+}
@@ -0,0 +1,139 @@
+/*
+	This is the complementary cpp file for SpatialGrid.h
+*/
+
+#include "SpatialGrid.h"
+
+#include <math.h>
+
+namespace AI
+{
+	SpatialGrid::SpatialGrid() :
+		m_CellSize(1.0f),
+		m_InvCellSize(1.0f),
+		m_BucketMask(0)
+	{
+	}
+
+	inline SpatialGrid::Cell SpatialGrid::CellOf(float i_X, float i_Y, float i_Z) const
+	{
+		Cell cell;
+		cell.x = static_cast<int>(floorf(i_X * m_InvCellSize));
+		cell.y = static_cast<int>(floorf(i_Y * m_InvCellSize));
+		cell.z = static_cast<int>(floorf(i_Z * m_InvCellSize));
+		return cell;
+	}
+
+	inline size_t SpatialGrid::BucketOf(int x, int y, int z) const
+	{
+		// Large primes spread neighboring cells across the table
+		const unsigned int hash = (static_cast<unsigned int>(x) * 73856093u) ^ (static_cast<unsigned int>(y) * 19349663u) ^ (static_cast<unsigned int>(z) * 83492791u);
+		return hash & m_BucketMask;
+	}
+
+	inline float SpatialGrid::DistanceSqr(size_t i_Entry, float i_X, float i_Y, float i_Z) const
+	{
+		const float dx = m_X[i_Entry] - i_X;
+		const float dy = m_Y[i_Entry] - i_Y;
+		const float dz = m_Z[i_Entry] - i_Z;
+		return dx * dx + dy * dy + dz * dz;
+	}
+
+	void SpatialGrid::Build(const float* i_pX, const float* i_pY, const float* i_pZ, size_t i_Count, float i_CellSize)
+	{
+		m_CellSize = i_CellSize > 0.0001f ? i_CellSize : 0.0001f;
+		m_InvCellSize = 1.0f / m_CellSize;
+
+		// Use about 2 buckets per object so most buckets only hold a single cell
+		size_t bucketCount = 1;
+		while (bucketCount < i_Count * 2)
+		{
+			bucketCount <<= 1;
+		}
+		m_BucketMask = bucketCount - 1;
+
+		m_BucketStart.assign(bucketCount + 1, 0);
+		m_Indices.resize(i_Count);
+		m_Cells.resize(i_Count);
+		m_X.resize(i_Count);
+		m_Y.resize(i_Count);
+		m_Z.resize(i_Count);
+
+		// Count how many objects land in each bucket
+		std::vector<unsigned int> buckets(i_Count);
+		for (size_t i = 0; i < i_Count; i++)
+		{
+			const Cell cell = CellOf(i_pX[i], i_pY[i], i_pZ[i]);
+			buckets[i] = static_cast<unsigned int>(BucketOf(cell.x, cell.y, cell.z));
+			m_BucketStart[buckets[i] + 1]++;
+		}
+
+		// Turn the counts into the starting offset of each bucket
+		for (size_t b = 0; b < bucketCount; b++)
+		{
+			m_BucketStart[b + 1] += m_BucketStart[b];
+		}
+
+		// Place every object into its bucket
+		std::vector<unsigned int> next(m_BucketStart.begin(), m_BucketStart.end() - 1);
+		for (size_t i = 0; i < i_Count; i++)
+		{
+			const unsigned int slot = next[buckets[i]]++;
+			m_Indices[slot] = static_cast<unsigned int>(i);
+			m_Cells[slot] = CellOf(i_pX[i], i_pY[i], i_pZ[i]);
+			m_X[slot] = i_pX[i];
+			m_Y[slot] = i_pY[i];
+			m_Z[slot] = i_pZ[i];
+		}
+	}
+
+	void SpatialGrid::Query(float i_X, float i_Y, float i_Z, float i_RadiusSqr, size_t i_Ignore, std::vector<size_t>& o_Neighbors) const
+	{
+		if (m_Indices.empty() || i_RadiusSqr <= 0)
+		{
+			return;
+		}
+
+		const float radius = sqrtf(i_RadiusSqr);
+		const Cell minCell = CellOf(i_X - radius, i_Y - radius, i_Z - radius);
+		const Cell maxCell = CellOf(i_X + radius, i_Y + radius, i_Z + radius);
+
+		// If the radius covers more cells than there are buckets, looking at every object is cheaper
+		const double cellsCovered = static_cast<double>(maxCell.x - minCell.x + 1) * (maxCell.y - minCell.y + 1) * (maxCell.z - minCell.z + 1);
+		if (cellsCovered > static_cast<double>(m_BucketMask + 1))
+		{
+			for (size_t i = 0; i < m_Indices.size(); i++)
+			{
+				if (m_Indices[i] != i_Ignore && DistanceSqr(i, i_X, i_Y, i_Z) < i_RadiusSqr)
+				{
+					o_Neighbors.push_back(m_Indices[i]);
+				}
+			}
+			return;
+		}
+
+		for (int z = minCell.z; z <= maxCell.z; z++)
+		{
+			for (int y = minCell.y; y <= maxCell.y; y++)
+			{
+				for (int x = minCell.x; x <= maxCell.x; x++)
+				{
+					const size_t bucket = BucketOf(x, y, z);
+					for (unsigned int i = m_BucketStart[bucket]; i < m_BucketStart[bucket + 1]; i++)
+					{
+						// Another cell may share this bucket. Only take entries from this cell so nothing is found twice.
+						const Cell& cell = m_Cells[i];
+						if (cell.x != x || cell.y != y || cell.z != z || m_Indices[i] == i_Ignore)
+						{
+							continue;
+						}
+						if (DistanceSqr(i, i_X, i_Y, i_Z) < i_RadiusSqr)
+						{
+							o_Neighbors.push_back(m_Indices[i]);
+						}
+					}
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,51 @@
+/*
+The SpatialGrid is a uniform grid of cells used to quickly find every object within a radius of a point.
+Positions are hashed into buckets by the cell they lie in, so a radius query only looks at the few cells
+the radius overlaps instead of every object in the world.
+
+The grid is meant to be rebuilt once per frame. Building it is a counting sort, so it is linear in the number of objects.
+For the fastest queries the cell size should be about the same as the radius being searched.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace AI
+{
+	class SpatialGrid
+	{
+	public:
+		SpatialGrid();
+
+		// Rebuilds the grid from i_Count positions stored as separate x, y and z arrays. Query returns indices into these arrays.
+		void Build(const float* i_pX, const float* i_pY, const float* i_pZ, size_t i_Count, float i_CellSize);
+
+		// Adds the index of every position within the radius of the center to o_Neighbors, skipping the index i_Ignore.
+		void Query(float i_X, float i_Y, float i_Z, float i_RadiusSqr, size_t i_Ignore, std::vector<size_t>& o_Neighbors) const;
+
+		// Getters
+		float CellSize() const { return m_CellSize; }
+		size_t Count() const { return m_Indices.size(); }
+
+	private:
+		struct Cell
+		{
+			int x, y, z;
+		};
+
+		inline Cell CellOf(float i_X, float i_Y, float i_Z) const;
+		inline size_t BucketOf(int x, int y, int z) const;
+		inline float DistanceSqr(size_t i_Entry, float i_X, float i_Y, float i_Z) const;
+
+		float m_CellSize;
+		float m_InvCellSize;
+		size_t m_BucketMask; // The number of buckets is a power of 2 so we can mask instead of mod.
+
+		std::vector<unsigned int> m_BucketStart; // Where each bucket's entries begin. Has one extra entry for the end of the last bucket.
+		std::vector<unsigned int> m_Indices; // The original index of each entry, sorted by bucket.
+		std::vector<Cell> m_Cells; // The cell of each entry. Different cells can share a bucket, so we check this during a query.
+		std::vector<float> m_X, m_Y, m_Z; // The position of each entry, sorted by bucket so a query reads memory in order.
+	};
+}
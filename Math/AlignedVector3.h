@@ -0,0 +1,85 @@
+/*
+The AlignedVector3 is a Vector3 stored in a 16 byte aligned block of 4 floats, with the 4th float always 0.
+That is exactly one SSE register, so every operator is a handful of SSE instructions instead of 3 separate float operations.
+Use it for vectors that are doing a lot of math. It is 16 bytes instead of 12, so Vector3 is still better for storing lots of vectors.
+
+On CPUs without SSE it falls back to plain floats, so code using it still builds everywhere.
+*/
+
+#pragma once
+
+#include "SIMD.h"
+#include "Vector3.h"
+
+#if MATH_SIMD_X86 && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+	#define MATH_VECTOR_SSE 1
+	#include <emmintrin.h>
+#else
+	#define MATH_VECTOR_SSE 0
+#endif
+
+namespace Math {
+	class alignas(16) AlignedVector3 {
+	public:
+		//constructors
+		inline AlignedVector3();
+		inline AlignedVector3(float i_x, float i_y, float i_z);
+		inline explicit AlignedVector3(const Vector3& i_Vector);
+#if MATH_VECTOR_SSE
+		// The 4th float of the register must be 0.
+		inline explicit AlignedVector3(__m128 i_Register);
+#endif
+
+		// Converts back to a Vector3 for storage.
+		inline Vector3 ToVector3() const;
+
+		// Getters
+		inline float X() const, Y() const, Z() const, Length() const, LengthSqr() const;
+
+		//Setters
+		inline void X(const float x), Y(const float y), Z(const float z);
+
+		// Normalizers
+		inline AlignedVector3 CreateNormalized() const;
+		inline void Normalize();
+
+		// Operators
+		// Addition
+		inline AlignedVector3 operator +(const AlignedVector3& rhs) const;
+		inline AlignedVector3& operator +=(const AlignedVector3& rhs);
+
+		// Subtraction
+		inline AlignedVector3 operator -(const AlignedVector3& rhs) const;
+		inline AlignedVector3& operator -=(const AlignedVector3& rhs);
+
+		// Multiplication
+		inline AlignedVector3 operator *(const float rhs) const;
+		inline AlignedVector3& operator *=(const float rhs);
+		inline friend AlignedVector3 operator *(const float lhs, const AlignedVector3& rhs);
+
+		// Division
+		inline AlignedVector3 operator /(const float rhs) const;
+		inline AlignedVector3& operator /=(const float rhs);
+
+		// Dot product
+		inline friend float Dot(const AlignedVector3& lhs, const AlignedVector3& rhs);
+		// Cross product
+		inline friend AlignedVector3 Cross(const AlignedVector3& lhs, const AlignedVector3& rhs);
+		// Scale product
+		inline friend AlignedVector3 Scale(const AlignedVector3& lhs, const AlignedVector3& rhs);
+
+		// Interpolation
+		inline friend AlignedVector3 Lerp(const AlignedVector3& start, const AlignedVector3& end, float percent);
+
+	private:
+		//variables
+#if MATH_VECTOR_SSE
+		__m128 _v; // x, y, z, 0
+#else
+		float _v[4]; // x, y, z, 0
+#endif
+	};
+
+} //namespace Math
+
+#include "AlignedVector3.inl"
@@ -0,0 +1,274 @@
+/*
+An inline file used to define my inline functions for the AlignedVector3 class.
+Every SSE function keeps the 4th float at 0, so it never leaks into a dot product or length.
+*/
+
+#include <math.h>
+
+namespace Math
+{
+#if MATH_VECTOR_SSE
+	namespace SIMD
+	{
+		// Adds the 4 floats of v together and puts the sum in the lowest float
+		inline __m128 HorizontalSum(__m128 v)
+		{
+			const __m128 pairs = _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+			return _mm_add_ss(pairs, _mm_movehl_ps(pairs, pairs));
+		}
+	}
+
+	// Constructors
+	inline AlignedVector3::AlignedVector3() :
+		_v(_mm_setzero_ps())
+	{
+	}
+	inline AlignedVector3::AlignedVector3(float x, float y, float z) :
+		_v(_mm_set_ps(0, z, y, x))
+	{
+	}
+	inline AlignedVector3::AlignedVector3(const Vector3& i_Vector) :
+		_v(_mm_set_ps(0, i_Vector.Z(), i_Vector.Y(), i_Vector.X()))
+	{
+	}
+	inline AlignedVector3::AlignedVector3(__m128 i_Register) :
+		_v(i_Register)
+	{
+	}
+
+	inline Vector3 AlignedVector3::ToVector3() const
+	{
+		alignas(16) float values[4];
+		_mm_store_ps(values, _v);
+		return Vector3(values[0], values[1], values[2]);
+	}
+
+	// Getters
+	inline float AlignedVector3::X() const { return _mm_cvtss_f32(_v); }
+	inline float AlignedVector3::Y() const { return _mm_cvtss_f32(_mm_shuffle_ps(_v, _v, _MM_SHUFFLE(1, 1, 1, 1))); }
+	inline float AlignedVector3::Z() const { return _mm_cvtss_f32(_mm_movehl_ps(_v, _v)); }
+	inline float AlignedVector3::Length() const
+	{
+		return _mm_cvtss_f32(_mm_sqrt_ss(SIMD::HorizontalSum(_mm_mul_ps(_v, _v))));
+	}
+	inline float AlignedVector3::LengthSqr() const
+	{
+		return _mm_cvtss_f32(SIMD::HorizontalSum(_mm_mul_ps(_v, _v)));
+	}
+
+	//Setters
+	inline void AlignedVector3::X(const float x) { *this = AlignedVector3(x, Y(), Z()); }
+	inline void AlignedVector3::Y(const float y) { *this = AlignedVector3(X(), y, Z()); }
+	inline void AlignedVector3::Z(const float z) { *this = AlignedVector3(X(), Y(), z); }
+
+	// Normalizers
+	inline AlignedVector3 AlignedVector3::CreateNormalized() const
+	{
+		// Divide every lane by the length at once instead of working out the length as a float first
+		const __m128 lengthSqr = SIMD::HorizontalSum(_mm_mul_ps(_v, _v));
+		const __m128 length = _mm_sqrt_ss(lengthSqr);
+		return AlignedVector3(_mm_div_ps(_v, _mm_shuffle_ps(length, length, _MM_SHUFFLE(0, 0, 0, 0))));
+	}
+	inline void AlignedVector3::Normalize()
+	{
+		*this = CreateNormalized();
+	}
+
+	// Operators
+	// Addition
+	inline AlignedVector3 AlignedVector3::operator +(const AlignedVector3& rhs) const
+	{
+		return AlignedVector3(_mm_add_ps(_v, rhs._v));
+	}
+	inline AlignedVector3& AlignedVector3::operator +=(const AlignedVector3& rhs)
+	{
+		_v = _mm_add_ps(_v, rhs._v);
+		return *this;
+	}
+
+	// Subtraction
+	inline AlignedVector3 AlignedVector3::operator -(const AlignedVector3& rhs) const
+	{
+		return AlignedVector3(_mm_sub_ps(_v, rhs._v));
+	}
+	inline AlignedVector3& AlignedVector3::operator -=(const AlignedVector3& rhs)
+	{
+		_v = _mm_sub_ps(_v, rhs._v);
+		return *this;
+	}
+
+	// Multiplication
+	inline AlignedVector3 AlignedVector3::operator *(const float rhs) const
+	{
+		return AlignedVector3(_mm_mul_ps(_v, _mm_set1_ps(rhs)));
+	}
+	inline AlignedVector3& AlignedVector3::operator *=(const float rhs)
+	{
+		_v = _mm_mul_ps(_v, _mm_set1_ps(rhs));
+		return *this;
+	}
+	inline AlignedVector3 operator *(const float lhs, const AlignedVector3& rhs)
+	{
+		return rhs * lhs;
+	}
+
+	// Division
+	inline AlignedVector3 AlignedVector3::operator /(const float rhs) const
+	{
+		return *this * (1.0f / rhs);
+	}
+	inline AlignedVector3& AlignedVector3::operator /=(const float rhs)
+	{
+		return *this *= (1.0f / rhs);
+	}
+
+	// Dot product
+	inline float Dot(const AlignedVector3& lhs, const AlignedVector3& rhs)
+	{
+		return _mm_cvtss_f32(SIMD::HorizontalSum(_mm_mul_ps(lhs._v, rhs._v)));
+	}
+	// Cross product
+	inline AlignedVector3 Cross(const AlignedVector3& lhs, const AlignedVector3& rhs)
+	{
+		// lhs.yzx * rhs.zxy - lhs.zxy * rhs.yzx, done as one subtract and one final shuffle
+		const __m128 lhsYZX = _mm_shuffle_ps(lhs._v, lhs._v, _MM_SHUFFLE(3, 0, 2, 1));
+		const __m128 rhsYZX = _mm_shuffle_ps(rhs._v, rhs._v, _MM_SHUFFLE(3, 0, 2, 1));
+		const __m128 result = _mm_sub_ps(_mm_mul_ps(lhs._v, rhsYZX), _mm_mul_ps(lhsYZX, rhs._v));
+		return AlignedVector3(_mm_shuffle_ps(result, result, _MM_SHUFFLE(3, 0, 2, 1)));
+	}
+	// Scale product
+	inline AlignedVector3 Scale(const AlignedVector3& lhs, const AlignedVector3& rhs)
+	{
+		return AlignedVector3(_mm_mul_ps(lhs._v, rhs._v));
+	}
+
+	// Interpolation
+	inline AlignedVector3 Lerp(const AlignedVector3& start, const AlignedVector3& end, float percent)
+	{
+		return AlignedVector3(_mm_add_ps(start._v, _mm_mul_ps(_mm_set1_ps(percent), _mm_sub_ps(end._v, start._v))));
+	}
+
+#else
+	// Constructors
+	inline AlignedVector3::AlignedVector3()
+	{
+		_v[0] = _v[1] = _v[2] = _v[3] = 0;
+	}
+	inline AlignedVector3::AlignedVector3(float x, float y, float z)
+	{
+		_v[0] = x;
+		_v[1] = y;
+		_v[2] = z;
+		_v[3] = 0;
+	}
+	inline AlignedVector3::AlignedVector3(const Vector3& i_Vector)
+	{
+		_v[0] = i_Vector.X();
+		_v[1] = i_Vector.Y();
+		_v[2] = i_Vector.Z();
+		_v[3] = 0;
+	}
+
+	inline Vector3 AlignedVector3::ToVector3() const
+	{
+		return Vector3(_v[0], _v[1], _v[2]);
+	}
+
+	// Getters
+	inline float AlignedVector3::X() const { return _v[0]; }
+	inline float AlignedVector3::Y() const { return _v[1]; }
+	inline float AlignedVector3::Z() const { return _v[2]; }
+	inline float AlignedVector3::Length() const
+	{
+		return sqrtf(LengthSqr());
+	}
+	inline float AlignedVector3::LengthSqr() const
+	{
+		return (_v[0] * _v[0]) + (_v[1] * _v[1]) + (_v[2] * _v[2]);
+	}
+
+	//Setters
+	inline void AlignedVector3::X(const float x) { _v[0] = x; }
+	inline void AlignedVector3::Y(const float y) { _v[1] = y; }
+	inline void AlignedVector3::Z(const float z) { _v[2] = z; }
+
+	// Normalizers
+	inline AlignedVector3 AlignedVector3::CreateNormalized() const
+	{
+		return *this / Length();
+	}
+	inline void AlignedVector3::Normalize()
+	{
+		*this /= Length();
+	}
+
+	// Operators
+	// Addition
+	inline AlignedVector3 AlignedVector3::operator +(const AlignedVector3& rhs) const
+	{
+		return AlignedVector3(_v[0] + rhs._v[0], _v[1] + rhs._v[1], _v[2] + rhs._v[2]);
+	}
+	inline AlignedVector3& AlignedVector3::operator +=(const AlignedVector3& rhs)
+	{
+		return *this = *this + rhs;
+	}
+
+	// Subtraction
+	inline AlignedVector3 AlignedVector3::operator -(const AlignedVector3& rhs) const
+	{
+		return AlignedVector3(_v[0] - rhs._v[0], _v[1] - rhs._v[1], _v[2] - rhs._v[2]);
+	}
+	inline AlignedVector3& AlignedVector3::operator -=(const AlignedVector3& rhs)
+	{
+		return *this = *this - rhs;
+	}
+
+	// Multiplication
+	inline AlignedVector3 AlignedVector3::operator *(const float rhs) const
+	{
+		return AlignedVector3(_v[0] * rhs, _v[1] * rhs, _v[2] * rhs);
+	}
+	inline AlignedVector3& AlignedVector3::operator *=(const float rhs)
+	{
+		return *this = *this * rhs;
+	}
+	inline AlignedVector3 operator *(const float lhs, const AlignedVector3& rhs)
+	{
+		return rhs * lhs;
+	}
+
+	// Division
+	inline AlignedVector3 AlignedVector3::operator /(const float rhs) const
+	{
+		return *this * (1.0f / rhs);
+	}
+	inline AlignedVector3& AlignedVector3::operator /=(const float rhs)
+	{
+		return *this *= (1.0f / rhs);
+	}
+
+	// Dot product
+	inline float Dot(const AlignedVector3& lhs, const AlignedVector3& rhs)
+	{
+		return (lhs._v[0] * rhs._v[0]) + (lhs._v[1] * rhs._v[1]) + (lhs._v[2] * rhs._v[2]);
+	}
+	// Cross product
+	inline AlignedVector3 Cross(const AlignedVector3& lhs, const AlignedVector3& rhs)
+	{
+		return AlignedVector3((lhs._v[1] * rhs._v[2]) - (lhs._v[2] * rhs._v[1]),
+			(lhs._v[2] * rhs._v[0]) - (lhs._v[0] * rhs._v[2]),
+			(lhs._v[0] * rhs._v[1]) - (lhs._v[1] * rhs._v[0]));
+	}
+	// Scale product
+	inline AlignedVector3 Scale(const AlignedVector3& lhs, const AlignedVector3& rhs)
+	{
+		return AlignedVector3(lhs._v[0] * rhs._v[0], lhs._v[1] * rhs._v[1], lhs._v[2] * rhs._v[2]);
+	}
+
+	// Interpolation
+	inline AlignedVector3 Lerp(const AlignedVector3& start, const AlignedVector3& end, float percent)
+	{
+		return start + (end - start) * percent;
+	}
+#endif
+}
@@ -0,0 +1,493 @@
+/*
+This source file contains the definitions for the functions declared in Batch.h
+The scalar versions read AoS and SoA the same way, with a stride of 3 floats for AoS and 1 for SoA.
+The AVX2 and AVX-512 versions do 8 or 16 vectors at a time and finish off the last few with the scalar versions.
+For AoS, the AVX2 versions gather every third float to get the x, y and z of 8 vectors.
+Lerp and Scale don't mix x, y and z, so for AoS they just treat the array as one long array of floats.
+*/
+
+#include "Batch.h"
+
+#include <math.h>
+#include "SIMD.h"
+#include "Vector3.h"
+
+#if MATH_SIMD_X86
+	#include <immintrin.h>
+#endif
+
+namespace Math
+{
+	namespace Batch
+	{
+		static_assert(sizeof(Vector3) == 3 * sizeof(float), "The AoS functions read a Vector3 as 3 floats");
+
+		// Vectors read from either layout. stride is how many floats apart one vector's x is from the next.
+		struct Strided
+		{
+			const float* x;
+			const float* y;
+			const float* z;
+			size_t stride;
+		};
+		struct StridedOut
+		{
+			float* x;
+			float* y;
+			float* z;
+			size_t stride;
+		};
+
+		static inline Strided FromAoS(const float* i_pFloats) { Strided s = { i_pFloats, i_pFloats + 1, i_pFloats + 2, 3 }; return s; }
+		static inline StridedOut FromAoS(float* i_pFloats) { StridedOut s = { i_pFloats, i_pFloats + 1, i_pFloats + 2, 3 }; return s; }
+		static inline Strided FromSoA(const ConstVector3SoA& i_Vectors) { Strided s = { i_Vectors.x, i_Vectors.y, i_Vectors.z, 1 }; return s; }
+		static inline StridedOut FromSoA(const Vector3SoA& i_Vectors) { StridedOut s = { i_Vectors.x, i_Vectors.y, i_Vectors.z, 1 }; return s; }
+
+		/******     Scalar     ******/
+		static void DotRange(const Strided& a, const Strided& b, float* o_Dots, size_t i_Begin, size_t i_End)
+		{
+			for (size_t i = i_Begin; i < i_End; i++)
+			{
+				const size_t ia = i * a.stride, ib = i * b.stride;
+				o_Dots[i] = (a.x[ia] * b.x[ib]) + (a.y[ia] * b.y[ib]) + (a.z[ia] * b.z[ib]);
+			}
+		}
+
+		static void CrossRange(const Strided& a, const Strided& b, const StridedOut& o, size_t i_Begin, size_t i_End)
+		{
+			for (size_t i = i_Begin; i < i_End; i++)
+			{
+				const size_t ia = i * a.stride, ib = i * b.stride, io = i * o.stride;
+				const float x = (a.y[ia] * b.z[ib]) - (a.z[ia] * b.y[ib]);
+				const float y = (a.z[ia] * b.x[ib]) - (a.x[ia] * b.z[ib]);
+				const float z = (a.x[ia] * b.y[ib]) - (a.y[ia] * b.x[ib]);
+				o.x[io] = x;
+				o.y[io] = y;
+				o.z[io] = z;
+			}
+		}
+
+		static void LengthRange(const Strided& a, float* o_Lengths, size_t i_Begin, size_t i_End)
+		{
+			for (size_t i = i_Begin; i < i_End; i++)
+			{
+				const size_t ia = i * a.stride;
+				o_Lengths[i] = sqrtf((a.x[ia] * a.x[ia]) + (a.y[ia] * a.y[ia]) + (a.z[ia] * a.z[ia]));
+			}
+		}
+
+		static void NormalizeRange(const StridedOut& io, size_t i_Begin, size_t i_End)
+		{
+			for (size_t i = i_Begin; i < i_End; i++)
+			{
+				const size_t ia = i * io.stride;
+				const float lengthSqr = (io.x[ia] * io.x[ia]) + (io.y[ia] * io.y[ia]) + (io.z[ia] * io.z[ia]);
+				if (lengthSqr > 0)
+				{
+					const float recip = 1.0f / sqrtf(lengthSqr);
+					io.x[ia] *= recip;
+					io.y[ia] *= recip;
+					io.z[ia] *= recip;
+				}
+			}
+		}
+
+		static void LerpFloatsRange(const float* i_pStart, const float* i_pEnd, float i_Percent, float* o_pLerped, size_t i_Begin, size_t i_End)
+		{
+			for (size_t i = i_Begin; i < i_End; i++)
+			{
+				o_pLerped[i] = i_pStart[i] + i_Percent * (i_pEnd[i] - i_pStart[i]);
+			}
+		}
+
+		static void MultiplyFloatsRange(const float* i_pLhs, const float* i_pRhs, float* o_pProduct, size_t i_Begin, size_t i_End)
+		{
+			for (size_t i = i_Begin; i < i_End; i++)
+			{
+				o_pProduct[i] = i_pLhs[i] * i_pRhs[i];
+			}
+		}
+
+		// Every kernel, in the form the dispatch table stores them
+		static void DotAoSScalar(const float* a, const float* b, float* o, size_t n) { DotRange(FromAoS(a), FromAoS(b), o, 0, n); }
+		static void CrossAoSScalar(const float* a, const float* b, float* o, size_t n) { CrossRange(FromAoS(a), FromAoS(b), FromAoS(o), 0, n); }
+		static void LengthAoSScalar(const float* a, float* o, size_t n) { LengthRange(FromAoS(a), o, 0, n); }
+		static void NormalizeAoSScalar(float* io, size_t n) { NormalizeRange(FromAoS(io), 0, n); }
+		static void DotSoAScalar(const ConstVector3SoA& a, const ConstVector3SoA& b, float* o) { DotRange(FromSoA(a), FromSoA(b), o, 0, a.count); }
+		static void CrossSoAScalar(const ConstVector3SoA& a, const ConstVector3SoA& b, const Vector3SoA& o) { CrossRange(FromSoA(a), FromSoA(b), FromSoA(o), 0, a.count); }
+		static void LengthSoAScalar(const ConstVector3SoA& a, float* o) { LengthRange(FromSoA(a), o, 0, a.count); }
+		static void NormalizeSoAScalar(const Vector3SoA& io) { NormalizeRange(FromSoA(io), 0, io.count); }
+		static void LerpFloatsScalar(const float* a, const float* b, float t, float* o, size_t n) { LerpFloatsRange(a, b, t, o, 0, n); }
+		static void MultiplyFloatsScalar(const float* a, const float* b, float* o, size_t n) { MultiplyFloatsRange(a, b, o, 0, n); }
+
+#if MATH_SIMD_X86
+		/******      AVX2      ******/
+		// The offset of the x of each of 8 AoS vectors, in floats
+		MATH_TARGET_AVX2 static inline __m256i AoSOffsets()
+		{
+			return _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+		}
+
+		// Reads the x, y and z of 8 AoS vectors starting at i_pFloats
+		MATH_TARGET_AVX2 static inline void GatherAoS(const float* i_pFloats, __m256& o_X, __m256& o_Y, __m256& o_Z)
+		{
+			const __m256i offsets = AoSOffsets();
+			o_X = _mm256_i32gather_ps(i_pFloats, offsets, 4);
+			o_Y = _mm256_i32gather_ps(i_pFloats + 1, offsets, 4);
+			o_Z = _mm256_i32gather_ps(i_pFloats + 2, offsets, 4);
+		}
+
+		MATH_TARGET_AVX2 static inline __m256 Dot8(__m256 ax, __m256 ay, __m256 az, __m256 bx, __m256 by, __m256 bz)
+		{
+			return _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ax, bx), _mm256_mul_ps(ay, by)), _mm256_mul_ps(az, bz));
+		}
+
+		// 1 / length, or 1 for vectors with a length of 0 so they are left alone
+		MATH_TARGET_AVX2 static inline __m256 RecipLength8(__m256 i_LengthSqr)
+		{
+			const __m256 one = _mm256_set1_ps(1.0f);
+			const __m256 recip = _mm256_div_ps(one, _mm256_sqrt_ps(i_LengthSqr));
+			return _mm256_blendv_ps(one, recip, _mm256_cmp_ps(i_LengthSqr, _mm256_setzero_ps(), _CMP_GT_OQ));
+		}
+
+		MATH_TARGET_AVX2 static void DotAoSAVX2(const float* a, const float* b, float* o, size_t n)
+		{
+			const size_t count = n & ~static_cast<size_t>(7);
+			for (size_t i = 0; i < count; i += 8)
+			{
+				__m256 ax, ay, az, bx, by, bz;
+				GatherAoS(a + i * 3, ax, ay, az);
+				GatherAoS(b + i * 3, bx, by, bz);
+				_mm256_storeu_ps(o + i, Dot8(ax, ay, az, bx, by, bz));
+			}
+			DotRange(FromAoS(a), FromAoS(b), o, count, n);
+		}
+
+		MATH_TARGET_AVX2 static void CrossAoSAVX2(const float* a, const float* b, float* o, size_t n)
+		{
+			const size_t count = n & ~static_cast<size_t>(7);
+			for (size_t i = 0; i < count; i += 8)
+			{
+				__m256 ax, ay, az, bx, by, bz;
+				GatherAoS(a + i * 3, ax, ay, az);
+				GatherAoS(b + i * 3, bx, by, bz);
+
+				alignas(32) float x[8], y[8], z[8];
+				_mm256_store_ps(x, _mm256_sub_ps(_mm256_mul_ps(ay, bz), _mm256_mul_ps(az, by)));
+				_mm256_store_ps(y, _mm256_sub_ps(_mm256_mul_ps(az, bx), _mm256_mul_ps(ax, bz)));
+				_mm256_store_ps(z, _mm256_sub_ps(_mm256_mul_ps(ax, by), _mm256_mul_ps(ay, bx)));
+
+				// AVX2 has no scatter, so write the results back out one vector at a time
+				float* pOut = o + i * 3;
+				for (size_t lane = 0; lane < 8; lane++)
+				{
+					pOut[lane * 3] = x[lane];
+					pOut[lane * 3 + 1] = y[lane];
+					pOut[lane * 3 + 2] = z[lane];
+				}
+			}
+			CrossRange(FromAoS(a), FromAoS(b), FromAoS(o), count, n);
+		}
+
+		MATH_TARGET_AVX2 static void LengthAoSAVX2(const float* a, float* o, size_t n)
+		{
+			const size_t count = n & ~static_cast<size_t>(7);
+			for (size_t i = 0; i < count; i += 8)
+			{
+				__m256 x, y, z;
+				GatherAoS(a + i * 3, x, y, z);
+				_mm256_storeu_ps(o + i, _mm256_sqrt_ps(Dot8(x, y, z, x, y, z)));
+			}
+			LengthRange(FromAoS(a), o, count, n);
+		}
+
+		MATH_TARGET_AVX2 static void NormalizeAoSAVX2(float* io, size_t n)
+		{
+			// Which vector each of 24 floats belongs to, split over 3 registers
+			const __m256i spread0 = _mm256_setr_epi32(0, 0, 0, 1, 1, 1, 2, 2);
+			const __m256i spread1 = _mm256_setr_epi32(2, 3, 3, 3, 4, 4, 4, 5);
+			const __m256i spread2 = _mm256_setr_epi32(5, 5, 6, 6, 6, 7, 7, 7);
+
+			const size_t count = n & ~static_cast<size_t>(7);
+			for (size_t i = 0; i < count; i += 8)
+			{
+				float* pFloats = io + i * 3;
+				__m256 x, y, z;
+				GatherAoS(pFloats, x, y, z);
+				const __m256 recip = RecipLength8(Dot8(x, y, z, x, y, z));
+
+				// Spread each vector's 1 / length over its 3 floats and scale the floats where they are
+				_mm256_storeu_ps(pFloats, _mm256_mul_ps(_mm256_loadu_ps(pFloats), _mm256_permutevar8x32_ps(recip, spread0)));
+				_mm256_storeu_ps(pFloats + 8, _mm256_mul_ps(_mm256_loadu_ps(pFloats + 8), _mm256_permutevar8x32_ps(recip, spread1)));
+				_mm256_storeu_ps(pFloats + 16, _mm256_mul_ps(_mm256_loadu_ps(pFloats + 16), _mm256_permutevar8x32_ps(recip, spread2)));
+			}
+			NormalizeRange(FromAoS(io), count, n);
+		}
+
+		MATH_TARGET_AVX2 static void DotSoAAVX2(const ConstVector3SoA& a, const ConstVector3SoA& b, float* o)
+		{
+			const size_t count = a.count & ~static_cast<size_t>(7);
+			for (size_t i = 0; i < count; i += 8)
+			{
+				_mm256_storeu_ps(o + i, Dot8(_mm256_loadu_ps(a.x + i), _mm256_loadu_ps(a.y + i), _mm256_loadu_ps(a.z + i),
+					_mm256_loadu_ps(b.x + i), _mm256_loadu_ps(b.y + i), _mm256_loadu_ps(b.z + i)));
+			}
+			DotRange(FromSoA(a), FromSoA(b), o, count, a.count);
+		}
+
+		MATH_TARGET_AVX2 static void CrossSoAAVX2(const ConstVector3SoA& a, const ConstVector3SoA& b, const Vector3SoA& o)
+		{
+			const size_t count = a.count & ~static_cast<size_t>(7);
+			for (size_t i = 0; i < count; i += 8)
+			{
+				const __m256 ax = _mm256_loadu_ps(a.x + i), ay = _mm256_loadu_ps(a.y + i), az = _mm256_loadu_ps(a.z + i);
+				const __m256 bx = _mm256_loadu_ps(b.x + i), by = _mm256_loadu_ps(b.y + i), bz = _mm256_loadu_ps(b.z + i);
+				_mm256_storeu_ps(o.x + i, _mm256_sub_ps(_mm256_mul_ps(ay, bz), _mm256_mul_ps(az, by)));
+				_mm256_storeu_ps(o.y + i, _mm256_sub_ps(_mm256_mul_ps(az, bx), _mm256_mul_ps(ax, bz)));
+				_mm256_storeu_ps(o.z + i, _mm256_sub_ps(_mm256_mul_ps(ax, by), _mm256_mul_ps(ay, bx)));
+			}
+			CrossRange(FromSoA(a), FromSoA(b), FromSoA(o), count, a.count);
+		}
+
+		MATH_TARGET_AVX2 static void LengthSoAAVX2(const ConstVector3SoA& a, float* o)
+		{
+			const size_t count = a.count & ~static_cast<size_t>(7);
+			for (size_t i = 0; i < count; i += 8)
+			{
+				const __m256 x = _mm256_loadu_ps(a.x + i), y = _mm256_loadu_ps(a.y + i), z = _mm256_loadu_ps(a.z + i);
+				_mm256_storeu_ps(o + i, _mm256_sqrt_ps(Dot8(x, y, z, x, y, z)));
+			}
+			LengthRange(FromSoA(a), o, count, a.count);
+		}
+
+		MATH_TARGET_AVX2 static void NormalizeSoAAVX2(const Vector3SoA& io)
+		{
+			const size_t count = io.count & ~static_cast<size_t>(7);
+			for (size_t i = 0; i < count; i += 8)
+			{
+				const __m256 x = _mm256_loadu_ps(io.x + i), y = _mm256_loadu_ps(io.y + i), z = _mm256_loadu_ps(io.z + i);
+				const __m256 recip = RecipLength8(Dot8(x, y, z, x, y, z));
+				_mm256_storeu_ps(io.x + i, _mm256_mul_ps(x, recip));
+				_mm256_storeu_ps(io.y + i, _mm256_mul_ps(y, recip));
+				_mm256_storeu_ps(io.z + i, _mm256_mul_ps(z, recip));
+			}
+			NormalizeRange(FromSoA(io), count, io.count);
+		}
+
+		MATH_TARGET_AVX2 static void LerpFloatsAVX2(const float* a, const float* b, float t, float* o, size_t n)
+		{
+			const __m256 percent = _mm256_set1_ps(t);
+			const size_t count = n & ~static_cast<size_t>(7);
+			for (size_t i = 0; i < count; i += 8)
+			{
+				const __m256 start = _mm256_loadu_ps(a + i);
+				_mm256_storeu_ps(o + i, _mm256_add_ps(start, _mm256_mul_ps(percent, _mm256_sub_ps(_mm256_loadu_ps(b + i), start))));
+			}
+			LerpFloatsRange(a, b, t, o, count, n);
+		}
+
+		MATH_TARGET_AVX2 static void MultiplyFloatsAVX2(const float* a, const float* b, float* o, size_t n)
+		{
+			const size_t count = n & ~static_cast<size_t>(7);
+			for (size_t i = 0; i < count; i += 8)
+			{
+				_mm256_storeu_ps(o + i, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+			}
+			MultiplyFloatsRange(a, b, o, count, n);
+		}
+
+		/******    AVX-512     ******/
+		MATH_TARGET_AVX512 static inline __m512 Dot16(__m512 ax, __m512 ay, __m512 az, __m512 bx, __m512 by, __m512 bz)
+		{
+			return _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(ax, bx), _mm512_mul_ps(ay, by)), _mm512_mul_ps(az, bz));
+		}
+
+		MATH_TARGET_AVX512 static void DotSoAAVX512(const ConstVector3SoA& a, const ConstVector3SoA& b, float* o)
+		{
+			const size_t count = a.count & ~static_cast<size_t>(15);
+			for (size_t i = 0; i < count; i += 16)
+			{
+				_mm512_storeu_ps(o + i, Dot16(_mm512_loadu_ps(a.x + i), _mm512_loadu_ps(a.y + i), _mm512_loadu_ps(a.z + i),
+					_mm512_loadu_ps(b.x + i), _mm512_loadu_ps(b.y + i), _mm512_loadu_ps(b.z + i)));
+			}
+			DotRange(FromSoA(a), FromSoA(b), o, count, a.count);
+		}
+
+		MATH_TARGET_AVX512 static void CrossSoAAVX512(const ConstVector3SoA& a, const ConstVector3SoA& b, const Vector3SoA& o)
+		{
+			const size_t count = a.count & ~static_cast<size_t>(15);
+			for (size_t i = 0; i < count; i += 16)
+			{
+				const __m512 ax = _mm512_loadu_ps(a.x + i), ay = _mm512_loadu_ps(a.y + i), az = _mm512_loadu_ps(a.z + i);
+				const __m512 bx = _mm512_loadu_ps(b.x + i), by = _mm512_loadu_ps(b.y + i), bz = _mm512_loadu_ps(b.z + i);
+				_mm512_storeu_ps(o.x + i, _mm512_sub_ps(_mm512_mul_ps(ay, bz), _mm512_mul_ps(az, by)));
+				_mm512_storeu_ps(o.y + i, _mm512_sub_ps(_mm512_mul_ps(az, bx), _mm512_mul_ps(ax, bz)));
+				_mm512_storeu_ps(o.z + i, _mm512_sub_ps(_mm512_mul_ps(ax, by), _mm512_mul_ps(ay, bx)));
+			}
+			CrossRange(FromSoA(a), FromSoA(b), FromSoA(o), count, a.count);
+		}
+
+		MATH_TARGET_AVX512 static void LengthSoAAVX512(const ConstVector3SoA& a, float* o)
+		{
+			const size_t count = a.count & ~static_cast<size_t>(15);
+			for (size_t i = 0; i < count; i += 16)
+			{
+				const __m512 x = _mm512_loadu_ps(a.x + i), y = _mm512_loadu_ps(a.y + i), z = _mm512_loadu_ps(a.z + i);
+				// The same as _mm512_sqrt_ps, which GCC 12 wrongly warns reads an uninitialized value from inside its header
+				_mm512_storeu_ps(o + i, _mm512_maskz_sqrt_ps(0xFFFF, Dot16(x, y, z, x, y, z)));
+			}
+			LengthRange(FromSoA(a), o, count, a.count);
+		}
+
+		MATH_TARGET_AVX512 static void NormalizeSoAAVX512(const Vector3SoA& io)
+		{
+			const __m512 one = _mm512_set1_ps(1.0f);
+			const size_t count = io.count & ~static_cast<size_t>(15);
+			for (size_t i = 0; i < count; i += 16)
+			{
+				const __m512 x = _mm512_loadu_ps(io.x + i), y = _mm512_loadu_ps(io.y + i), z = _mm512_loadu_ps(io.z + i);
+				const __m512 lengthSqr = Dot16(x, y, z, x, y, z);
+
+				// Only divide the lanes with a length, the rest keep a scale of 1
+				const __mmask16 hasLength = _mm512_cmp_ps_mask(lengthSqr, _mm512_setzero_ps(), _CMP_GT_OQ);
+				const __m512 recip = _mm512_mask_div_ps(one, hasLength, one, _mm512_maskz_sqrt_ps(0xFFFF, lengthSqr));
+				_mm512_storeu_ps(io.x + i, _mm512_mul_ps(x, recip));
+				_mm512_storeu_ps(io.y + i, _mm512_mul_ps(y, recip));
+				_mm512_storeu_ps(io.z + i, _mm512_mul_ps(z, recip));
+			}
+			NormalizeRange(FromSoA(io), count, io.count);
+		}
+
+		MATH_TARGET_AVX512 static void LerpFloatsAVX512(const float* a, const float* b, float t, float* o, size_t n)
+		{
+			const __m512 percent = _mm512_set1_ps(t);
+			const size_t count = n & ~static_cast<size_t>(15);
+			for (size_t i = 0; i < count; i += 16)
+			{
+				const __m512 start = _mm512_loadu_ps(a + i);
+				_mm512_storeu_ps(o + i, _mm512_add_ps(start, _mm512_mul_ps(percent, _mm512_sub_ps(_mm512_loadu_ps(b + i), start))));
+			}
+			LerpFloatsRange(a, b, t, o, count, n);
+		}
+
+		MATH_TARGET_AVX512 static void MultiplyFloatsAVX512(const float* a, const float* b, float* o, size_t n)
+		{
+			const size_t count = n & ~static_cast<size_t>(15);
+			for (size_t i = 0; i < count; i += 16)
+			{
+				_mm512_storeu_ps(o + i, _mm512_mul_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i)));
+			}
+			MultiplyFloatsRange(a, b, o, count, n);
+		}
+#endif
+
+		/******    Dispatch    ******/
+		// The best version of every kernel for this CPU
+		struct Kernels
+		{
+			void (*dotAoS)(const float*, const float*, float*, size_t);
+			void (*crossAoS)(const float*, const float*, float*, size_t);
+			void (*lengthAoS)(const float*, float*, size_t);
+			void (*normalizeAoS)(float*, size_t);
+			void (*dotSoA)(const ConstVector3SoA&, const ConstVector3SoA&, float*);
+			void (*crossSoA)(const ConstVector3SoA&, const ConstVector3SoA&, const Vector3SoA&);
+			void (*lengthSoA)(const ConstVector3SoA&, float*);
+			void (*normalizeSoA)(const Vector3SoA&);
+			void (*lerpFloats)(const float*, const float*, float, float*, size_t);
+			void (*multiplyFloats)(const float*, const float*, float*, size_t);
+		};
+
+		static Kernels PickKernels()
+		{
+			Kernels kernels = { DotAoSScalar, CrossAoSScalar, LengthAoSScalar, NormalizeAoSScalar,
+				DotSoAScalar, CrossSoAScalar, LengthSoAScalar, NormalizeSoAScalar, LerpFloatsScalar, MultiplyFloatsScalar };
+
+#if MATH_SIMD_X86
+			const SIMD::Level level = SIMD::Supported();
+			if (level >= SIMD::AVX2)
+			{
+				Kernels avx2 = { DotAoSAVX2, CrossAoSAVX2, LengthAoSAVX2, NormalizeAoSAVX2,
+					DotSoAAVX2, CrossSoAAVX2, LengthSoAAVX2, NormalizeSoAAVX2, LerpFloatsAVX2, MultiplyFloatsAVX2 };
+				kernels = avx2;
+			}
+			if (level >= SIMD::AVX512)
+			{
+				kernels.dotSoA = DotSoAAVX512;
+				kernels.crossSoA = CrossSoAAVX512;
+				kernels.lengthSoA = LengthSoAAVX512;
+				kernels.normalizeSoA = NormalizeSoAAVX512;
+				kernels.lerpFloats = LerpFloatsAVX512;
+				kernels.multiplyFloats = MultiplyFloatsAVX512;
+			}
+#endif
+			return kernels;
+		}
+
+		static const Kernels& Get()
+		{
+			static const Kernels s_Kernels = PickKernels();
+			return s_Kernels;
+		}
+
+		static inline const float* Floats(const Vector3* i_pVectors) { return reinterpret_cast<const float*>(i_pVectors); }
+		static inline float* Floats(Vector3* i_pVectors) { return reinterpret_cast<float*>(i_pVectors); }
+
+		/****** Array of Structures ******/
+		void Dot(const Vector3* lhs, const Vector3* rhs, float* o_Dots, size_t count)
+		{
+			Get().dotAoS(Floats(lhs), Floats(rhs), o_Dots, count);
+		}
+		void Cross(const Vector3* lhs, const Vector3* rhs, Vector3* o_Cross, size_t count)
+		{
+			Get().crossAoS(Floats(lhs), Floats(rhs), Floats(o_Cross), count);
+		}
+		void Scale(const Vector3* lhs, const Vector3* rhs, Vector3* o_Scaled, size_t count)
+		{
+			Get().multiplyFloats(Floats(lhs), Floats(rhs), Floats(o_Scaled), count * 3);
+		}
+		void Length(const Vector3* vectors, float* o_Lengths, size_t count)
+		{
+			Get().lengthAoS(Floats(vectors), o_Lengths, count);
+		}
+		void Normalize(Vector3* io_Vectors, size_t count)
+		{
+			Get().normalizeAoS(Floats(io_Vectors), count);
+		}
+		void Lerp(const Vector3* start, const Vector3* end, float percent, Vector3* o_Lerped, size_t count)
+		{
+			Get().lerpFloats(Floats(start), Floats(end), percent, Floats(o_Lerped), count * 3);
+		}
+
+		/****** Structure of Arrays ******/
+		void Dot(const ConstVector3SoA& lhs, const ConstVector3SoA& rhs, float* o_Dots)
+		{
+			Get().dotSoA(lhs, rhs, o_Dots);
+		}
+		void Cross(const ConstVector3SoA& lhs, const ConstVector3SoA& rhs, const Vector3SoA& o_Cross)
+		{
+			Get().crossSoA(lhs, rhs, o_Cross);
+		}
+		void Scale(const ConstVector3SoA& lhs, const ConstVector3SoA& rhs, const Vector3SoA& o_Scaled)
+		{
+			const Kernels& kernels = Get();
+			kernels.multiplyFloats(lhs.x, rhs.x, o_Scaled.x, lhs.count);
+			kernels.multiplyFloats(lhs.y, rhs.y, o_Scaled.y, lhs.count);
+			kernels.multiplyFloats(lhs.z, rhs.z, o_Scaled.z, lhs.count);
+		}
+		void Length(const ConstVector3SoA& vectors, float* o_Lengths)
+		{
+			Get().lengthSoA(vectors, o_Lengths);
+		}
+		void Normalize(const Vector3SoA& io_Vectors)
+		{
+			Get().normalizeSoA(io_Vectors);
+		}
+		void Lerp(const ConstVector3SoA& start, const ConstVector3SoA& end, float percent, const Vector3SoA& o_Lerped)
+		{
+			const Kernels& kernels = Get();
+			kernels.lerpFloats(start.x, end.x, percent, o_Lerped.x, start.count);
+			kernels.lerpFloats(start.y, end.y, percent, o_Lerped.y, start.count);
+			kernels.lerpFloats(start.z, end.z, percent, o_Lerped.z, start.count);
+		}
+	}
+}
@@ -0,0 +1,70 @@
+/*
+The Batch functions do the Vector3 math from Vector3.h on whole arrays of vectors at once,
+so a big loop over vectors can use SIMD without writing intrinsics at the call site.
+
+Every function comes in two layouts:
+	AoS (array of structures) works straight on an array of Vector3, so existing arrays can be passed in as they are.
+	SoA (structure of arrays) works on separate x, y and z arrays. This is faster, as 8 or 16 vectors fit in a register with no shuffling.
+
+The best version for the CPU (AVX-512, AVX2 or scalar) is picked the first time a Batch function is called.
+The AoS Dot, Cross, Length and Normalize stop at AVX2, as they spend their time rearranging floats rather than doing math.
+Every version uses exact square roots and divides, so each lane matches what the scalar Vector3 functions give.
+
+An output array may be the same as an input array, but must not partly overlap one.
+*/
+
+#pragma once
+
+#include <stddef.h>
+
+namespace Math
+{
+	class Vector3;
+
+	// count vectors stored as separate x, y and z arrays.
+	struct Vector3SoA
+	{
+		float* x;
+		float* y;
+		float* z;
+		size_t count;
+	};
+
+	// The same as Vector3SoA, for vectors that are only read.
+	struct ConstVector3SoA
+	{
+		const float* x;
+		const float* y;
+		const float* z;
+		size_t count;
+
+		ConstVector3SoA(const float* i_x, const float* i_y, const float* i_z, size_t i_count) : x(i_x), y(i_y), z(i_z), count(i_count) {}
+		ConstVector3SoA(const Vector3SoA& i_Vectors) : x(i_Vectors.x), y(i_Vectors.y), z(i_Vectors.z), count(i_Vectors.count) {}
+	};
+
+	namespace Batch
+	{
+		/****** Array of Structures ******/
+		// o_Dots[i] = Dot(lhs[i], rhs[i])
+		void Dot(const Vector3* lhs, const Vector3* rhs, float* o_Dots, size_t count);
+		// o_Cross[i] = Cross(lhs[i], rhs[i])
+		void Cross(const Vector3* lhs, const Vector3* rhs, Vector3* o_Cross, size_t count);
+		// o_Scaled[i] = Scale(lhs[i], rhs[i])
+		void Scale(const Vector3* lhs, const Vector3* rhs, Vector3* o_Scaled, size_t count);
+		// o_Lengths[i] = vectors[i].Length()
+		void Length(const Vector3* vectors, float* o_Lengths, size_t count);
+		// Normalizes every vector. Vectors with a length of 0 are left as they are.
+		void Normalize(Vector3* io_Vectors, size_t count);
+		// o_Lerped[i] = Lerp(start[i], end[i], percent)
+		void Lerp(const Vector3* start, const Vector3* end, float percent, Vector3* o_Lerped, size_t count);
+
+		/****** Structure of Arrays ******/
+		// Every input must have at least as many vectors as the first one. That is how many are done.
+		void Dot(const ConstVector3SoA& lhs, const ConstVector3SoA& rhs, float* o_Dots);
+		void Cross(const ConstVector3SoA& lhs, const ConstVector3SoA& rhs, const Vector3SoA& o_Cross);
+		void Scale(const ConstVector3SoA& lhs, const ConstVector3SoA& rhs, const Vector3SoA& o_Scaled);
+		void Length(const ConstVector3SoA& vectors, float* o_Lengths);
+		void Normalize(const Vector3SoA& io_Vectors);
+		void Lerp(const ConstVector3SoA& start, const ConstVector3SoA& end, float percent, const Vector3SoA& o_Lerped);
+	}
+}
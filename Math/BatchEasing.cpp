@@ -0,0 +1,204 @@
+/*
+This source file contains the definitions for the functions declared in BatchEasing.h
+Each curve is a small struct that turns a register of percents into a register of eased fractions.
+One loop template runs any curve over the arrays, so the curves only have the math in them.
+The last few values are copied into a full register, so every value goes through the same math no matter where it is in the array.
+*/
+
+#include "BatchEasing.h"
+
+#include "Functions.h"
+#include "SIMD.h"
+
+#if MATH_SIMD_X86
+	#include <immintrin.h>
+#endif
+
+namespace Math
+{
+	namespace Batch
+	{
+		typedef float (*ScalarEase)(float, float, float);
+		typedef void (*ArrayEase)(const float*, const float*, const float*, float*, size_t);
+
+		// Used when the CPU doesn't have AVX2
+		template<ScalarEase Ease>
+		static void EaseScalar(const float* i_pStart, const float* i_pEnd, const float* i_pPercent, float* o_pEased, size_t i_Count)
+		{
+			for (size_t i = 0; i < i_Count; i++)
+			{
+				o_pEased[i] = Ease(i_pStart[i], i_pEnd[i], i_pPercent[i]);
+			}
+		}
+
+#if MATH_SIMD_X86
+		/******  Shared Math   ******/
+		MATH_TARGET_AVX2 static inline __m256 Set(float i_Value) { return _mm256_set1_ps(i_Value); }
+
+		// sin(u * Pi / 2). Splits u into whole quarter turns k and a remainder f in [-0.5, 0.5].
+		MATH_TARGET_AVX2 static inline __m256 SinQuarter(__m256 u)
+		{
+			const __m256 k = _mm256_round_ps(u, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+			const __m256 f = _mm256_sub_ps(u, k);
+			const __m256 f2 = _mm256_mul_ps(f, f);
+
+			// Taylor series of sin(f * Pi / 2) and cos(f * Pi / 2). The first term left out is under 2e-9 for |f| <= 0.5.
+			__m256 sinPoly = Set(1.6044118478735982e-4f);
+			sinPoly = _mm256_fmadd_ps(sinPoly, f2, Set(-4.6817541353186881e-3f));
+			sinPoly = _mm256_fmadd_ps(sinPoly, f2, Set(7.9692626246167045e-2f));
+			sinPoly = _mm256_fmadd_ps(sinPoly, f2, Set(-6.4596409750624625e-1f));
+			sinPoly = _mm256_fmadd_ps(sinPoly, f2, Set(1.5707963267948966f));
+			sinPoly = _mm256_mul_ps(sinPoly, f);
+
+			__m256 cosPoly = Set(-2.5202042373060605e-5f);
+			cosPoly = _mm256_fmadd_ps(cosPoly, f2, Set(9.1926027483942659e-4f));
+			cosPoly = _mm256_fmadd_ps(cosPoly, f2, Set(-2.0863480763353118e-2f));
+			cosPoly = _mm256_fmadd_ps(cosPoly, f2, Set(2.5366950790104802e-1f));
+			cosPoly = _mm256_fmadd_ps(cosPoly, f2, Set(-1.2337005501361698f));
+			cosPoly = _mm256_fmadd_ps(cosPoly, f2, Set(1.0f));
+
+			// Odd quarter turns swap sin for cos, and the second half of the circle flips the sign
+			const __m256i quarter = _mm256_cvtps_epi32(k);
+			const __m256 odd = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(quarter, _mm256_set1_epi32(1)), _mm256_set1_epi32(1)));
+			const __m256 sign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(quarter, _mm256_set1_epi32(2)), 30));
+			return _mm256_xor_ps(_mm256_blendv_ps(sinPoly, cosPoly, odd), sign);
+		}
+
+		// cos(u * Pi / 2) is a quarter turn ahead of sin
+		MATH_TARGET_AVX2 static inline __m256 CosQuarter(__m256 u)
+		{
+			return SinQuarter(_mm256_add_ps(u, Set(1.0f)));
+		}
+
+		/******     Curves     ******/
+		struct InSin
+		{
+			MATH_TARGET_AVX2 static inline __m256 Fraction(__m256 p) { return _mm256_sub_ps(Set(1.0f), CosQuarter(p)); }
+		};
+		struct OutSin
+		{
+			MATH_TARGET_AVX2 static inline __m256 Fraction(__m256 p) { return SinQuarter(p); }
+		};
+		struct InOutSin
+		{
+			MATH_TARGET_AVX2 static inline __m256 Fraction(__m256 p)
+			{
+				return _mm256_fnmadd_ps(Set(0.5f), CosQuarter(_mm256_add_ps(p, p)), Set(0.5f));
+			}
+		};
+
+		struct InCirc
+		{
+			MATH_TARGET_AVX2 static inline __m256 Fraction(__m256 p)
+			{
+				return _mm256_sub_ps(Set(1.0f), _mm256_sqrt_ps(_mm256_fnmadd_ps(p, p, Set(1.0f))));
+			}
+		};
+		struct OutCirc
+		{
+			MATH_TARGET_AVX2 static inline __m256 Fraction(__m256 p)
+			{
+				return _mm256_sqrt_ps(_mm256_mul_ps(p, _mm256_sub_ps(Set(2.0f), p)));
+			}
+		};
+		struct InOutCirc
+		{
+			MATH_TARGET_AVX2 static inline __m256 Fraction(__m256 p)
+			{
+				// The first half uses q = 2p and the second half q = 2p - 2. Both are 0.5 * (1 -+ sqrt(1 - q^2)).
+				const __m256 firstHalf = _mm256_cmp_ps(p, Set(0.5f), _CMP_LT_OQ);
+				const __m256 twoP = _mm256_add_ps(p, p);
+				const __m256 q = _mm256_blendv_ps(_mm256_sub_ps(twoP, Set(2.0f)), twoP, firstHalf);
+				const __m256 halfRoot = _mm256_mul_ps(Set(0.5f), _mm256_sqrt_ps(_mm256_fnmadd_ps(q, q, Set(1.0f))));
+				return _mm256_blendv_ps(_mm256_add_ps(Set(0.5f), halfRoot), _mm256_sub_ps(Set(0.5f), halfRoot), firstHalf);
+			}
+		};
+
+		struct InQuad
+		{
+			MATH_TARGET_AVX2 static inline __m256 Fraction(__m256 p) { return _mm256_mul_ps(p, p); }
+		};
+		struct OutQuad
+		{
+			MATH_TARGET_AVX2 static inline __m256 Fraction(__m256 p) { return _mm256_mul_ps(p, _mm256_sub_ps(Set(2.0f), p)); }
+		};
+		struct InOutQuad
+		{
+			MATH_TARGET_AVX2 static inline __m256 Fraction(__m256 p)
+			{
+				// 0.5 * q^2 for the first half, 0.5 * (1 - r * (r - 2)) with r = q - 1 for the second
+				const __m256 q = _mm256_add_ps(p, p);
+				const __m256 r = _mm256_sub_ps(q, Set(1.0f));
+				const __m256 first = _mm256_mul_ps(Set(0.5f), _mm256_mul_ps(q, q));
+				const __m256 second = _mm256_mul_ps(Set(0.5f), _mm256_fnmadd_ps(r, _mm256_sub_ps(r, Set(2.0f)), Set(1.0f)));
+				return _mm256_blendv_ps(second, first, _mm256_cmp_ps(q, Set(1.0f), _CMP_LT_OQ));
+			}
+		};
+
+		/******      Loop      ******/
+		template<typename Curve>
+		MATH_TARGET_AVX2 static inline __m256 Ease8(const float* i_pStart, const float* i_pEnd, const float* i_pPercent)
+		{
+			const __m256 start = _mm256_loadu_ps(i_pStart);
+			const __m256 fraction = Curve::Fraction(_mm256_loadu_ps(i_pPercent));
+			return _mm256_fmadd_ps(fraction, _mm256_sub_ps(_mm256_loadu_ps(i_pEnd), start), start);
+		}
+
+		template<typename Curve>
+		MATH_TARGET_AVX2 static void EaseAVX2(const float* i_pStart, const float* i_pEnd, const float* i_pPercent, float* o_pEased, size_t i_Count)
+		{
+			const size_t count = i_Count & ~static_cast<size_t>(7);
+			for (size_t i = 0; i < count; i += 8)
+			{
+				_mm256_storeu_ps(o_pEased + i, Ease8<Curve>(i_pStart + i, i_pEnd + i, i_pPercent + i));
+			}
+
+			const size_t left = i_Count - count;
+			if (left > 0)
+			{
+				// Fill the unused lanes with 0 so they don't produce anything strange
+				float start[8] = {}, end[8] = {}, percent[8] = {}, eased[8];
+				for (size_t i = 0; i < left; i++)
+				{
+					start[i] = i_pStart[count + i];
+					end[i] = i_pEnd[count + i];
+					percent[i] = i_pPercent[count + i];
+				}
+				_mm256_storeu_ps(eased, Ease8<Curve>(start, end, percent));
+				for (size_t i = 0; i < left; i++)
+				{
+					o_pEased[count + i] = eased[i];
+				}
+			}
+		}
+#endif
+
+		/******    Dispatch    ******/
+#if MATH_SIMD_X86
+		#define MATH_BATCH_EASE(Name, Curve) \
+			void Name(const float* start, const float* end, const float* percent, float* o_Eased, size_t count) \
+			{ \
+				static const ArrayEase s_Ease = SIMD::Supported() >= SIMD::AVX2 ? ArrayEase(EaseAVX2<Curve>) : ArrayEase(EaseScalar<Math::Name>); \
+				s_Ease(start, end, percent, o_Eased, count); \
+			}
+#else
+		#define MATH_BATCH_EASE(Name, Curve) \
+			void Name(const float* start, const float* end, const float* percent, float* o_Eased, size_t count) \
+			{ \
+				EaseScalar<Math::Name>(start, end, percent, o_Eased, count); \
+			}
+#endif
+
+		MATH_BATCH_EASE(EaseInSin, InSin)
+		MATH_BATCH_EASE(EaseOutSin, OutSin)
+		MATH_BATCH_EASE(EaseInOutSin, InOutSin)
+		MATH_BATCH_EASE(EaseInCirc, InCirc)
+		MATH_BATCH_EASE(EaseOutCirc, OutCirc)
+		MATH_BATCH_EASE(EaseInOutCirc, InOutCirc)
+		MATH_BATCH_EASE(EaseInQuad, InQuad)
+		MATH_BATCH_EASE(EaseOutQuad, OutQuad)
+		MATH_BATCH_EASE(EaseInOutQuad, InOutQuad)
+
+		#undef MATH_BATCH_EASE
+	}
+}
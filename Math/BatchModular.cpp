@@ -0,0 +1,252 @@
+/*
+This source file contains the definitions for the functions declared in BatchModular.h
+Each AVX2 function does the same steps as its scalar function in Functions.cpp, in the same order,
+with each branch worked out for every lane and the right one picked with a blend.
+The compiler would fuse ModLerp's multiply and add anyway, so it is written as a fused multiply add.
+*/
+
+#include "BatchModular.h"
+
+#include <math.h>
+
+#include "Functions.h"
+#include "SIMD.h"
+
+#if MATH_SIMD_X86
+	#include <immintrin.h>
+#endif
+
+namespace Math
+{
+	namespace Batch
+	{
+#if MATH_SIMD_X86
+		MATH_TARGET_AVX2 static inline __m256 Set(float i_Value) { return _mm256_set1_ps(i_Value); }
+
+		// The modular space every value in a call is in
+		struct Space
+		{
+			__m256 min;
+			__m256 range;
+			float modMin;
+			float modMax;
+		};
+
+		// ModularRange on 8 values
+		MATH_TARGET_AVX2 static inline __m256 Range8(__m256 i_Value, const Space& i_Space)
+		{
+			const __m256 min = i_Space.min;
+			const __m256 range = i_Space.range;
+			__m256 offset = _mm256_sub_ps(i_Value, min);
+			offset = _mm256_blendv_ps(offset, _mm256_add_ps(offset, range), _mm256_cmp_ps(offset, _mm256_setzero_ps(), _CMP_LT_OQ));
+			offset = _mm256_blendv_ps(offset, _mm256_sub_ps(offset, range), _mm256_cmp_ps(offset, range, _CMP_GE_OQ));
+
+			// Anything still outside [0, range) was more than one range away (or is NaN), so let fmodf handle it
+			const __m256 inside = _mm256_and_ps(_mm256_cmp_ps(offset, _mm256_setzero_ps(), _CMP_GE_OQ), _mm256_cmp_ps(offset, range, _CMP_LT_OQ));
+			if (_mm256_movemask_ps(inside) != 0xFF)
+			{
+				float value[8];
+				_mm256_storeu_ps(value, i_Value);
+				for (int i = 0; i < 8; i++)
+				{
+					value[i] = Math::ModularRange(value[i], i_Space.modMin, i_Space.modMax);
+				}
+				return _mm256_loadu_ps(value);
+			}
+			return _mm256_add_ps(offset, min);
+		}
+
+		// Wraps a distance between two values already in the space back into [0, range)
+		MATH_TARGET_AVX2 static inline __m256 WrapUp(__m256 i_Distance, __m256 i_Range)
+		{
+			return _mm256_blendv_ps(i_Distance, _mm256_add_ps(i_Distance, i_Range), _mm256_cmp_ps(i_Distance, _mm256_setzero_ps(), _CMP_LT_OQ));
+		}
+
+		struct RangeOp
+		{
+			static const int Inputs = 1;
+			MATH_TARGET_AVX2 static inline __m256 Run(const __m256* i_pIn, const Space& i_Space)
+			{
+				return Range8(i_pIn[0], i_Space);
+			}
+		};
+
+		struct ClampOp
+		{
+			static const int Inputs = 3;
+			MATH_TARGET_AVX2 static inline __m256 Run(const __m256* i_pIn, const Space& i_Space)
+			{
+				const __m256 range = i_Space.range;
+				const __m256 value = Range8(i_pIn[0], i_Space);
+				const __m256 clampMin = Range8(i_pIn[1], i_Space);
+				const __m256 clampMax = Range8(i_pIn[2], i_Space);
+
+				const __m256 aboveMin = _mm256_cmp_ps(value, clampMin, _CMP_GE_OQ);
+				const __m256 belowMax = _mm256_cmp_ps(value, clampMax, _CMP_LE_OQ);
+				const __m256 inRange = _mm256_blendv_ps(_mm256_or_ps(aboveMin, belowMax), _mm256_and_ps(aboveMin, belowMax), _mm256_cmp_ps(clampMin, clampMax, _CMP_LT_OQ));
+
+				const __m256 toMin = WrapUp(_mm256_sub_ps(clampMin, value), range);
+				const __m256 toMax = WrapUp(_mm256_sub_ps(value, clampMax), range);
+				__m256 clamped = _mm256_blendv_ps(clampMax, clampMin, _mm256_cmp_ps(toMin, toMax, _CMP_LT_OQ));
+				clamped = _mm256_blendv_ps(clamped, value, inRange);
+				return _mm256_blendv_ps(clamped, clampMin, _mm256_cmp_ps(clampMin, clampMax, _CMP_EQ_OQ));
+			}
+		};
+
+		struct LerpOp
+		{
+			static const int Inputs = 3;
+			MATH_TARGET_AVX2 static inline __m256 Run(const __m256* i_pIn, const Space& i_Space)
+			{
+				const __m256 range = i_Space.range;
+				const __m256 start = Range8(i_pIn[0], i_Space);
+				__m256 end = Range8(i_pIn[1], i_Space);
+				const __m256 percent = i_pIn[2];
+
+				// Close enough to go straight there, or the shortest path crosses the modular break point
+				const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+				const __m256 distance = _mm256_sub_ps(end, start);
+				const __m256 direct = _mm256_cmp_ps(_mm256_and_ps(distance, absMask), _mm256_mul_ps(range, Set(0.5f)), _CMP_LT_OQ);
+
+				end = _mm256_blendv_ps(_mm256_add_ps(end, range), _mm256_sub_ps(end, range), _mm256_cmp_ps(end, start, _CMP_GT_OQ));
+				const __m256 across = _mm256_fmadd_ps(percent, _mm256_sub_ps(end, start), start);
+				const __m256 straight = _mm256_fmadd_ps(percent, distance, start);
+
+				// Only wrap the lanes that went across the break point, the same as the scalar function
+				if (_mm256_movemask_ps(direct) == 0xFF)
+				{
+					return straight;
+				}
+				return _mm256_blendv_ps(Range8(across, i_Space), straight, direct);
+			}
+		};
+
+		struct ArcOp
+		{
+			static const int Inputs = 2;
+			MATH_TARGET_AVX2 static inline __m256 Run(const __m256* i_pIn, const Space& i_Space)
+			{
+				const __m256 range = i_Space.range;
+				const __m256 distance = _mm256_sub_ps(Range8(i_pIn[1], i_Space), Range8(i_pIn[0], i_Space));
+				const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+				const __m256 direct = _mm256_cmp_ps(_mm256_and_ps(distance, absMask), _mm256_mul_ps(range, Set(0.5f)), _CMP_LT_OQ);
+				const __m256 around = _mm256_blendv_ps(_mm256_add_ps(distance, range), _mm256_sub_ps(distance, range), _mm256_cmp_ps(distance, _mm256_setzero_ps(), _CMP_GT_OQ));
+				return _mm256_blendv_ps(around, distance, direct);
+			}
+		};
+
+		// Runs an Op over the arrays 8 values at a time. The last few values are copied into a full register.
+		template<typename Op>
+		MATH_TARGET_AVX2 static void RunAVX2(const float* const* i_ppIn, float* o_pOut, size_t i_Count, float i_Min, float i_Max)
+		{
+			Space space;
+			space.min = Set(i_Min);
+			space.range = Set(i_Max - i_Min);
+			space.modMin = i_Min;
+			space.modMax = i_Max;
+			__m256 in[Op::Inputs];
+
+			const size_t count = i_Count & ~static_cast<size_t>(7);
+			for (size_t i = 0; i < count; i += 8)
+			{
+				for (int n = 0; n < Op::Inputs; n++)
+				{
+					in[n] = _mm256_loadu_ps(i_ppIn[n] + i);
+				}
+				_mm256_storeu_ps(o_pOut + i, Op::Run(in, space));
+			}
+
+			const size_t left = i_Count - count;
+			if (left > 0)
+			{
+				// Fill the unused lanes with the min so they stay in the fast path
+				float tail[Op::Inputs][8];
+				for (int n = 0; n < Op::Inputs; n++)
+				{
+					for (size_t i = 0; i < 8; i++)
+					{
+						tail[n][i] = i < left ? i_ppIn[n][count + i] : i_Min;
+					}
+					in[n] = _mm256_loadu_ps(tail[n]);
+				}
+				float out[8];
+				_mm256_storeu_ps(out, Op::Run(in, space));
+				for (size_t i = 0; i < left; i++)
+				{
+					o_pOut[count + i] = out[i];
+				}
+			}
+		}
+
+		static bool UseAVX2()
+		{
+			static const bool s_AVX2 = SIMD::Supported() >= SIMD::AVX2;
+			return s_AVX2;
+		}
+#endif
+
+		void ModularRange(const float* value, float* o_Value, size_t count, float modMin, float modMax)
+		{
+#if MATH_SIMD_X86
+			if (UseAVX2())
+			{
+				const float* in[] = { value };
+				RunAVX2<RangeOp>(in, o_Value, count, modMin, modMax);
+				return;
+			}
+#endif
+			for (size_t i = 0; i < count; i++)
+			{
+				o_Value[i] = Math::ModularRange(value[i], modMin, modMax);
+			}
+		}
+
+		void ModularClamp(const float* value, const float* clampMin, const float* clampMax, float* o_Clamped, size_t count, float modMin, float modMax)
+		{
+#if MATH_SIMD_X86
+			if (UseAVX2())
+			{
+				const float* in[] = { value, clampMin, clampMax };
+				RunAVX2<ClampOp>(in, o_Clamped, count, modMin, modMax);
+				return;
+			}
+#endif
+			for (size_t i = 0; i < count; i++)
+			{
+				o_Clamped[i] = Math::ModularClamp(value[i], modMin, modMax, clampMin[i], clampMax[i]);
+			}
+		}
+
+		void ModLerp(const float* start, const float* end, const float* percent, float* o_Value, size_t count, float modMin, float modMax)
+		{
+#if MATH_SIMD_X86
+			if (UseAVX2())
+			{
+				const float* in[] = { start, end, percent };
+				RunAVX2<LerpOp>(in, o_Value, count, modMin, modMax);
+				return;
+			}
+#endif
+			for (size_t i = 0; i < count; i++)
+			{
+				o_Value[i] = Math::ModLerp(start[i], end[i], percent[i], modMin, modMax);
+			}
+		}
+
+		void ShortestArc(const float* from, const float* to, float* o_Arc, size_t count, float modMin, float modMax)
+		{
+#if MATH_SIMD_X86
+			if (UseAVX2())
+			{
+				const float* in[] = { from, to };
+				RunAVX2<ArcOp>(in, o_Arc, count, modMin, modMax);
+				return;
+			}
+#endif
+			for (size_t i = 0; i < count; i++)
+			{
+				o_Arc[i] = Math::ShortestArc(from[i], to[i], modMin, modMax);
+			}
+		}
+	}
+}
@@ -0,0 +1,49 @@
+/*
+Array versions of the modular functions in Functions.h, for rotating many things at once.
+Every value in a call shares the same modular space (modMin to modMax), such as 0 to 360 for angles in degrees.
+
+Values are almost always at most one range outside the space, so instead of fmodf a value is moved back in
+by adding or subtracting the range once. That is exact, so it gives the same result fmodf does.
+With AVX2 that is done on 8 values at a time, along with all of the choices, so none of them branch.
+Only a register holding a value more than one range away falls back to fmodf.
+ModularRange, ModularClamp and ShortestArc give exactly the same result as the scalar function they are named after.
+ModLerp interpolates with a fused multiply add, so it can be a rounding closer to the exact answer than the scalar ModLerp.
+Where that rounding puts the result on the other side of modMin, the two are still the same point in the space
+but one of them is just above modMin and the other just below modMax.
+
+On CPUs without AVX2 they just call the scalar functions.
+*/
+
+#pragma once
+
+#include <stddef.h>
+
+#include "Constants.h"
+
+namespace Math
+{
+	namespace Batch
+	{
+		// o_Value[i] = ModularRange(value[i], modMin, modMax)
+		void ModularRange(const float* value, float* o_Value, size_t count, float modMin, float modMax);
+
+		// o_Clamped[i] = ModularClamp(value[i], modMin, modMax, clampMin[i], clampMax[i])
+		void ModularClamp(const float* value, const float* clampMin, const float* clampMax, float* o_Clamped, size_t count, float modMin, float modMax);
+
+		// o_Value[i] = ModLerp(start[i], end[i], percent[i], modMin, modMax)
+		void ModLerp(const float* start, const float* end, const float* percent, float* o_Value, size_t count, float modMin, float modMax);
+
+		// o_Arc[i] = ShortestArc(from[i], to[i], modMin, modMax)
+		void ShortestArc(const float* from, const float* to, float* o_Arc, size_t count, float modMin, float modMax);
+
+		// Turns angles the shortest way from start to end. Degrees are kept in [0, 360) and radians in [0, 2 Pi).
+		inline void LerpDegrees(const float* start, const float* end, const float* percent, float* o_Angle, size_t count)
+		{
+			ModLerp(start, end, percent, o_Angle, count, 0, 360.0f);
+		}
+		inline void LerpRadians(const float* start, const float* end, const float* percent, float* o_Angle, size_t count)
+		{
+			ModLerp(start, end, percent, o_Angle, count, 0, 2 * Pi);
+		}
+	}
+}
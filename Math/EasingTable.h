@@ -0,0 +1,78 @@
+/*
+The EasingTable stores every easing curve from Functions.h as a table of evenly spaced samples,
+so easing is a lookup and a Lerp between two samples instead of a sinf, cosf or sqrtf.
+The tables are built at compile time when the EasingTable is declared constexpr, so nothing is worked out while the game runs:
+	static constexpr Math::EasingTable<256> s_Easing;
+
+Resolution is how many intervals each curve is split into. More intervals means less error but a bigger table:
+each curve takes (Resolution + 1) * 4 bytes, and all 9 curves are stored.
+Linear interpolation error shrinks with the square of the resolution for every curve except the Circ curves,
+which are vertical at one end, so their error there only shrinks with the square root of the resolution.
+
+Largest error against the exact functions, from MaxError. Benchmarks/MathBenchmark.cpp prints this again along with lookup times:
+	Resolution	Sin			InOutSin	Quad		InOutQuad	Circ		InOutCirc	Bytes
+	64			7.5e-5		1.5e-4		6.1e-5		1.2e-4		4.4e-2		3.1e-2		2340
+	256			4.7e-6		9.4e-6		3.8e-6		7.6e-6		2.2e-2		1.6e-2		9252
+	1024		3.6e-7		6.6e-7		2.4e-7		4.8e-7		1.1e-2		7.8e-3		36900
+The Circ tables are only worth using where a few percent of error at the steep end can't be seen.
+
+Percents outside [0, 1] are clamped, where the exact functions would keep going.
+The tables need C++14 constexpr. Compilers limit how much work a constexpr can do, so very large resolutions may need to be built at run time instead.
+*/
+
+#pragma once
+
+#include <stddef.h>
+
+namespace Math
+{
+	namespace Easing
+	{
+		// Every curve in the table.
+		enum Curve
+		{
+			InSin,
+			OutSin,
+			InOutSin,
+			InCirc,
+			OutCirc,
+			InOutCirc,
+			InQuad,
+			OutQuad,
+			InOutQuad,
+			CurveCount,
+		};
+
+		// The exact eased fraction (0 at the start, 1 at the end) of a curve, usable at compile time.
+		constexpr double Fraction(Curve curve, double percent);
+	}
+
+	template<size_t Resolution>
+	class EasingTable
+	{
+	public:
+		static_assert(Resolution >= 1, "An EasingTable needs at least one interval");
+
+		// Samples every curve.
+		constexpr EasingTable();
+
+		// The eased fraction for percent. Percent is clamped to [0, 1].
+		inline float Fraction(Easing::Curve curve, float percent) const;
+
+		// Eases between start and end the same way the functions in Functions.h do.
+		inline float Ease(Easing::Curve curve, float start, float end, float percent) const;
+
+		// Eases count values at once: o_Eased[i] = Ease(curve, start[i], end[i], percent[i])
+		void Ease(Easing::Curve curve, const float* start, const float* end, const float* percent, float* o_Eased, size_t count) const;
+
+		// The largest difference between the table and the exact function in Functions.h,
+		// checked at samplesPerInterval evenly spaced points in every interval.
+		float MaxError(Easing::Curve curve, size_t samplesPerInterval = 16) const;
+
+	private:
+		float _Samples[Easing::CurveCount][Resolution + 1];
+	};
+
+} // End namespace Math
+
+#include "EasingTable.inl"
@@ -0,0 +1,165 @@
+/*
+An inline file used to define my inline functions for the EasingTable.
+The constexpr math works in double precision so the samples are rounded to float only once.
+*/
+
+#include "Constants.h"
+#include "Functions.h"
+
+namespace Math
+{
+	namespace Easing
+	{
+		// sin(x) for x in [-Pi, Pi]. The Taylor series has converged to double precision well before 20 terms on that range.
+		constexpr double ConstSin(double x)
+		{
+			double term = x;
+			double sum = x;
+			for (int n = 1; n < 20; n++)
+			{
+				term *= -x * x / ((2 * n) * (2 * n + 1));
+				sum += term;
+			}
+			return sum;
+		}
+
+		// cos(x) for x in [-Pi, Pi]
+		constexpr double ConstCos(double x)
+		{
+			double term = 1;
+			double sum = 1;
+			for (int n = 1; n < 20; n++)
+			{
+				term *= -x * x / ((2 * n - 1) * (2 * n));
+				sum += term;
+			}
+			return sum;
+		}
+
+		// Square root by Newton's method. Negative values return 0.
+		constexpr double ConstSqrt(double x)
+		{
+			if (x <= 0)
+			{
+				return 0;
+			}
+			double guess = x < 1 ? 1 : x;
+			for (int i = 0; i < 100; i++)
+			{
+				const double next = 0.5 * (guess + x / guess);
+				if (next >= guess)
+				{
+					break;
+				}
+				guess = next;
+			}
+			return guess;
+		}
+
+		constexpr double Fraction(Curve curve, double percent)
+		{
+			// Pi in double, as the float one in Constants.h would limit the samples to float precision
+			const double pi = 3.14159265358979323846;
+			switch (curve)
+			{
+			case InSin:
+				return 1 - ConstCos(percent * pi * 0.5);
+			case OutSin:
+				return ConstSin(percent * pi * 0.5);
+			case InOutSin:
+				return 0.5 - 0.5 * ConstCos(percent * pi);
+			case InCirc:
+				return 1 - ConstSqrt(1 - percent * percent);
+			case OutCirc:
+				return ConstSqrt(percent * (2 - percent));
+			case InOutCirc:
+				if (percent < 0.5)
+				{
+					return 0.5 * (1 - ConstSqrt(1 - 4 * percent * percent));
+				}
+				return 0.5 * (1 + ConstSqrt(1 - (2 * percent - 2) * (2 * percent - 2)));
+			case InQuad:
+				return percent * percent;
+			case OutQuad:
+				return percent * (2 - percent);
+			case InOutQuad:
+				if (percent < 0.5)
+				{
+					return 2 * percent * percent;
+				}
+				return 0.5 * (1 - (2 * percent - 1) * (2 * percent - 3));
+			default:
+				return percent;
+			}
+		}
+	}
+
+	template<size_t Resolution>
+	constexpr EasingTable<Resolution>::EasingTable() :
+		_Samples()
+	{
+		for (size_t curve = 0; curve < Easing::CurveCount; curve++)
+		{
+			for (size_t i = 0; i <= Resolution; i++)
+			{
+				_Samples[curve][i] = static_cast<float>(Easing::Fraction(static_cast<Easing::Curve>(curve), static_cast<double>(i) / Resolution));
+			}
+		}
+	}
+
+	template<size_t Resolution>
+	inline float EasingTable<Resolution>::Fraction(Easing::Curve curve, float percent) const
+	{
+		// Written so a NaN percent clamps to 0 instead of reading outside the table
+		const float position = (percent > 0 ? (percent < 1 ? percent : 1) : 0) * Resolution;
+		size_t index = static_cast<size_t>(position);
+		if (index >= Resolution)
+		{
+			index = Resolution - 1;
+		}
+
+		const float* pSamples = _Samples[curve];
+		return Lerp(pSamples[index], pSamples[index + 1], position - static_cast<float>(index));
+	}
+
+	template<size_t Resolution>
+	inline float EasingTable<Resolution>::Ease(Easing::Curve curve, float start, float end, float percent) const
+	{
+		return start + Fraction(curve, percent) * (end - start);
+	}
+
+	template<size_t Resolution>
+	void EasingTable<Resolution>::Ease(Easing::Curve curve, const float* start, const float* end, const float* percent, float* o_Eased, size_t count) const
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			o_Eased[i] = Ease(curve, start[i], end[i], percent[i]);
+		}
+	}
+
+	template<size_t Resolution>
+	float EasingTable<Resolution>::MaxError(Easing::Curve curve, size_t samplesPerInterval) const
+	{
+		typedef float (*ExactEase)(float, float, float);
+		static const ExactEase s_Exact[Easing::CurveCount] =
+		{
+			EaseInSin, EaseOutSin, EaseInOutSin,
+			EaseInCirc, EaseOutCirc, EaseInOutCirc,
+			EaseInQuad, EaseOutQuad, EaseInOutQuad,
+		};
+
+		float maxError = 0;
+		const size_t steps = Resolution * (samplesPerInterval > 0 ? samplesPerInterval : 1);
+		for (size_t i = 0; i <= steps; i++)
+		{
+			const float percent = static_cast<float>(i) / steps;
+			float error = Fraction(curve, percent) - s_Exact[curve](0, 1, percent);
+			error = error < 0 ? -error : error;
+			if (error > maxError)
+			{
+				maxError = error;
+			}
+		}
+		return maxError;
+	}
+}
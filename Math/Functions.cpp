@@ -60,7 +60,18 @@ namespace Math
 	float ModularRange(float value, float min, float max)
 	{
 		float range = max - min;
-		return fmodf(value + range - min, range) + min;
+		// fmodf keeps the sign of value - min, so values below min need one more range added
+		float offset = fmodf(value - min, range);
+		if (offset < 0)
+		{
+			offset += range;
+		}
+		// A tiny negative offset can round up to the whole range, which is the same place as min
+		if (offset >= range)
+		{
+			offset -= range;
+		}
+		return offset + min;
 	}
 
 	// Clamps value between two numbers within a modular set of values
@@ -73,37 +84,44 @@ namespace Math
 		float modClampMin = ModularRange(clampMin, modMin, modMax);
 		float modClampMax = ModularRange(clampMax, modMin, modMax);
 
+		if (modClampMin == modClampMax)
+		{
+			return modClampMin;
+		}
+
 		// Is the min less than the max (eg. min of 90 and max of 270 as opposed to min of 270 (-90) and max of 90).
-		if (modClampMin < modClampMax)
-		{
-			if (modValue < modClampMin)
-			{
-				return modClampMin;
-			}
-			if (modValue > modClampMax)
-			{
-				return modClampMin;
-			}
+		// If the min is greater than the max, we're within range if we're greater than the min OR less than the max.
+		const bool inRange = modClampMin < modClampMax ? (modValue >= modClampMin && modValue <= modClampMax) : (modValue >= modClampMin || modValue <= modClampMax);
+		if (inRange)
+		{
 			return modValue;
 		}
-		if (modClampMin > modClampMax)
-		{
-			// If we're greater than the min OR less than the max, then it's within range.
-			// This uses OR not AND because it's modular and the min is greater than the max.
-			if (modValue > modClampMin || modValue < modClampMax)
-			{
-				return modValue;
-			}
 
-			// Is value closer to the min or the max. Which does it clamp to since it's modular?
-			if (abs(modValue - modClampMin) < abs(modValue - modClampMax))
-			{
-				return modClampMin;
-			}
+		// Is value closer to the min or the max? Both distances go around the part of the modular space outside the clamp.
+		float toMin = modClampMin - modValue;
+		if (toMin < 0)
+		{
+			toMin += modRange;
+		}
+		float toMax = modValue - modClampMax;
+		if (toMax < 0)
+		{
+			toMax += modRange;
+		}
+		return toMin < toMax ? modClampMin : modClampMax;
+	}
 
-			return modClampMax;
+	// The signed distance from one value to another along the shortest way around a modular space, such as with angles
+	float ShortestArc(float from, float to, float modMin, float modMax)
+	{
+		float modRange = modMax - modMin;
+		float distance = ModularRange(to, modMin, modMax) - ModularRange(from, modMin, modMax);
+		if (abs(distance) < modRange * 0.5f)
+		{
+			return distance;
 		}
-		return modClampMin;
+		// Going the other way around is shorter. Matches the direction ModLerp takes when the two are exactly half the space apart.
+		return distance > 0 ? distance - modRange : distance + modRange;
 	}
 
 	/******  Interpolation   ******/
@@ -144,29 +162,30 @@ namespace Math
 	//****** Easing Functions ******/
 	// Note: Easing functions are a way to smoothly interpolate between two points, typically not linearly.
 	// Sinosuidal Easing
+	// A quarter of a sine wave goes from 0 to 1, so the In and Out curves use half Pi and the InOut curve uses a half wave.
 	float EaseInSin(float start, float end, float percent)
 	{
-		return Lerp(start, end, 1 - cosf((percent)* (Pi)));
+		return Lerp(start, end, 1 - cosf(percent * (Pi * 0.5f)));
 	}
 	float EaseOutSin(float start, float end, float percent)
 	{
-		return Lerp(start, end, sinf((percent)* (Pi)));
+		return Lerp(start, end, sinf(percent * (Pi * 0.5f)));
 	}
 	float EaseInOutSin(float start, float end, float percent)
 	{
-		return Lerp(start, end, 0.5f + 0.5f * cosf((percent - 0.5f) * (Pi)));
+		return Lerp(start, end, 0.5f - 0.5f * cosf(percent * (Pi)));
 	}
 	Vector3 EaseInSin(Vector3 start, Vector3 end, float percent)
 	{
-		return Lerp(start, end, 1 - cosf((percent)* (Pi)));
+		return Lerp(start, end, 1 - cosf(percent * (Pi * 0.5f)));
 	}
 	Vector3 EaseOutSin(Vector3 start, Vector3 end, float percent)
 	{
-		return Lerp(start, end, sinf((percent)* (Pi)));
+		return Lerp(start, end, sinf(percent * (Pi * 0.5f)));
 	}
 	Vector3 EaseInOutSin(Vector3 start, Vector3 end, float percent)
 	{
-		return Lerp(start, end, 0.5f + 0.5f * cosf((percent - 0.5f) * (Pi)));
+		return Lerp(start, end, 0.5f - 0.5f * cosf(percent * (Pi)));
 	}
 
 	// Quadratic Easing
@@ -176,7 +195,8 @@ namespace Math
 	}
 	float EaseOutCirc(float start, float end, float percent)
 	{
-		return Lerp(start, end, sqrtf(1 - percent * percent));
+		// The In curve flipped both ways, sqrt(1 - (percent - 1)^2)
+		return Lerp(start, end, sqrtf(percent * (2 - percent)));
 	}
 	float EaseInOutCirc(float start, float end, float percent)
 	{
@@ -194,7 +214,7 @@ namespace Math
 	}
 	Vector3 EaseOutCirc(Vector3 start, Vector3 end, float percent)
 	{
-		return Lerp(start, end, sqrtf(1 - percent * percent));
+		return Lerp(start, end, sqrtf(percent * (2 - percent)));
 	}
 	Vector3 EaseInOutCirc(Vector3 start, Vector3 end, float percent)
 	{
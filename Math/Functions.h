@@ -30,6 +30,7 @@ namespace Math
 	float NormalizeToRange(float value, float min, float max); // Normalizes a value to the range min-max.
 	float ModularRange(float value, float min, float max); // Creates a modular space between min and max, and then places value into space.
 	float ModularClamp(float value, float modMin, float modMax, float clampMin, float clampMax); // Clamps value between two numbers within a modular set of values
+	float ShortestArc(float from, float to, float modMin, float modMax); // The signed distance from one value to another the shortest way around a modular space
 
 	/******  Interpolation   ******/
 	float Lerp(float start, float end, float percent); // Linearly interpolates between the start and end given a percentage of the way through
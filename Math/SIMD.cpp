@@ -0,0 +1,104 @@
+/*
+This source file contains the CPU checks for SIMD.h
+It uses the CPUID instruction to ask the CPU what it supports,
+and XGETBV to make sure the OS saves the larger registers when switching threads.
+*/
+
+#include "SIMD.h"
+
+#if MATH_SIMD_X86
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+	#else
+		#include <cpuid.h>
+	#endif
+#endif
+
+namespace Math
+{
+	namespace SIMD
+	{
+#if MATH_SIMD_X86
+		// Fills o_Registers with eax, ebx, ecx and edx for the given leaf
+		static void CPUID(unsigned int leaf, unsigned int o_Registers[4])
+		{
+#if defined(_MSC_VER)
+			int registers[4];
+			__cpuidex(registers, static_cast<int>(leaf), 0);
+			for (int i = 0; i < 4; i++)
+			{
+				o_Registers[i] = static_cast<unsigned int>(registers[i]);
+			}
+#else
+			__cpuid_count(leaf, 0, o_Registers[0], o_Registers[1], o_Registers[2], o_Registers[3]);
+#endif
+		}
+
+		// Which registers the OS saves for us
+		static unsigned long long XGETBV()
+		{
+#if defined(_MSC_VER)
+			return _xgetbv(0);
+#else
+			unsigned int eax, edx;
+			__asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+			return (static_cast<unsigned long long>(edx) << 32) | eax;
+#endif
+		}
+
+		static Level Detect()
+		{
+			unsigned int registers[4];
+			CPUID(0, registers);
+			const unsigned int maxLeaf = registers[0];
+
+			CPUID(1, registers);
+			const bool sse2 = (registers[3] & (1u << 26)) != 0;
+			const bool fma = (registers[2] & (1u << 12)) != 0;
+			const bool osxsave = (registers[2] & (1u << 27)) != 0;
+			const bool avx = (registers[2] & (1u << 28)) != 0;
+			if (!sse2)
+			{
+				return Scalar;
+			}
+			if (!osxsave || !avx || !fma || maxLeaf < 7)
+			{
+				return SSE2;
+			}
+
+			// The OS has to save the XMM and YMM registers (bits 1 and 2)
+			const unsigned long long xcr0 = XGETBV();
+			if ((xcr0 & 0x6) != 0x6)
+			{
+				return SSE2;
+			}
+
+			CPUID(7, registers);
+			const bool avx2 = (registers[1] & (1u << 5)) != 0;
+			const bool avx512f = (registers[1] & (1u << 16)) != 0;
+			if (!avx2)
+			{
+				return SSE2;
+			}
+
+			// AVX-512 also needs the opmask and upper ZMM registers saved (bits 5, 6 and 7)
+			if (avx512f && (xcr0 & 0xE0) == 0xE0)
+			{
+				return AVX512;
+			}
+			return AVX2;
+		}
+#else
+		static Level Detect()
+		{
+			return Scalar;
+		}
+#endif
+
+		Level Supported()
+		{
+			static const Level s_Level = Detect();
+			return s_Level;
+		}
+	}
+}
@@ -0,0 +1,41 @@
+/*
+This header file is used to find out which SIMD instruction sets the CPU we are running on supports.
+Code with SIMD versions of a function checks the Level once and keeps a pointer to the best version,
+so the same build runs on older CPUs while still using AVX2 on newer ones.
+*/
+
+#pragma once
+
+// Lets a single function use instructions the rest of the build is not compiled for.
+// MSVC allows any intrinsic anywhere, so it does not need this.
+#if defined(_MSC_VER) && !defined(__clang__)
+	#define MATH_TARGET_AVX2
+	#define MATH_TARGET_AVX512
+#else
+	#define MATH_TARGET_AVX2 __attribute__((target("avx2,fma")))
+	#define MATH_TARGET_AVX512 __attribute__((target("avx512f,avx2,fma")))
+#endif
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	#define MATH_SIMD_X86 1
+#else
+	#define MATH_SIMD_X86 0
+#endif
+
+namespace Math
+{
+	namespace SIMD
+	{
+		// Each level includes every level below it.
+		enum Level
+		{
+			Scalar = 0,
+			SSE2 = 1,
+			AVX2 = 2, // Also requires FMA.
+			AVX512 = 3, // AVX-512 Foundation.
+		};
+
+		// The best level supported by both the CPU and the OS. Only checks the CPU the first time it is called.
+		Level Supported();
+	}
+}
@@ -0,0 +1,224 @@
+/*
+	This is the complementary cpp file for TweenSystem.h
+*/
+
+#include "TweenSystem.h"
+
+#include "BatchEasing.h"
+
+namespace Math
+{
+	TweenSystem::TweenSystem()
+	{
+	}
+
+	TweenSystem::Handle TweenSystem::Start(Curve i_Curve, float i_Start, float i_End, float i_Duration)
+	{
+		if (i_Curve < 0 || i_Curve >= CurveCount)
+		{
+			return InvalidHandle;
+		}
+
+		uint32_t slotIndex;
+		if (m_FreeSlots.empty())
+		{
+			slotIndex = static_cast<uint32_t>(m_Slots.size());
+			Slot slot;
+			slot.generation = 0;
+			m_Slots.push_back(slot);
+		}
+		else
+		{
+			slotIndex = m_FreeSlots.back();
+			m_FreeSlots.pop_back();
+		}
+
+		Pool& pool = m_Pools[i_Curve];
+		Slot& slot = m_Slots[slotIndex];
+		slot.curve = i_Curve;
+		slot.index = pool.handles.size();
+
+		// The slot index is stored plus one so no handle is ever 0
+		const Handle handle = (static_cast<Handle>(slot.generation) << 32) | (static_cast<Handle>(slotIndex) + 1);
+
+		// A tween with no duration starts at its end, so the next Update completes it
+		const bool instant = !(i_Duration > 0);
+		pool.start.push_back(i_Start);
+		pool.end.push_back(i_End);
+		pool.elapsed.push_back(instant ? 1.0f : 0.0f);
+		pool.invDuration.push_back(instant ? 1.0f : 1.0f / i_Duration);
+		pool.percent.push_back(0);
+		pool.value.push_back(i_Start);
+		pool.handles.push_back(handle);
+		return handle;
+	}
+
+	bool TweenSystem::Stop(Handle i_Handle)
+	{
+		const Slot* pSlot = Find(i_Handle);
+		if (pSlot == nullptr)
+		{
+			return false;
+		}
+		Remove(static_cast<Curve>(pSlot->curve), pSlot->index);
+		return true;
+	}
+
+	void TweenSystem::Clear()
+	{
+		for (size_t c = 0; c < CurveCount; c++)
+		{
+			Pool& pool = m_Pools[c];
+			while (!pool.handles.empty())
+			{
+				Remove(static_cast<Curve>(c), pool.handles.size() - 1);
+			}
+		}
+		m_Completed.clear();
+	}
+
+	void TweenSystem::Update(float i_DeltaTime)
+	{
+		m_Completed.clear();
+
+		for (size_t c = 0; c < CurveCount; c++)
+		{
+			Pool& pool = m_Pools[c];
+			const size_t count = pool.handles.size();
+			if (count == 0)
+			{
+				continue;
+			}
+
+			// Advance every timer. No branches, so the compiler can vectorize this.
+			float* elapsed = pool.elapsed.data();
+			const float* invDuration = pool.invDuration.data();
+			float* percent = pool.percent.data();
+			for (size_t i = 0; i < count; i++)
+			{
+				elapsed[i] += i_DeltaTime;
+				const float p = elapsed[i] * invDuration[i];
+				percent[i] = p < 1.0f ? p : 1.0f;
+			}
+
+			Ease(static_cast<Curve>(c), pool);
+
+			// Pull out the finished tweens. Going backwards means the tween moved into a removed slot has already been checked.
+			for (size_t i = count; i-- > 0;)
+			{
+				if (percent[i] >= 1.0f)
+				{
+					Completion completion;
+					completion.handle = pool.handles[i];
+					completion.value = pool.end[i];
+					m_Completed.push_back(completion);
+					Remove(static_cast<Curve>(c), i);
+				}
+			}
+		}
+	}
+
+	bool TweenSystem::Value(Handle i_Handle, float& o_Value) const
+	{
+		const Slot* pSlot = Find(i_Handle);
+		if (pSlot == nullptr)
+		{
+			return false;
+		}
+		o_Value = m_Pools[pSlot->curve].value[pSlot->index];
+		return true;
+	}
+
+	bool TweenSystem::Running(Handle i_Handle) const
+	{
+		return Find(i_Handle) != nullptr;
+	}
+
+	size_t TweenSystem::Count() const
+	{
+		size_t count = 0;
+		for (size_t c = 0; c < CurveCount; c++)
+		{
+			count += m_Pools[c].handles.size();
+		}
+		return count;
+	}
+
+	const TweenSystem::Slot* TweenSystem::Find(Handle i_Handle) const
+	{
+		const size_t slotIndex = static_cast<size_t>(i_Handle & 0xFFFFFFFF);
+		if (slotIndex == 0 || slotIndex > m_Slots.size())
+		{
+			return nullptr;
+		}
+
+		const Slot& slot = m_Slots[slotIndex - 1];
+		if (slot.curve >= CurveCount || slot.generation != static_cast<uint32_t>(i_Handle >> 32))
+		{
+			return nullptr;
+		}
+		return &slot;
+	}
+
+	void TweenSystem::Remove(Curve i_Curve, size_t i_Index)
+	{
+		Pool& pool = m_Pools[i_Curve];
+		const uint32_t slotIndex = static_cast<uint32_t>((pool.handles[i_Index] & 0xFFFFFFFF) - 1);
+
+		// Move the last tween into the empty spot so the arrays stay packed
+		const size_t last = pool.handles.size() - 1;
+		if (i_Index != last)
+		{
+			pool.start[i_Index] = pool.start[last];
+			pool.end[i_Index] = pool.end[last];
+			pool.elapsed[i_Index] = pool.elapsed[last];
+			pool.invDuration[i_Index] = pool.invDuration[last];
+			pool.percent[i_Index] = pool.percent[last];
+			pool.value[i_Index] = pool.value[last];
+			pool.handles[i_Index] = pool.handles[last];
+			m_Slots[(pool.handles[i_Index] & 0xFFFFFFFF) - 1].index = i_Index;
+		}
+		pool.start.pop_back();
+		pool.end.pop_back();
+		pool.elapsed.pop_back();
+		pool.invDuration.pop_back();
+		pool.percent.pop_back();
+		pool.value.pop_back();
+		pool.handles.pop_back();
+
+		// A new generation makes every handle to the old tween stale
+		Slot& slot = m_Slots[slotIndex];
+		slot.curve = CurveCount;
+		slot.generation++;
+		m_FreeSlots.push_back(slotIndex);
+	}
+
+	void TweenSystem::Ease(Curve i_Curve, Pool& io_Pool)
+	{
+		const float* start = io_Pool.start.data();
+		const float* end = io_Pool.end.data();
+		const float* percent = io_Pool.percent.data();
+		float* value = io_Pool.value.data();
+		const size_t count = io_Pool.handles.size();
+
+		switch (i_Curve)
+		{
+		case Linear:
+			for (size_t i = 0; i < count; i++)
+			{
+				value[i] = start[i] + (end[i] - start[i]) * percent[i];
+			}
+			break;
+		case InSin: Batch::EaseInSin(start, end, percent, value, count); break;
+		case OutSin: Batch::EaseOutSin(start, end, percent, value, count); break;
+		case InOutSin: Batch::EaseInOutSin(start, end, percent, value, count); break;
+		case InCirc: Batch::EaseInCirc(start, end, percent, value, count); break;
+		case OutCirc: Batch::EaseOutCirc(start, end, percent, value, count); break;
+		case InOutCirc: Batch::EaseInOutCirc(start, end, percent, value, count); break;
+		case InQuad: Batch::EaseInQuad(start, end, percent, value, count); break;
+		case OutQuad: Batch::EaseOutQuad(start, end, percent, value, count); break;
+		case InOutQuad: Batch::EaseInOutQuad(start, end, percent, value, count); break;
+		default: break;
+		}
+	}
+}
@@ -0,0 +1,108 @@
+/*
+The TweenSystem runs many interpolations at once. Each tween moves a value from a start to an end over a duration along one easing curve.
+Instead of every object keeping its own start, end and timer and calling Lerp or an Ease function itself,
+tweens are started here and the whole set is advanced once per frame with Update.
+
+Tweens are stored in one pool per curve, and each pool keeps its values in separate contiguous arrays (structure of arrays).
+Update advances every timer in a pool with one simple loop and then eases the whole pool with one call into BatchEasing.h,
+so each curve runs as a single tight loop that can use SIMD.
+
+A tween is referred to with a Handle. Handles stay valid while their tween moves around inside its pool,
+and go stale once the tween completes or is stopped, even if the slot is later reused by another tween.
+Tweens that finish during an Update are listed in Completed until the next Update.
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace Math
+{
+	class TweenSystem
+	{
+	public:
+		// The curve a tween follows. Linear uses Lerp, the rest use the Ease function of the same name.
+		enum Curve
+		{
+			Linear,
+			InSin,
+			OutSin,
+			InOutSin,
+			InCirc,
+			OutCirc,
+			InOutCirc,
+			InQuad,
+			OutQuad,
+			InOutQuad,
+			CurveCount,
+		};
+
+		// Refers to a tween. 0 never refers to a tween.
+		typedef uint64_t Handle;
+		static const Handle InvalidHandle = 0;
+
+		// A tween that finished during the last Update, and the end value it finished at (exactly its end, whatever the curve).
+		struct Completion
+		{
+			Handle handle;
+			float value;
+		};
+
+		TweenSystem();
+
+		// Starts a tween from start to end that takes duration seconds. A duration of 0 or less completes on the next Update.
+		Handle Start(Curve i_Curve, float i_Start, float i_End, float i_Duration);
+		// Stops a tween without listing it in Completed. Returns false if the handle is stale.
+		bool Stop(Handle i_Handle);
+		// Stops every tween.
+		void Clear();
+
+		// Advances every tween by i_DeltaTime seconds and eases its value. Completed is replaced with the tweens that finished.
+		void Update(float i_DeltaTime);
+
+		// Gets the value of a tween as of the last Update (its start value before the first one). Returns false if the handle is stale.
+		bool Value(Handle i_Handle, float& o_Value) const;
+		// Is this handle still referring to a running tween?
+		bool Running(Handle i_Handle) const;
+
+		// Getters
+		const std::vector<Completion>& Completed() const { return m_Completed; }
+		size_t Count() const;
+		size_t Count(Curve i_Curve) const { return m_Pools[i_Curve].handles.size(); }
+
+	private:
+		// Every tween following one curve. Index i of each array belongs to the same tween.
+		struct Pool
+		{
+			std::vector<float> start;
+			std::vector<float> end;
+			std::vector<float> elapsed;
+			std::vector<float> invDuration; // 1 / duration, so the percent is a multiply.
+			std::vector<float> percent; // Worked out by Update, then passed to the easing function.
+			std::vector<float> value;
+			std::vector<Handle> handles;
+		};
+
+		// Where a handle's tween is. Slots are reused, and the generation tells a reused slot apart from the old handle.
+		struct Slot
+		{
+			uint32_t generation;
+			uint32_t curve; // CurveCount when the slot is free.
+			size_t index;
+		};
+
+		// Finds the slot a handle refers to. Returns NULL if the handle is stale.
+		const Slot* Find(Handle i_Handle) const;
+		// Removes the tween at index from its pool by moving the pool's last tween into its place, and frees its slot.
+		void Remove(Curve i_Curve, size_t i_Index);
+		// Eases every percent in the pool into its value.
+		static void Ease(Curve i_Curve, Pool& io_Pool);
+
+		Pool m_Pools[CurveCount];
+		std::vector<Slot> m_Slots;
+		std::vector<uint32_t> m_FreeSlots; // Slots that can be reused.
+		std::vector<Completion> m_Completed;
+	};
+}
@@ -3,7 +3,7 @@ Author: Ryan Kirschman
 Date: 4/15/2015
 
 This is the source file for the Vector3 class. 
-I use it to define CalculateLength, as that needs the squareroot function found in math.h.
+I use it to define Length, as that needs the squareroot function found in math.h.
 This keeps math.h out of being included into Vector3.h
 I also define my static unit vectors here.
 */
@@ -20,9 +20,9 @@ namespace Math
 	const Vector3 Vector3::Up		=	Vector3(0, 1, 0);
 	const Vector3 Vector3::Forward	=	Vector3(0, 0, 1);
 
-	void Vector3::CalculateLength()
+	float Vector3::Length() const
 	{
-		_length = sqrtf((_x * _x) + (_y * _y) + (_z * _z));
+		return sqrtf(LengthSqr());
 	}
 
 	// Interpolation
@@ -3,7 +3,9 @@ Author: Ryan Kirschman
 Date: 4/15/2015
 
 This is the header for the Vector3 class.
-The Vector3 class stores 3 values for x, y, and z, as well as the length of the mathematical vector.
+The Vector3 class stores 3 values for x, y, and z.
+The length is not stored. It is worked out when it is asked for, so plain arithmetic never pays for a square root.
+Use LengthSqr when comparing lengths, as it doesn't need a square root at all.
 Two vectors can be added together and subtracted. You may perform the Dot Product as well as Cross Product.
 A Vector3 can be multiplied or divided by a float to be scaled.
 */
@@ -21,19 +23,20 @@ namespace Math {
 		//constructors
 		Vector3();
 		Vector3(float i_x, float i_y, float i_z);
-		Vector3(const Vector3 &otherVec);
+		Vector3(const Vector3 &otherVec) = default;
 
 		//destructor
-		~Vector3();
+		~Vector3() = default;
 
 		// Getters
-		inline float X() const, Y() const, Z() const, Length() const, LengthSqr() const;
+		inline float X() const, Y() const, Z() const, LengthSqr() const;
+		float Length() const;
 
 		//Setters
 		inline void X(const float x), Y(const float y), Z(const float z);
 
 		// Normalizers
-		inline Vector3 CreateNormalized();
+		inline Vector3 CreateNormalized() const;
 		inline void Normalize();
 
 		// Operators
@@ -65,11 +68,10 @@ namespace Math {
 		friend Vector3 Lerp(const Vector3& start, const Vector3& end, float percent);
 
 	private:
-		//Sets the Length. Only called internally
-		void CalculateLength();
-
 		//variables
-		float _x, _y, _z, _length;
+		float _x, _y, _z;
 	};
 
-} //namespace Math
\ No newline at end of file
+} //namespace Math
+
+#include "Vector3.inl"
\ No newline at end of file
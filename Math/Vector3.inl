@@ -5,31 +5,19 @@ Date: 4/15/2015
 An inline file used to define my inline functions for the Vector3 class.
 */
 
-#include "Vector3.h"
-
 namespace Math
 {
 	// Constructors
-	Vector3::Vector3() :
+	inline Vector3::Vector3() :
 		_x(0),
 		_y(0),
-		_z(0),
-		_length(0)
+		_z(0)
 	{
 	}
-	Vector3::Vector3(float x, float y, float z) :
+	inline Vector3::Vector3(float x, float y, float z) :
 		_x(x),
 		_y(y),
 		_z(z)
-	{
-		CalculateLength();
-	}
-
-	Vector3::Vector3(const Vector3 &i_Vector) :
-		_x(i_Vector._x),
-		_y(i_Vector._y),
-		_z(i_Vector._z),
-		_length(i_Vector._length)
 	{
 	}
 
@@ -37,34 +25,27 @@ namespace Math
 	inline float Vector3::X() const { return _x; }
 	inline float Vector3::Y() const { return _y; }
 	inline float Vector3::Z() const { return _z; }
-	inline float Vector3::Length() const
-	{
-		return _length;
-	}
 	inline float Vector3::LengthSqr() const
 	{
-		return _length * _length;
+		return (_x * _x) + (_y * _y) + (_z * _z);
 	}
 
 	//Setters
 	inline void Vector3::X(const float x)
 	{
 		_x = x;
-		CalculateLength();
 	}
 	inline void Vector3::Y(const float y)
 	{
 		_y = y;
-		CalculateLength();
 	}
 	inline void Vector3::Z(const float z)
 	{
 		_z = z;
-		CalculateLength();
 	}
 
 	// Normalizers
-	inline Vector3 Vector3::CreateNormalized()
+	inline Vector3 Vector3::CreateNormalized() const
 	{
 		return *this / this->Length();
 	}
@@ -84,7 +65,6 @@ namespace Math
 		_x += rhs._x;
 		_y += rhs._y;
 		_z += rhs._z;
-		CalculateLength();
 		return *this;
 	}
 
@@ -98,7 +78,6 @@ namespace Math
 		_x -= rhs._x;
 		_y -= rhs._y;
 		_z -= rhs._z;
-		CalculateLength();
 		return *this;
 	}
 
@@ -112,12 +91,11 @@ namespace Math
 		_x *= rhs;
 		_y *= rhs;
 		_z *= rhs;
-		CalculateLength();
 		return *this;
 	}
 	inline Vector3 operator *(const float lhs, const Vector3& rhs)
 	{
-		return lhs * rhs;
+		return rhs * lhs;
 	}
 
 	// Division
@@ -0,0 +1,74 @@
+/*
+An Arena is one contiguous region of memory reserved straight from the OS instead of from malloc.
+Nothing in it is committed until it is first touched, so a large pool only costs memory for the part that is used.
+
+It can ask for huge pages (2 MiB on x64) so a large pool is covered by far fewer TLB entries.
+Explicit huge pages (MAP_HUGETLB, or MEM_LARGE_PAGES on Windows) are tried first. If the system has none to give,
+the arena falls back to normal pages, and on Linux asks for transparent huge pages instead.
+HugePages() tells you which one you got.
+
+It can also bind its memory to one NUMA node so the threads using it don't read across sockets.
+Binding is a request, not a promise. NumaBound() tells you if the OS accepted it.
+*/
+
+#pragma once
+
+#include <stddef.h>
+
+namespace Memory
+{
+	class Arena
+	{
+	public:
+		// The huge page size we ask for.
+		static const size_t HugePageSize = static_cast<size_t>(2) << 20;
+
+		// How the arena's memory should be backed.
+		struct Options
+		{
+			bool hugePages; // Try to back the arena with huge pages.
+			int numaNode; // The NUMA node to bind the memory to, or -1 to let the OS decide.
+			bool commitNow; // Commit every page up front instead of on first touch.
+
+			Options() : hugePages(false), numaNode(-1), commitNow(false) {}
+		};
+
+		// Which kind of pages back the arena.
+		enum PageKind
+		{
+			SmallPages, // Normal 4 KiB pages.
+			TransparentHugePages, // Normal pages the OS has been asked to merge into huge pages.
+			ExplicitHugePages, // Reserved huge pages.
+		};
+
+		// Static failsafe constructor. Will return NULL if the memory couldn't be reserved at all.
+		// Size is rounded up to a whole number of pages.
+		static Arena* Create(size_t size, const Options& options = Options());
+
+		// Gives the memory back to the OS.
+		~Arena();
+
+		// Getters
+		void* Base() const { return _pBase; }
+		size_t Size() const { return _Size; }
+		PageKind HugePages() const { return _PageKind; }
+		bool NumaBound() const { return _NumaBound; }
+
+	private:
+		Arena(void* pBase, size_t size, PageKind pageKind, bool numaBound);
+
+		static bool BindToNode(void* pBase, size_t size, int numaNode);
+
+		void* _pBase; // The start of the arena.
+		size_t _Size; // How large is the arena?
+		PageKind _PageKind; // Which kind of pages we got.
+		bool _NumaBound; // Did the OS accept the NUMA binding?
+
+		// Make sure nobody tries to copy
+		Arena(const Arena&) = delete;
+		Arena& operator=(const Arena&) = delete;
+	};
+
+} // End namespace Memory
+
+#include "Arena.inl"
@@ -0,0 +1,184 @@
+/*
+An inline file used to define my inline functions for the Arena
+*/
+
+#include <new>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+#endif
+
+namespace Memory
+{
+	inline Arena* Arena::Create(size_t size, const Options& options)
+	{
+		if (size == 0)
+			return nullptr;
+
+		void* pBase = nullptr;
+		PageKind pageKind = SmallPages;
+
+#if defined(_WIN32)
+		// Large pages need SeLockMemoryPrivilege and are always committed, so they are only a first try
+		if (options.hugePages)
+		{
+			const size_t largePageSize = GetLargePageMinimum();
+			if (largePageSize != 0)
+			{
+				const size_t largeSize = (size + largePageSize - 1) & ~(largePageSize - 1);
+				pBase = options.numaNode >= 0 ?
+					VirtualAllocExNuma(GetCurrentProcess(), nullptr, largeSize, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE, static_cast<DWORD>(options.numaNode)) :
+					VirtualAlloc(nullptr, largeSize, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+				if (pBase != nullptr)
+				{
+					size = largeSize;
+					pageKind = ExplicitHugePages;
+				}
+			}
+		}
+
+		if (pBase == nullptr)
+		{
+			// Committed pages still don't use physical memory until they are touched
+			pBase = options.numaNode >= 0 ?
+				VirtualAllocExNuma(GetCurrentProcess(), nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE, static_cast<DWORD>(options.numaNode)) :
+				VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+			if (pBase == nullptr)
+				return nullptr;
+		}
+
+		const bool numaBound = options.numaNode >= 0;
+#else
+		const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+		size = (size + pageSize - 1) & ~(pageSize - 1);
+
+#if defined(MAP_HUGETLB)
+		if (options.hugePages)
+		{
+			// Only works if the system has reserved huge pages (vm.nr_hugepages), so this fails quietly on most machines.
+			// No MAP_NORESERVE here, so running out of huge pages fails now instead of with SIGBUS on first touch.
+			const size_t hugeSize = (size + HugePageSize - 1) & ~(HugePageSize - 1);
+			void* pHuge = mmap(nullptr, hugeSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+			if (pHuge != MAP_FAILED)
+			{
+				pBase = pHuge;
+				size = hugeSize;
+				pageKind = ExplicitHugePages;
+			}
+		}
+#endif
+
+		if (pBase == nullptr)
+		{
+			if (options.hugePages)
+			{
+				// Transparent huge pages only cover whole, aligned 2 MiB ranges, so align the arena to one
+				size = (size + HugePageSize - 1) & ~(HugePageSize - 1);
+				const size_t mappedSize = size + HugePageSize;
+				void* pMapped = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+				if (pMapped == MAP_FAILED)
+					return nullptr;
+
+				const uintptr_t mapped = reinterpret_cast<uintptr_t>(pMapped);
+				const uintptr_t aligned = (mapped + HugePageSize - 1) & ~static_cast<uintptr_t>(HugePageSize - 1);
+				if (aligned > mapped)
+				{
+					munmap(pMapped, aligned - mapped);
+				}
+				if (mapped + mappedSize > aligned + size)
+				{
+					munmap(reinterpret_cast<void*>(aligned + size), (mapped + mappedSize) - (aligned + size));
+				}
+				pBase = reinterpret_cast<void*>(aligned);
+
+#if defined(MADV_HUGEPAGE)
+				if (madvise(pBase, size, MADV_HUGEPAGE) == 0)
+				{
+					pageKind = TransparentHugePages;
+				}
+#endif
+			}
+			else
+			{
+				pBase = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+				if (pBase == MAP_FAILED)
+					return nullptr;
+			}
+		}
+
+		// The binding has to happen before any page is touched, since pages are placed when they are first committed
+		const bool numaBound = options.numaNode >= 0 && BindToNode(pBase, size, options.numaNode);
+#endif
+
+		if (options.commitNow)
+		{
+			// Touching every page commits it now instead of during the first pass over the pool
+#if defined(_WIN32)
+			const size_t touchStep = 4096;
+#else
+			const size_t touchStep = pageSize;
+#endif
+			for (size_t offset = 0; offset < size; offset += touchStep)
+			{
+				reinterpret_cast<volatile char*>(pBase)[offset] = 0;
+			}
+		}
+
+		Arena* pArena = new (std::nothrow) Arena(pBase, size, pageKind, numaBound);
+		if (pArena == nullptr)
+		{
+#if defined(_WIN32)
+			VirtualFree(pBase, 0, MEM_RELEASE);
+#else
+			munmap(pBase, size);
+#endif
+		}
+		return pArena;
+	}
+
+	inline Arena::Arena(void* pBase, size_t size, PageKind pageKind, bool numaBound) :
+		_pBase(pBase),
+		_Size(size),
+		_PageKind(pageKind),
+		_NumaBound(numaBound)
+	{}
+
+	inline Arena::~Arena()
+	{
+#if defined(_WIN32)
+		VirtualFree(_pBase, 0, MEM_RELEASE);
+#else
+		munmap(_pBase, _Size);
+#endif
+	}
+
+	inline bool Arena::BindToNode(void* pBase, size_t size, int numaNode)
+	{
+#if defined(__linux__) && defined(SYS_mbind)
+		// Call mbind directly so we don't need libnuma. 2 is MPOL_BIND.
+		const int bindPolicy = 2;
+		const size_t bitsPerLong = sizeof(unsigned long) * 8;
+		if (numaNode < 0 || numaNode >= static_cast<int>(bitsPerLong * 16 - 1))
+			return false;
+
+		unsigned long nodeMask[16];
+		memset(nodeMask, 0, sizeof(nodeMask));
+		nodeMask[numaNode / bitsPerLong] = 1ul << (numaNode % bitsPerLong);
+		return syscall(SYS_mbind, pBase, size, bindPolicy, nodeMask, bitsPerLong * 16, 0) == 0;
+#else
+		(void)pBase;
+		(void)size;
+		(void)numaNode;
+		return false;
+#endif
+	}
+
+} // End namespace Memory
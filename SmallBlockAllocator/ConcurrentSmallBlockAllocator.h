@@ -0,0 +1,74 @@
+/*
+The Concurrent Small Block Allocator is a Small Block Allocator that many threads can use at once without a lock.
+It keeps track of which blocks are in use the same way, with one bit per block,
+but the words of bits are atomic and a block is claimed with a compare and swap on its word.
+If two threads try to claim a bit in the same word at once, one of them simply tries again.
+
+The number of free blocks is an atomic counter. Alloc reserves a block from the counter before it searches,
+so it only searches when it knows there is a free block to find, and returns NULL right away when there isn't.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace Memory
+{
+
+	class ConcurrentSmallBlockAllocator
+	{
+	public:
+		// A failsafe constructor.
+		// BlockSize is how large each block is. BlockCount is how many blocks.
+		static ConcurrentSmallBlockAllocator* Create(size_t blockSize, size_t blockCount);
+
+		~ConcurrentSmallBlockAllocator();
+
+		// Allocate to a block and Free from a Block. Safe to call from any thread.
+		void* Alloc(size_t size);
+		void Free(void* ptr);
+
+		// Allocate and Free many blocks at once. Bits are claimed and released a whole word at a time.
+		// AllocBatch fills o_ptrs with up to count blocks and returns how many it got.
+		size_t AllocBatch(size_t count, void** o_ptrs);
+		void FreeBatch(void* const* ptrs, size_t count);
+
+		// Is the block that contains this pointer being used? Returns true if it does contain the ptr and is set.
+		bool Contains(void* ptr) const;
+
+		// How many blocks are free? Other threads may change this as soon as it is read.
+		size_t BlocksFree() const;
+
+		// Does one of our blocks start at ptr? Unlike Contains, this only reads values that never change,
+		// so it never touches memory other threads are writing to.
+		bool IsBlock(const void* ptr) const;
+
+		// Getters
+		size_t BlockSize() const { return _BlockSize; }
+
+	private:
+		ConcurrentSmallBlockAllocator(size_t blockSize, size_t blockCount, void* pBlock, std::atomic<uint64_t>* pWords);
+
+		// Takes up to count blocks from _FreeBlocks. Returns how many were reserved.
+		size_t Reserve(size_t count);
+		// Claims a free bit. There must be one, which Alloc makes sure of by reserving it from _FreeBlocks first.
+		size_t ClaimBit();
+		// Finds the block index of ptr. Returns false if ptr isn't in our blocks.
+		bool IndexOf(const void* ptr, size_t& o_index) const;
+
+		size_t _BlockSize; // How large is each block?
+		size_t _BlockCount; // How many blocks?
+		size_t _WordCount; // How many words of bits?
+		void* _pBlock; // Where are the blocks located?
+		std::atomic<uint64_t>* _pWords; // One bit per block. A set bit is a block in use.
+
+		// These change on every Alloc and Free, so keep them on their own cache lines away from the values above.
+		alignas(64) std::atomic<size_t> _FreeBlocks; // How many blocks haven't been claimed or reserved.
+		alignas(64) std::atomic<size_t> _SearchStart; // The word the next search starts at.
+	};
+
+} // End namespace Memory
+
+#include "ConcurrentSmallBlockAllocator.inl"
@@ -0,0 +1,223 @@
+/*
+An inline file used to define my inline functions for the ConcurrentSmallBlockAllocator
+*/
+
+#include <new>
+#include <stdlib.h>
+
+#include "../Bitfield/BitOps.h"
+
+namespace Memory
+{
+	inline ConcurrentSmallBlockAllocator* ConcurrentSmallBlockAllocator::Create(size_t blockSize, size_t blockCount)
+	{
+		char* pBlock = reinterpret_cast<char *>(malloc(blockSize * blockCount));
+		if (pBlock == nullptr)
+			return nullptr;
+
+		const size_t wordCount = (blockCount + BitOps::BitsPerWord - 1) / BitOps::BitsPerWord;
+		std::atomic<uint64_t>* pWords = new (std::nothrow) std::atomic<uint64_t>[wordCount > 0 ? wordCount : 1];
+		if (pWords == nullptr)
+		{
+			free(pBlock);
+			return nullptr;
+		}
+
+		// Bits past the last block are marked as used so they can never be claimed
+		for (size_t i = 0; i < wordCount; i++)
+		{
+			pWords[i].store(0, std::memory_order_relaxed);
+		}
+		if (blockCount % BitOps::BitsPerWord != 0)
+		{
+			pWords[wordCount - 1].store(~BitOps::LowMask(blockCount % BitOps::BitsPerWord), std::memory_order_relaxed);
+		}
+
+		ConcurrentSmallBlockAllocator* pAllocator = new (std::nothrow) ConcurrentSmallBlockAllocator(blockSize, blockCount, pBlock, pWords);
+		if (pAllocator == nullptr)
+		{
+			delete[] pWords;
+			free(pBlock);
+			return nullptr;
+		}
+		return pAllocator;
+	}
+
+	inline ConcurrentSmallBlockAllocator::~ConcurrentSmallBlockAllocator()
+	{
+		delete[] _pWords;
+		free(_pBlock);
+	}
+
+	inline void* ConcurrentSmallBlockAllocator::Alloc(size_t size) {
+		if (size > _BlockSize) {
+			return nullptr;
+		}
+
+		// Reserve a block first. Once we have, there is a bit out there for us even if other threads get to some bits first.
+		if (Reserve(1) == 0) {
+			return nullptr;
+		}
+
+		const size_t index = ClaimBit();
+		return reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(_pBlock) + (index * _BlockSize));
+	}
+
+	inline size_t ConcurrentSmallBlockAllocator::AllocBatch(size_t count, void** o_ptrs) {
+		const size_t reserved = Reserve(count);
+
+		size_t claimed = 0;
+		size_t word = _SearchStart.load(std::memory_order_relaxed);
+		if (word >= _WordCount) {
+			word = 0;
+		}
+		while (claimed < reserved) {
+			uint64_t bits = _pWords[word].load(std::memory_order_relaxed);
+			while (bits != BitOps::AllSet) {
+				// Take as many of the free bits in this word as we still need, lowest first
+				uint64_t want = 0;
+				uint64_t freeBits = ~bits;
+				size_t wanted = 0;
+				while (freeBits != 0 && claimed + wanted < reserved) {
+					want |= freeBits & (~freeBits + 1);
+					freeBits &= freeBits - 1;
+					wanted++;
+				}
+
+				if (_pWords[word].compare_exchange_weak(bits, bits | want, std::memory_order_acquire, std::memory_order_relaxed)) {
+					while (want != 0) {
+						const size_t index = word * BitOps::BitsPerWord + BitOps::CountTrailingZeros(want);
+						o_ptrs[claimed++] = reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(_pBlock) + (index * _BlockSize));
+						want &= want - 1;
+					}
+					break;
+				}
+			}
+
+			// Either we have everything we need or this word is full now
+			if (claimed < reserved && ++word == _WordCount) {
+				word = 0;
+			}
+		}
+		_SearchStart.store(word, std::memory_order_relaxed);
+
+		return reserved;
+	}
+
+	inline size_t ConcurrentSmallBlockAllocator::Reserve(size_t count) {
+		size_t freeBlocks = _FreeBlocks.load(std::memory_order_relaxed);
+		size_t reserved;
+		do {
+			reserved = freeBlocks < count ? freeBlocks : count;
+			if (reserved == 0) {
+				return 0;
+			}
+		} while (!_FreeBlocks.compare_exchange_weak(freeBlocks, freeBlocks - reserved, std::memory_order_acquire, std::memory_order_relaxed));
+		return reserved;
+	}
+
+	inline size_t ConcurrentSmallBlockAllocator::ClaimBit() {
+		size_t word = _SearchStart.load(std::memory_order_relaxed);
+		if (word >= _WordCount) {
+			word = 0;
+		}
+
+		for (;;) {
+			uint64_t bits = _pWords[word].load(std::memory_order_relaxed);
+			while (bits != BitOps::AllSet) {
+				const uint64_t mask = static_cast<uint64_t>(1) << BitOps::CountTrailingZeros(~bits);
+				// If another thread changed the word first, bits is reloaded and we try again
+				if (_pWords[word].compare_exchange_weak(bits, bits | mask, std::memory_order_acquire, std::memory_order_relaxed)) {
+					_SearchStart.store(word, std::memory_order_relaxed);
+					return word * BitOps::BitsPerWord + BitOps::CountTrailingZeros(mask);
+				}
+			}
+
+			// This word is full, try the next one
+			if (++word == _WordCount) {
+				word = 0;
+			}
+		}
+	}
+
+	inline void ConcurrentSmallBlockAllocator::Free(void* ptr) {
+		size_t index;
+		if (!IndexOf(ptr, index)) {
+			return;
+		}
+
+		// Only give the block back if it was in use, so freeing twice doesn't count it twice
+		const uint64_t mask = static_cast<uint64_t>(1) << (index % BitOps::BitsPerWord);
+		const uint64_t before = _pWords[index / BitOps::BitsPerWord].fetch_and(~mask, std::memory_order_release);
+		if (before & mask) {
+			_FreeBlocks.fetch_add(1, std::memory_order_release);
+		}
+	}
+
+	inline void ConcurrentSmallBlockAllocator::FreeBatch(void* const* ptrs, size_t count) {
+		size_t released = 0;
+		size_t word = 0;
+		uint64_t mask = 0;
+
+		// Blocks next to each other usually share a word, so clear them together with one atomic operation
+		for (size_t i = 0; i <= count; i++) {
+			size_t index = 0;
+			const bool valid = i < count && IndexOf(ptrs[i], index);
+			if (valid && mask != 0 && index / BitOps::BitsPerWord == word) {
+				mask |= static_cast<uint64_t>(1) << (index % BitOps::BitsPerWord);
+				continue;
+			}
+
+			if (mask != 0) {
+				// Only count the bits that were actually in use, so freeing twice doesn't count twice
+				const uint64_t before = _pWords[word].fetch_and(~mask, std::memory_order_release);
+				released += BitOps::PopCount(before & mask);
+				mask = 0;
+			}
+			if (valid) {
+				word = index / BitOps::BitsPerWord;
+				mask = static_cast<uint64_t>(1) << (index % BitOps::BitsPerWord);
+			}
+		}
+
+		if (released > 0) {
+			_FreeBlocks.fetch_add(released, std::memory_order_release);
+		}
+	}
+
+	inline bool ConcurrentSmallBlockAllocator::IndexOf(const void* ptr, size_t& o_index) const {
+		if (reinterpret_cast<uintptr_t>(ptr) < reinterpret_cast<uintptr_t>(_pBlock)) {
+			return false;
+		}
+		o_index = (reinterpret_cast<uintptr_t>(ptr) - reinterpret_cast<uintptr_t>(_pBlock)) / _BlockSize;
+		return o_index < _BlockCount;
+	}
+
+	inline bool ConcurrentSmallBlockAllocator::Contains(void* ptr) const {
+		size_t index;
+		if (!IndexOf(ptr, index)) {
+			// If our ptr is not in a block
+			return false;
+		}
+
+		const uint64_t mask = static_cast<uint64_t>(1) << (index % BitOps::BitsPerWord);
+		return (_pWords[index / BitOps::BitsPerWord].load(std::memory_order_acquire) & mask) != 0;
+	}
+
+	inline size_t ConcurrentSmallBlockAllocator::BlocksFree() const { return _FreeBlocks.load(std::memory_order_relaxed); }
+
+	inline bool ConcurrentSmallBlockAllocator::IsBlock(const void* ptr) const {
+		size_t index;
+		return IndexOf(ptr, index) && reinterpret_cast<uintptr_t>(ptr) == reinterpret_cast<uintptr_t>(_pBlock) + index * _BlockSize;
+	}
+
+	inline ConcurrentSmallBlockAllocator::ConcurrentSmallBlockAllocator(size_t blockSize, size_t blockCount, void* pBlock, std::atomic<uint64_t>* pWords) :
+		_BlockSize(blockSize),
+		_BlockCount(blockCount),
+		_WordCount((blockCount + BitOps::BitsPerWord - 1) / BitOps::BitsPerWord),
+		_pBlock(pBlock),
+		_pWords(pWords),
+		_FreeBlocks(blockCount),
+		_SearchStart(0)
+	{}
+}
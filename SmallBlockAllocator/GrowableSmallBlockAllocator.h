@@ -0,0 +1,111 @@
+/*
+The Growable Small Block Allocator works like the Small Block Allocator, but is never full.
+Its blocks live in pages, and each page is a SmallBlockAllocator with its own Bitfield placed inside the page.
+When every page is full a new page is added, and when a page empties it is either kept for later
+or given back to the OS if we already have more empty pages than the high water mark.
+
+Pages are aligned to a multiple of 64 KiB, so Free and Contains find a pointer's page with a PageMap lookup
+instead of searching the pages. Pages that still have free blocks are kept in their own list, so Alloc doesn't search either.
+
+Like the Small Block Allocator it is not thread safe.
+*/
+
+#pragma once
+
+#include <stddef.h>
+
+#include "PageMap.h"
+
+namespace Memory
+{
+	class SmallBlockAllocator;
+
+	class GrowableSmallBlockAllocator
+	{
+	public:
+		// Pages are made of units of this size, aligned to it. 64 KiB is also the allocation granularity on Windows.
+		static const size_t PageUnitShift = 16;
+		static const size_t PageUnitSize = static_cast<size_t>(1) << PageUnitShift;
+
+		// A failsafe constructor. Will return NULL if no memory is available.
+		// BlockSize is how large each block is. BlocksPerPage is the least number of blocks in each page, which is rounded up to fill the page.
+		// MaxEmptyPages is how many empty pages are kept before they are given back to the OS.
+		static GrowableSmallBlockAllocator* Create(size_t blockSize, size_t blocksPerPage, size_t maxEmptyPages = 1);
+
+		~GrowableSmallBlockAllocator();
+
+		// Allocate to a block and Free from a Block.
+		// Alloc only returns NULL if size is bigger than the block size or a new page couldn't be made.
+		void* Alloc(size_t size);
+		void Free(void* ptr);
+
+		// Is the block that contains this pointer being used? Returns true if it does contain the ptr and is set.
+		bool Contains(void* ptr) const;
+
+		// Getters
+		size_t BlocksFree() const { return _BlocksFree; }
+		size_t BlockSize() const { return _BlockSize; }
+		size_t BlocksPerPage() const { return _BlocksPerPage; }
+		size_t PageSize() const { return _PageSize; }
+		size_t PageCount() const { return _PageCount; }
+		size_t EmptyPages() const { return _EmptyPages; }
+
+		// Setters
+		// Gives back empty pages right away if there are now too many.
+		void MaxEmptyPages(size_t maxEmptyPages);
+
+	private:
+		// Sits at the start of every page. The page's allocator is placed right after it.
+		struct Page
+		{
+			SmallBlockAllocator* pAllocator;
+			Page* pPrev; // The pages in the same list.
+			Page* pNext;
+		};
+
+		// Pages are kept in one of two lists, depending on if they have a free block.
+		struct PageList
+		{
+			Page* pHead;
+
+			void PushFront(Page* pPage);
+			void Remove(Page* pPage);
+		};
+
+		typedef PageMap<PageUnitShift> BlockPageMap;
+
+		GrowableSmallBlockAllocator(size_t blockSize, size_t blocksPerPage, size_t pageSize, size_t maxEmptyPages, BlockPageMap* pPageMap);
+
+		// Makes a new empty page and adds it to the available list. Returns NULL if no memory is available.
+		Page* AddPage();
+		// Gives a page back to the OS. It must already be out of its list.
+		void ReleasePage(Page* pPage);
+		// Gives back empty pages until there are no more than _MaxEmptyPages.
+		void TrimEmptyPages();
+
+		inline Page* PageOf(const void* ptr) const;
+
+		static void* AllocPageMemory(size_t size);
+		static void FreePageMemory(void* pMemory, size_t size);
+
+		size_t _BlockSize; // How large is each block?
+		size_t _BlocksPerPage; // How many blocks are in each page?
+		size_t _PageSize; // How large is each page? Always a multiple of PageUnitSize.
+		size_t _MaxEmptyPages; // How many empty pages do we keep?
+
+		size_t _PageCount;
+		size_t _EmptyPages;
+		size_t _BlocksFree;
+
+		PageList _Available; // Pages with at least one free block.
+		PageList _Full; // Pages with no free blocks.
+		BlockPageMap* _pPageMap; // Which page each page unit belongs to.
+
+		// Make sure nobody tries to copy
+		GrowableSmallBlockAllocator(const GrowableSmallBlockAllocator&) = delete;
+		GrowableSmallBlockAllocator& operator=(const GrowableSmallBlockAllocator&) = delete;
+	};
+
+} // End namespace Memory
+
+#include "GrowableSmallBlockAllocator.inl"
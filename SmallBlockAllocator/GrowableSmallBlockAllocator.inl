@@ -0,0 +1,275 @@
+/*
+An inline file used to define my inline functions for the GrowableSmallBlockAllocator
+*/
+
+#include <new>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "SmallBlockAllocator.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+namespace Memory
+{
+	inline GrowableSmallBlockAllocator* GrowableSmallBlockAllocator::Create(size_t blockSize, size_t blocksPerPage, size_t maxEmptyPages)
+	{
+		if (blockSize == 0 || blocksPerPage == 0)
+			return nullptr;
+
+		// Round the page up to whole units, then fit as many blocks as the rounded page holds
+		const size_t required = sizeof(Page) + SmallBlockAllocator::MemoryRequired(blockSize, blocksPerPage);
+		const size_t pageSize = (required + PageUnitSize - 1) & ~(PageUnitSize - 1);
+		blocksPerPage = SmallBlockAllocator::BlocksThatFit(blockSize, pageSize - sizeof(Page));
+
+		BlockPageMap* pPageMap = BlockPageMap::Create();
+		if (pPageMap == nullptr)
+			return nullptr;
+
+		GrowableSmallBlockAllocator* pAllocator = new (std::nothrow) GrowableSmallBlockAllocator(blockSize, blocksPerPage, pageSize, maxEmptyPages, pPageMap);
+		if (pAllocator == nullptr)
+		{
+			pPageMap->~BlockPageMap();
+			free(pPageMap);
+		}
+		return pAllocator;
+	}
+
+	inline GrowableSmallBlockAllocator::GrowableSmallBlockAllocator(size_t blockSize, size_t blocksPerPage, size_t pageSize, size_t maxEmptyPages, BlockPageMap* pPageMap) :
+		_BlockSize(blockSize),
+		_BlocksPerPage(blocksPerPage),
+		_PageSize(pageSize),
+		_MaxEmptyPages(maxEmptyPages),
+		_PageCount(0),
+		_EmptyPages(0),
+		_BlocksFree(0),
+		_pPageMap(pPageMap)
+	{
+		_Available.pHead = nullptr;
+		_Full.pHead = nullptr;
+	}
+
+	inline GrowableSmallBlockAllocator::~GrowableSmallBlockAllocator()
+	{
+		PageList* lists[] = { &_Available, &_Full };
+		for (PageList* pList : lists)
+		{
+			while (pList->pHead != nullptr)
+			{
+				Page* pPage = pList->pHead;
+				pList->Remove(pPage);
+				ReleasePage(pPage);
+			}
+		}
+
+		_pPageMap->~BlockPageMap();
+		free(_pPageMap);
+	}
+
+	inline void* GrowableSmallBlockAllocator::Alloc(size_t size)
+	{
+		if (size > _BlockSize)
+			return nullptr;
+
+		Page* pPage = _Available.pHead;
+		if (pPage == nullptr)
+		{
+			pPage = AddPage();
+			if (pPage == nullptr)
+				return nullptr;
+		}
+
+		if (pPage->pAllocator->BlocksFree() == _BlocksPerPage)
+		{
+			_EmptyPages--;
+		}
+
+		void* ptr = pPage->pAllocator->Alloc(size);
+		_BlocksFree--;
+
+		if (pPage->pAllocator->BlocksFree() == 0)
+		{
+			_Available.Remove(pPage);
+			_Full.PushFront(pPage);
+		}
+		return ptr;
+	}
+
+	inline void GrowableSmallBlockAllocator::Free(void* ptr)
+	{
+		if (!Contains(ptr))
+			return;
+
+		Page* pPage = PageOf(ptr);
+		const bool wasFull = pPage->pAllocator->BlocksFree() == 0;
+		pPage->pAllocator->Free(ptr);
+		_BlocksFree++;
+
+		if (wasFull)
+		{
+			_Full.Remove(pPage);
+			_Available.PushFront(pPage);
+		}
+
+		if (pPage->pAllocator->BlocksFree() == _BlocksPerPage)
+		{
+			_EmptyPages++;
+			TrimEmptyPages();
+		}
+	}
+
+	inline bool GrowableSmallBlockAllocator::Contains(void* ptr) const
+	{
+		Page* pPage = PageOf(ptr);
+		return pPage != nullptr && pPage->pAllocator->Contains(ptr);
+	}
+
+	inline void GrowableSmallBlockAllocator::MaxEmptyPages(size_t maxEmptyPages)
+	{
+		_MaxEmptyPages = maxEmptyPages;
+		TrimEmptyPages();
+	}
+
+	inline GrowableSmallBlockAllocator::Page* GrowableSmallBlockAllocator::PageOf(const void* ptr) const
+	{
+		return reinterpret_cast<Page*>(_pPageMap->Get(ptr));
+	}
+
+	inline GrowableSmallBlockAllocator::Page* GrowableSmallBlockAllocator::AddPage()
+	{
+		void* pMemory = AllocPageMemory(_PageSize);
+		if (pMemory == nullptr)
+			return nullptr;
+
+		// The page header goes first, then the allocator, its Bitfield and its blocks fill the rest of the page
+		Page* pPage = new (pMemory) Page;
+		void* pNext = reinterpret_cast<char*>(pMemory) + sizeof(Page);
+		pPage->pAllocator = SmallBlockAllocator::Create(_BlockSize, _BlocksPerPage, pNext);
+
+		// Every unit of the page points back at its header
+		for (size_t offset = 0; offset < _PageSize; offset += PageUnitSize)
+		{
+			if (!_pPageMap->Set(reinterpret_cast<char*>(pMemory) + offset, pPage))
+			{
+				for (size_t undo = 0; undo < offset; undo += PageUnitSize)
+				{
+					_pPageMap->Set(reinterpret_cast<char*>(pMemory) + undo, nullptr);
+				}
+				pPage->pAllocator->~SmallBlockAllocator();
+				FreePageMemory(pMemory, _PageSize);
+				return nullptr;
+			}
+		}
+
+		_Available.PushFront(pPage);
+		_PageCount++;
+		_EmptyPages++;
+		_BlocksFree += _BlocksPerPage;
+		return pPage;
+	}
+
+	inline void GrowableSmallBlockAllocator::ReleasePage(Page* pPage)
+	{
+		for (size_t offset = 0; offset < _PageSize; offset += PageUnitSize)
+		{
+			_pPageMap->Set(reinterpret_cast<char*>(pPage) + offset, nullptr);
+		}
+
+		const size_t blocksFree = pPage->pAllocator->BlocksFree();
+		if (blocksFree == _BlocksPerPage)
+		{
+			_EmptyPages--;
+		}
+		_BlocksFree -= blocksFree;
+		_PageCount--;
+
+		pPage->pAllocator->~SmallBlockAllocator();
+		FreePageMemory(pPage, _PageSize);
+	}
+
+	inline void GrowableSmallBlockAllocator::TrimEmptyPages()
+	{
+		// Empty pages are only ever in the available list
+		Page* pPage = _Available.pHead;
+		while (_EmptyPages > _MaxEmptyPages && pPage != nullptr)
+		{
+			Page* pNext = pPage->pNext;
+			if (pPage->pAllocator->BlocksFree() == _BlocksPerPage)
+			{
+				_Available.Remove(pPage);
+				ReleasePage(pPage);
+			}
+			pPage = pNext;
+		}
+	}
+
+	inline void GrowableSmallBlockAllocator::PageList::PushFront(Page* pPage)
+	{
+		pPage->pPrev = nullptr;
+		pPage->pNext = pHead;
+		if (pHead != nullptr)
+		{
+			pHead->pPrev = pPage;
+		}
+		pHead = pPage;
+	}
+
+	inline void GrowableSmallBlockAllocator::PageList::Remove(Page* pPage)
+	{
+		if (pPage->pPrev != nullptr)
+		{
+			pPage->pPrev->pNext = pPage->pNext;
+		}
+		else
+		{
+			pHead = pPage->pNext;
+		}
+		if (pPage->pNext != nullptr)
+		{
+			pPage->pNext->pPrev = pPage->pPrev;
+		}
+		pPage->pPrev = pPage->pNext = nullptr;
+	}
+
+	inline void* GrowableSmallBlockAllocator::AllocPageMemory(size_t size)
+	{
+		// Pages come straight from the OS rather than malloc, so releasing a page really does give the memory back
+#if defined(_WIN32)
+		// VirtualAlloc already aligns to the 64 KiB allocation granularity
+		return VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+		// Map an extra unit, then unmap whatever is before and after the aligned page
+		const size_t mappedSize = size + PageUnitSize;
+		void* pMapped = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (pMapped == MAP_FAILED)
+			return nullptr;
+
+		const uintptr_t mapped = reinterpret_cast<uintptr_t>(pMapped);
+		const uintptr_t aligned = (mapped + PageUnitSize - 1) & ~static_cast<uintptr_t>(PageUnitSize - 1);
+		if (aligned > mapped)
+		{
+			munmap(pMapped, aligned - mapped);
+		}
+		if (mapped + mappedSize > aligned + size)
+		{
+			munmap(reinterpret_cast<void*>(aligned + size), (mapped + mappedSize) - (aligned + size));
+		}
+		return reinterpret_cast<void*>(aligned);
+#endif
+	}
+
+	inline void GrowableSmallBlockAllocator::FreePageMemory(void* pMemory, size_t size)
+	{
+#if defined(_WIN32)
+		(void)size;
+		VirtualFree(pMemory, 0, MEM_RELEASE);
+#else
+		munmap(pMemory, size);
+#endif
+	}
+
+} // End namespace Memory
@@ -0,0 +1,79 @@
+/*
+The Object Pool is a typed Small Block Allocator. It works like the Buffer in the Weapon System,
+but the objects are built in place inside the pool's blocks instead of being created ahead of time.
+Blocks are sized and aligned from T at compile time, so nobody has to work out the block size or call placement new by hand.
+
+An optional activate callback is called after an object is built and an optional deactivate callback before it is destroyed,
+so objects like bullets can turn themselves on and off as they enter and leave the game.
+Every object in use can be visited through the allocator's Bitfield, skipping free blocks a word at a time.
+
+Like the Small Block Allocator it is not thread safe.
+*/
+
+#pragma once
+
+#include <stddef.h>
+
+#include "SmallBlockAllocator.h"
+
+namespace Memory
+{
+	template<typename T>
+	class ObjectPool
+	{
+	public:
+		// Called on an object when it enters or leaves the pool.
+		typedef void (*Callback)(T& object);
+
+		// Every block holds one T. sizeof(T) is already a multiple of its alignment, so every block stays aligned.
+		static const size_t BlockSize = sizeof(T);
+
+		// A failsafe constructor. Will return NULL if no memory is available.
+		// Capacity is how many objects can be alive at once.
+		static ObjectPool* Create(size_t capacity, Callback activate = nullptr, Callback deactivate = nullptr);
+
+		// Deactivates and destroys every object still alive.
+		~ObjectPool();
+
+		// Builds a T in a free block with the given arguments and then activates it. Returns NULL if the pool is full.
+		// If T's constructor throws, the block is freed again and the exception is passed on.
+		template<typename... Args>
+		T* Spawn(Args&&... args);
+
+		// Deactivates and destroys an object, then frees its block. Does nothing if the object isn't alive in this pool.
+		void Despawn(T* pObject);
+
+		// Deactivates and destroys every object.
+		void Clear();
+
+		// Calls function(T&) for every object alive. Objects must not be spawned or despawned while visiting.
+		template<typename Function>
+		void ForEach(Function function);
+
+		// Is this object alive in this pool?
+		bool Contains(const T* pObject) const;
+
+		// Getters
+		size_t Capacity() const { return _Capacity; }
+		size_t Count() const { return _Capacity - _pAllocator->BlocksFree(); }
+
+		// Setters
+		void Activate(Callback activate) { _Activate = activate; }
+		void Deactivate(Callback deactivate) { _Deactivate = deactivate; }
+
+	private:
+		ObjectPool(SmallBlockAllocator* pAllocator, size_t capacity, Callback activate, Callback deactivate);
+
+		SmallBlockAllocator* _pAllocator; // Where the objects live.
+		size_t _Capacity;
+		Callback _Activate; // NULL if nothing needs to happen.
+		Callback _Deactivate;
+
+		// Make sure nobody tries to copy
+		ObjectPool(const ObjectPool&) = delete;
+		ObjectPool& operator=(const ObjectPool&) = delete;
+	};
+
+} // End namespace Memory
+
+#include "ObjectPool.inl"
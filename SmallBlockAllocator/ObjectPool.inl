@@ -0,0 +1,107 @@
+/*
+An inline file used to define my inline functions for the ObjectPool
+*/
+
+#include <new>
+#include <utility>
+
+namespace Memory
+{
+	template<typename T>
+	ObjectPool<T>* ObjectPool<T>::Create(size_t capacity, Callback activate, Callback deactivate)
+	{
+		// Blocks from malloc are only aligned as much as the largest basic type
+		static_assert(alignof(T) <= alignof(max_align_t), "ObjectPool can't align blocks for over aligned types");
+
+		SmallBlockAllocator* pAllocator = SmallBlockAllocator::Create(BlockSize, capacity);
+		if (pAllocator == nullptr)
+			return nullptr;
+
+		ObjectPool* pPool = new (std::nothrow) ObjectPool(pAllocator, capacity, activate, deactivate);
+		if (pPool == nullptr)
+			delete pAllocator;
+		return pPool;
+	}
+
+	template<typename T>
+	ObjectPool<T>::ObjectPool(SmallBlockAllocator* pAllocator, size_t capacity, Callback activate, Callback deactivate) :
+		_pAllocator(pAllocator),
+		_Capacity(capacity),
+		_Activate(activate),
+		_Deactivate(deactivate)
+	{}
+
+	template<typename T>
+	ObjectPool<T>::~ObjectPool()
+	{
+		Clear();
+		delete _pAllocator;
+	}
+
+	template<typename T>
+	template<typename... Args>
+	inline T* ObjectPool<T>::Spawn(Args&&... args)
+	{
+		void* pBlock = _pAllocator->Alloc(BlockSize);
+		if (pBlock == nullptr)
+			return nullptr;
+
+		// If the constructor throws, the block holds no object, so give it back before passing the exception on
+		T* pObject;
+		try
+		{
+			pObject = new (pBlock) T(std::forward<Args>(args)...);
+		}
+		catch (...)
+		{
+			_pAllocator->Free(pBlock);
+			throw;
+		}
+		if (_Activate != nullptr)
+			_Activate(*pObject);
+		return pObject;
+	}
+
+	template<typename T>
+	inline void ObjectPool<T>::Despawn(T* pObject)
+	{
+		if (!Contains(pObject))
+			return;
+
+		if (_Deactivate != nullptr)
+			_Deactivate(*pObject);
+		pObject->~T();
+		_pAllocator->Free(pObject);
+	}
+
+	template<typename T>
+	void ObjectPool<T>::Clear()
+	{
+		// Freeing the block we're on doesn't disturb the search for the next one
+		_pAllocator->ForEachUsed([this](void* pBlock)
+		{
+			T* pObject = reinterpret_cast<T*>(pBlock);
+			if (_Deactivate != nullptr)
+				_Deactivate(*pObject);
+			pObject->~T();
+			_pAllocator->Free(pBlock);
+		});
+	}
+
+	template<typename T>
+	template<typename Function>
+	inline void ObjectPool<T>::ForEach(Function function)
+	{
+		_pAllocator->ForEachUsed([&function](void* pBlock)
+		{
+			function(*reinterpret_cast<T*>(pBlock));
+		});
+	}
+
+	template<typename T>
+	inline bool ObjectPool<T>::Contains(const T* pObject) const
+	{
+		return pObject != nullptr && _pAllocator->Contains(const_cast<T*>(pObject));
+	}
+
+} // End namespace Memory
@@ -0,0 +1,55 @@
+/*
+The PageMap finds which page a pointer belongs to in constant time.
+Every page is aligned to its size (1 << PageShift), so the page a pointer is in is found by clearing the low bits.
+The page number is then looked up in a two level table, the same way a CPU looks up virtual memory.
+
+Leaves of the table are only allocated for parts of the address space that actually have pages,
+and they are never freed, so Get can be called from any thread without a lock while another thread calls Set.
+Set itself must only be called by one thread at a time.
+
+The table is allocated with calloc rather than new, so it can be used by a global operator new.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace Memory
+{
+	template<size_t PageShift>
+	class PageMap
+	{
+	public:
+		// Pointers are assumed to have at most 48 significant bits, like on current x64 and ARM64.
+		static const size_t AddressBits = 48;
+		static const size_t PageBits = AddressBits - PageShift;
+		static const size_t LeafBits = PageBits / 2;
+		static const size_t RootBits = PageBits - LeafBits;
+
+		// Static failsafe constructor. Will return NULL if no memory is available.
+		static PageMap* Create();
+
+		~PageMap();
+
+		// Returns what was stored for the page containing ptr, or NULL if nothing was.
+		inline void* Get(const void* ptr) const;
+
+		// Stores value for the page containing ptr. Returns false if the table couldn't grow to hold it.
+		bool Set(const void* ptr, void* value);
+
+		// Returns the start of the page containing ptr.
+		static uintptr_t PageOf(const void* ptr) { return reinterpret_cast<uintptr_t>(ptr) & ~((static_cast<uintptr_t>(1) << PageShift) - 1); }
+
+	private:
+		typedef std::atomic<void*> Leaf[static_cast<size_t>(1) << LeafBits];
+
+		PageMap(std::atomic<Leaf*>* pRoot);
+
+		std::atomic<Leaf*>* _pRoot;
+	};
+
+} // End namespace Memory
+
+#include "PageMap.inl"
@@ -0,0 +1,84 @@
+/*
+An inline file used to define my inline functions for the PageMap
+*/
+
+#include <new>
+#include <stdlib.h>
+
+namespace Memory
+{
+	template<size_t PageShift>
+	PageMap<PageShift>* PageMap<PageShift>::Create()
+	{
+		// calloc gives back zeroed memory, which is an empty table. Most OSes won't commit the pages until they are touched.
+		std::atomic<Leaf*>* pRoot = reinterpret_cast<std::atomic<Leaf*>*>(calloc(static_cast<size_t>(1) << RootBits, sizeof(std::atomic<Leaf*>)));
+		if (pRoot == nullptr)
+			return nullptr;
+
+		void* pMemory = malloc(sizeof(PageMap));
+		if (pMemory == nullptr)
+		{
+			free(pRoot);
+			return nullptr;
+		}
+		return new (pMemory) PageMap(pRoot);
+	}
+
+	template<size_t PageShift>
+	PageMap<PageShift>::PageMap(std::atomic<Leaf*>* pRoot) :
+		_pRoot(pRoot)
+	{}
+
+	template<size_t PageShift>
+	PageMap<PageShift>::~PageMap()
+	{
+		for (size_t i = 0; i < (static_cast<size_t>(1) << RootBits); i++)
+		{
+			free(_pRoot[i].load(std::memory_order_relaxed));
+		}
+		free(_pRoot);
+	}
+
+	template<size_t PageShift>
+	inline void* PageMap<PageShift>::Get(const void* ptr) const
+	{
+		const uintptr_t page = reinterpret_cast<uintptr_t>(ptr) >> PageShift;
+		if ((page >> PageBits) != 0)
+		{
+			// Outside the address range we cover, so it can't be one of our pages
+			return nullptr;
+		}
+
+		const Leaf* pLeaf = _pRoot[page >> LeafBits].load(std::memory_order_acquire);
+		if (pLeaf == nullptr)
+		{
+			return nullptr;
+		}
+		return (*pLeaf)[page & ((static_cast<uintptr_t>(1) << LeafBits) - 1)].load(std::memory_order_acquire);
+	}
+
+	template<size_t PageShift>
+	bool PageMap<PageShift>::Set(const void* ptr, void* value)
+	{
+		const uintptr_t page = reinterpret_cast<uintptr_t>(ptr) >> PageShift;
+		if ((page >> PageBits) != 0)
+		{
+			return false;
+		}
+
+		std::atomic<Leaf*>& root = _pRoot[page >> LeafBits];
+		Leaf* pLeaf = root.load(std::memory_order_relaxed);
+		if (pLeaf == nullptr)
+		{
+			pLeaf = reinterpret_cast<Leaf*>(calloc(1, sizeof(Leaf)));
+			if (pLeaf == nullptr)
+			{
+				return false;
+			}
+			root.store(pLeaf, std::memory_order_release);
+		}
+
+		(*pLeaf)[page & ((static_cast<uintptr_t>(1) << LeafBits) - 1)].store(value, std::memory_order_release);
+		return true;
+	}
+}
@@ -6,10 +6,22 @@ The Small Block Allocator is part of a memory management system.
 Memory that is under a specific size (the block size) is designated to be allocated to a single block in the SBA.
 Each SBA has a specific block size and block count.
 It uses a Bitfield to keep track of which blocks are in use.
+
+Save writes the blocks and the Bitfield to a file, and Restore reads them back into a new allocator with one read,
+so a warm restart doesn't rebuild the pool object by object.
+The blocks are copied byte for byte, so anything in them that points at another block is wrong once they move.
+Keep Handles (block indices) instead of pointers in objects that are going to be saved, and turn them back into pointers with FromHandle.
+Saved files only open on a machine with the same byte order, and whatever was in the blocks must still make sense in the new process.
 */
 
 #pragma once
 
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Arena.h"
+#include "SmallBlockAllocatorStats.h"
+
 // Forward declare the Bitfield
 class Bitfield;
 
@@ -23,25 +35,109 @@ namespace Memory
 		// BlockSize is how large each block is. BlockCount is how many blocks.
 		static SmallBlockAllocator* Create(size_t blockSize, size_t blockCount);
 
+		// Same as above, but the blocks live in an Arena reserved from the OS instead of coming from malloc.
+		// Use this for large pools that would otherwise span thousands of small pages. See Arena.h for the options.
+		static SmallBlockAllocator* Create(size_t blockSize, size_t blockCount, const Arena::Options& arenaOptions);
+
+		// This is used if a location has already been assigned for the allocator.
+		// The allocator, its Bitfield and its blocks are all placed at io_pMemory, which is then moved past them.
+		// This should only be used when we know for certain there is enough memory. MemoryRequired tells us how much that is.
+		static SmallBlockAllocator* Create(size_t blockSize, size_t blockCount, void*& io_pMemory);
+		static size_t MemoryRequired(size_t blockSize, size_t blockCount);
+
+		// How many blocks fit in memorySize bytes when using the Create above.
+		static size_t BlocksThatFit(size_t blockSize, size_t memorySize);
+
+		// Blocks placed in caller memory start on this alignment.
+		static const size_t BlockAlignment = 16;
+
 		~SmallBlockAllocator();
 
 		// Allocate to a block and Free from a Block.
-		void* Alloc(size_t size);
+		// Site is where the allocation came from, which is only recorded when instrumented. Pass SMALLBLOCK_SITE.
+		void* Alloc(size_t size, const char* site = nullptr);
 		void Free(void* ptr);
 
+		// Allocate or free many blocks at once. The Bitfield is updated a whole word at a time instead of a bit at a time.
+		// AllocBatch fills o_ptrs with up to count blocks and returns how many it got. Blocks next to each other are handed out together.
+		size_t AllocBatch(size_t count, void** o_ptrs);
+		// Pointers that aren't ours are skipped. Freeing pointers in address order lets more of them share a word.
+		void FreeBatch(void* const* ptrs, size_t count);
+
 		// Is the block that contains this pointer being used? Returns true if it does contain the ptr and is set.
 		bool Contains(void* ptr);
 
 		// How many blocks are free?
 		size_t BlocksFree();
 
+		// Calls function(void* pBlock) for every block in use, in address order. Skips a whole word of free blocks at a time.
+		template<typename Function>
+		void ForEachUsed(Function function) const;
+
+		// The Arena the blocks live in, or NULL if they came from malloc or were placed in given memory.
+		const Arena* BlockArena() const { return _pArena; }
+
+		// Copies the allocator's counters. See SmallBlockAllocatorStats.h.
+		SmallBlockStats Snapshot() const;
+
+		// A block's index. Unlike its address, it is the same in a restored allocator.
+		typedef size_t Handle;
+		static const Handle InvalidHandle = ~static_cast<size_t>(0);
+
+		// The Handle of the block that starts at ptr, or InvalidHandle if no block of ours starts there.
+		Handle HandleOf(const void* ptr) const;
+		// The block a Handle names, or NULL if there is no such block. It doesn't check that the block is in use.
+		void* FromHandle(Handle handle) const;
+
+		// Saves every block and which ones are in use to path, replacing anything already there. Returns false if the file couldn't be written.
+		bool Save(const char* path) const;
+		// Creates an allocator from a file written by Save. The blocks come from malloc, whichever way the saved allocator got them.
+		// Which blocks are in use is read from the file, but the Bitfield's summaries and free count are worked out again from those bits.
+		// Returns NULL if the file can't be read or wasn't written by Save, including when its count of free blocks doesn't match the blocks marked in use.
+		static SmallBlockAllocator* Restore(const char* path);
+
 	private:
-		SmallBlockAllocator(size_t blockSize, size_t blockCount, void* pBlock, Bitfield* pBitfield);
+		// How many indices AllocBatch and FreeBatch hand the Bitfield at a time.
+		static const size_t BatchChunk = 64;
+
+		// The start of a saved allocator. The blocks come next, then the Bitfield's words starting on a whole word.
+		struct SavedHeader
+		{
+			char magic[8]; // "SMALLBLK"
+			uint32_t version;
+			uint32_t byteOrder; // 0x01020304 as written by the machine that saved the file.
+			uint64_t blockSize;
+			uint64_t blockCount;
+			uint64_t freeBlocks;
+			uint64_t blockBytes; // The blocks plus the padding after them.
+			uint64_t bitfieldWords;
+			uint64_t reserved;
+		};
+		static const uint32_t SavedVersion = 1;
+		static const uint32_t SavedByteOrder = 0x01020304;
+
+		// How many bytes the blocks take in a saved file.
+		static size_t SavedBlockBytes(size_t blockSize, size_t blockCount);
+
+		SmallBlockAllocator(size_t blockSize, size_t blockCount, void* pBlock, Bitfield* pBitfield, bool ownsMemory, Arena* pArena = nullptr);
 
 		size_t _BlockSize; // How large is each block?
 		size_t _BlockCount; // How many blocks?
 		void* _pBlock; // Where are the blocks located?
 		Bitfield* _pBitfield; // The bitfield being used.
+		bool _OwnsMemory; // Did we allocate the blocks and Bitfield, or were they placed in memory given to us?
+		Arena* _pArena; // Where the blocks came from if they didn't come from malloc.
+
+#if defined(SMALLBLOCKALLOCATOR_INSTRUMENT)
+		// Sets up the counters and fills every block with the freed pattern.
+		void InitInstrumentation();
+		// Is every byte of the block still the freed pattern?
+		bool GuardIntact(const unsigned char* pBlock) const;
+
+		SmallBlockStats _Stats;
+		unsigned char* _pBlockSites; // The index into _Stats.sites of each block in use. NoSite if it wasn't tracked.
+		static const unsigned char NoSite = 0xFF;
+#endif
 	};
 
 } // End namespace Memory
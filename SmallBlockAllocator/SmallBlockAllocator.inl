@@ -5,9 +5,17 @@ Date: 3/30/2016
 An inline file used to define my inline functions for the SmallBlockAllocator
 */
 
+#include <new>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../Bitfield/Bitfield.h"
+
 namespace Memory
 {
-	SmallBlockAllocator* SmallBlockAllocator::Create(size_t blockSize, size_t blockCount)
+	inline SmallBlockAllocator* SmallBlockAllocator::Create(size_t blockSize, size_t blockCount)
 	{
 		char* pBlock = reinterpret_cast<char *>(malloc(blockSize * blockCount));
 		if (pBlock == nullptr)
@@ -16,43 +24,223 @@ namespace Memory
 		Bitfield* pBitfield = Bitfield::Create(blockCount);
 		if (pBitfield == nullptr)
 		{
-			delete[] pBlock;
+			free(pBlock);
+			return nullptr;
+		}
+
+		return new SmallBlockAllocator(blockSize, blockCount, pBlock, pBitfield, true);
+	}
+
+	inline SmallBlockAllocator* SmallBlockAllocator::Create(size_t blockSize, size_t blockCount, const Arena::Options& arenaOptions)
+	{
+		Arena* pArena = Arena::Create(blockSize * blockCount, arenaOptions);
+		if (pArena == nullptr)
+			return nullptr;
+
+		Bitfield* pBitfield = Bitfield::Create(blockCount);
+		if (pBitfield == nullptr)
+		{
+			delete pArena;
 			return nullptr;
 		}
 
-		return new SmallBlockAllocator(blockSize, blockCount, pBlock, pBitfield);
+		return new SmallBlockAllocator(blockSize, blockCount, pArena->Base(), pBitfield, true, pArena);
 	}
 
-	SmallBlockAllocator::~SmallBlockAllocator()
+	inline SmallBlockAllocator* SmallBlockAllocator::Create(size_t blockSize, size_t blockCount, void*& io_pMemory)
 	{
-		delete _pBitfield;
+		// The allocator goes first, then the Bitfield, then the blocks
+		const uintptr_t address = (reinterpret_cast<uintptr_t>(io_pMemory) + sizeof(void*) - 1) & ~static_cast<uintptr_t>(sizeof(void*) - 1);
+		void* pNext = reinterpret_cast<void*>(address + sizeof(SmallBlockAllocator));
+
+		Bitfield* pBitfield = Bitfield::Create(blockCount, pNext);
+
+		const uintptr_t blocks = (reinterpret_cast<uintptr_t>(pNext) + BlockAlignment - 1) & ~static_cast<uintptr_t>(BlockAlignment - 1);
+		io_pMemory = reinterpret_cast<void*>(blocks + blockSize * blockCount);
+
+		return new (reinterpret_cast<void*>(address)) SmallBlockAllocator(blockSize, blockCount, reinterpret_cast<void*>(blocks), pBitfield, false);
+	}
+
+	inline size_t SmallBlockAllocator::MemoryRequired(size_t blockSize, size_t blockCount)
+	{
+		return (sizeof(void*) - 1) + sizeof(SmallBlockAllocator) + Bitfield::MemoryRequired(blockCount) + (BlockAlignment - 1) + blockSize * blockCount;
+	}
+
+	inline size_t SmallBlockAllocator::BlocksThatFit(size_t blockSize, size_t memorySize)
+	{
+		// Each block costs its size plus one bit. Start from that guess and back off until the overhead fits too.
+		size_t blockCount = (memorySize * 8) / (blockSize * 8 + 1);
+		while (blockCount > 0 && MemoryRequired(blockSize, blockCount) > memorySize)
+		{
+			blockCount--;
+		}
+		return blockCount;
+	}
+
+	inline SmallBlockAllocator::~SmallBlockAllocator()
+	{
+#if defined(SMALLBLOCKALLOCATOR_INSTRUMENT)
+		free(_pBlockSites);
+#endif
+		if (_OwnsMemory)
+		{
+			delete _pBitfield;
+			if (_pArena != nullptr)
+			{
+				delete _pArena;
+			}
+			else
+			{
+				free(_pBlock);
+			}
+		}
+		else
+		{
+			// The Bitfield was placed in memory we were given, so it only needs destroying
+			_pBitfield->~Bitfield();
+		}
 	}
 
 
-	void* SmallBlockAllocator::Alloc(size_t size) {
+	inline void* SmallBlockAllocator::Alloc(size_t size, const char* site) {
 		size_t index = 0;
 
+		// The Bitfield remembers where the last free block was, so this doesn't search from the first block every time
 		if (_pBitfield->FirstFreeBit(index)) {
 			_pBitfield->SetBit(index);
-			return reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(_pBlock) + (index * _BlockSize));
+			void* ptr = reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(_pBlock) + (index * _BlockSize));
+
+#if defined(SMALLBLOCKALLOCATOR_INSTRUMENT)
+			_Stats.allocs++;
+			const size_t inUse = _BlockCount - _pBitfield->FreeBits();
+			if (inUse > _Stats.highWater)
+				_Stats.highWater = inUse;
+
+			// Anything but the freed pattern means someone wrote to the block while it was free
+			if (!GuardIntact(reinterpret_cast<unsigned char*>(ptr)))
+				_Stats.guardViolations++;
+			memset(ptr, SmallBlockStats::AllocatedPattern, _BlockSize);
+
+			// Sites are string literals, so the same site always has the same address
+			size_t siteIndex = 0;
+			while (siteIndex < _Stats.siteCount && _Stats.sites[siteIndex].site != site)
+				siteIndex++;
+			if (siteIndex == _Stats.siteCount && siteIndex < SmallBlockStats::MaxSites)
+			{
+				_Stats.sites[siteIndex].site = site;
+				_Stats.sites[siteIndex].allocs = 0;
+				_Stats.sites[siteIndex].live = 0;
+				_Stats.siteCount++;
+			}
+			if (siteIndex < _Stats.siteCount && _pBlockSites != nullptr)
+			{
+				_Stats.sites[siteIndex].allocs++;
+				_Stats.sites[siteIndex].live++;
+				_pBlockSites[index] = static_cast<unsigned char>(siteIndex);
+			}
+			else
+			{
+				_Stats.untrackedSiteAllocs++;
+				if (_pBlockSites != nullptr)
+					_pBlockSites[index] = NoSite;
+			}
+#else
+			(void)site;
+#endif
+			return ptr;
 		}
 
+#if defined(SMALLBLOCKALLOCATOR_INSTRUMENT)
+		_Stats.failedAllocs++;
+#endif
 		return nullptr;
 	}
 
-	void SmallBlockAllocator::Free(void* ptr) {
-		if (ptr < _pBlock || ptr >= _pBlock) {
+	inline void SmallBlockAllocator::Free(void* ptr) {
+		if (ptr < _pBlock || ptr >= reinterpret_cast<char*>(_pBlock) + _BlockSize * _BlockCount) {
+#if defined(SMALLBLOCKALLOCATOR_INSTRUMENT)
+			if (ptr != nullptr)
+				_Stats.foreignFrees++;
+#endif
 			return;
 		}
+
+		size_t index = (reinterpret_cast<uintptr_t>(ptr) - reinterpret_cast<uintptr_t>(_pBlock)) / _BlockSize;
+
+#if defined(SMALLBLOCKALLOCATOR_INSTRUMENT)
+		// A pointer into the middle of a block didn't come from Alloc
+		if (reinterpret_cast<char*>(ptr) != reinterpret_cast<char*>(_pBlock) + index * _BlockSize)
+		{
+			_Stats.foreignFrees++;
+			return;
+		}
+		if (!_pBitfield->operator[](index))
+		{
+			_Stats.doubleFrees++;
+			return;
+		}
+
+		_Stats.frees++;
+		if (_pBlockSites != nullptr && _pBlockSites[index] != NoSite)
+			_Stats.sites[_pBlockSites[index]].live--;
+		memset(ptr, SmallBlockStats::FreedPattern, _BlockSize);
+#else
 		if (!Contains(ptr)) {
 			return;
 		}
+#endif
 
-		size_t index = (reinterpret_cast<uintptr_t>(ptr) - reinterpret_cast<uintptr_t>(_pBlock)) / _BlockSize;
 		_pBitfield->FreeBit(index);
 	}
 
-	bool SmallBlockAllocator::Contains(void* ptr) {
+	inline size_t SmallBlockAllocator::AllocBatch(size_t count, void** o_ptrs) {
+#if defined(SMALLBLOCKALLOCATOR_INSTRUMENT)
+		// Go one block at a time so every block is counted and guard checked
+		size_t allocated = 0;
+		while (allocated < count && (o_ptrs[allocated] = Alloc(_BlockSize)) != nullptr)
+			allocated++;
+		return allocated;
+#else
+		size_t indices[BatchChunk];
+		size_t allocated = 0;
+		while (allocated < count) {
+			const size_t want = count - allocated < BatchChunk ? count - allocated : BatchChunk;
+			const size_t claimed = _pBitfield->ClaimFreeBits(want, indices);
+			for (size_t i = 0; i < claimed; i++) {
+				o_ptrs[allocated++] = reinterpret_cast<char*>(_pBlock) + indices[i] * _BlockSize;
+			}
+			if (claimed < want) {
+				break;
+			}
+		}
+		return allocated;
+#endif
+	}
+
+	inline void SmallBlockAllocator::FreeBatch(void* const* ptrs, size_t count) {
+#if defined(SMALLBLOCKALLOCATOR_INSTRUMENT)
+		for (size_t i = 0; i < count; i++)
+			Free(ptrs[i]);
+#else
+		const uintptr_t begin = reinterpret_cast<uintptr_t>(_pBlock);
+		const uintptr_t end = begin + _BlockSize * _BlockCount;
+
+		size_t indices[BatchChunk];
+		size_t i = 0;
+		while (i < count) {
+			size_t chunkCount = 0;
+			for (; i < count && chunkCount < BatchChunk; i++) {
+				const uintptr_t address = reinterpret_cast<uintptr_t>(ptrs[i]);
+				if (address >= begin && address < end) {
+					indices[chunkCount++] = (address - begin) / _BlockSize;
+				}
+			}
+			_pBitfield->ReleaseBits(indices, chunkCount);
+		}
+#endif
+	}
+
+	inline bool SmallBlockAllocator::Contains(void* ptr) {
 		if (reinterpret_cast<uintptr_t>(ptr) == 0xfeeefeee) 
 		{
 			return false;
@@ -68,12 +256,195 @@ namespace Memory
 		return _pBitfield->operator[](index);
 	}
 
-	unsigned int SmallBlockAllocator::BlocksFree() { return _pBitfield->FreeBits(); }
+	inline size_t SmallBlockAllocator::BlocksFree() { return _pBitfield->FreeBits(); }
+
+	template<typename Function>
+	inline void SmallBlockAllocator::ForEachUsed(Function function) const
+	{
+		size_t index = 0;
+		while (_pBitfield->NextSetBit(index, index))
+		{
+			function(reinterpret_cast<char*>(_pBlock) + index * _BlockSize);
+			index++;
+		}
+	}
+
+	inline SmallBlockStats SmallBlockAllocator::Snapshot() const
+	{
+#if defined(SMALLBLOCKALLOCATOR_INSTRUMENT)
+		SmallBlockStats stats = _Stats;
+		stats.instrumented = true;
+#else
+		SmallBlockStats stats;
+		memset(&stats, 0, sizeof(stats));
+#endif
+		stats.blockSize = _BlockSize;
+		stats.blockCount = _BlockCount;
+		stats.blocksInUse = _BlockCount - _pBitfield->FreeBits();
+		return stats;
+	}
+
+	inline SmallBlockAllocator::Handle SmallBlockAllocator::HandleOf(const void* ptr) const
+	{
+		const uintptr_t address = reinterpret_cast<uintptr_t>(ptr);
+		const uintptr_t begin = reinterpret_cast<uintptr_t>(_pBlock);
+		if (address < begin || address >= begin + _BlockSize * _BlockCount || (address - begin) % _BlockSize != 0)
+		{
+			return InvalidHandle;
+		}
+		return (address - begin) / _BlockSize;
+	}
+
+	inline void* SmallBlockAllocator::FromHandle(Handle handle) const
+	{
+		if (handle >= _BlockCount)
+		{
+			return nullptr;
+		}
+		return reinterpret_cast<char*>(_pBlock) + handle * _BlockSize;
+	}
+
+	inline size_t SmallBlockAllocator::SavedBlockBytes(size_t blockSize, size_t blockCount)
+	{
+		// Padded so the Bitfield's words after the blocks start on a whole word, both in the file and once read back
+		return (blockSize * blockCount + sizeof(uint64_t) - 1) & ~(sizeof(uint64_t) - 1);
+	}
+
+	inline bool SmallBlockAllocator::Save(const char* path) const
+	{
+		const size_t blockBytes = _BlockSize * _BlockCount;
 
-	SmallBlockAllocator::SmallBlockAllocator(size_t blockSize, unsigned int blockCount, void* pBlock, Bitfield* pBitfield) :
+		SavedHeader header;
+		memset(&header, 0, sizeof(header));
+		memcpy(header.magic, "SMALLBLK", sizeof(header.magic));
+		header.version = SavedVersion;
+		header.byteOrder = SavedByteOrder;
+		header.blockSize = _BlockSize;
+		header.blockCount = _BlockCount;
+		header.freeBlocks = _pBitfield->FreeBits();
+		header.blockBytes = SavedBlockBytes(_BlockSize, _BlockCount);
+		header.bitfieldWords = Bitfield::StorageWords(_BlockCount);
+
+		FILE* pFile = fopen(path, "wb");
+		if (pFile == nullptr)
+			return false;
+
+		const uint64_t padding = 0;
+		const size_t paddingBytes = static_cast<size_t>(header.blockBytes) - blockBytes;
+		const bool written = fwrite(&header, sizeof(header), 1, pFile) == 1 &&
+			fwrite(_pBlock, blockBytes, 1, pFile) == 1 &&
+			(paddingBytes == 0 || fwrite(&padding, paddingBytes, 1, pFile) == 1) &&
+			fwrite(_pBitfield->Words(), sizeof(uint64_t), static_cast<size_t>(header.bitfieldWords), pFile) == header.bitfieldWords;
+		return fclose(pFile) == 0 && written;
+	}
+
+	inline SmallBlockAllocator* SmallBlockAllocator::Restore(const char* path)
+	{
+		FILE* pFile = fopen(path, "rb");
+		if (pFile == nullptr)
+			return nullptr;
+
+		SavedHeader header;
+		if (fread(&header, sizeof(header), 1, pFile) != 1 ||
+			memcmp(header.magic, "SMALLBLK", sizeof(header.magic)) != 0 ||
+			header.version != SavedVersion ||
+			header.byteOrder != SavedByteOrder ||
+			header.blockSize == 0 || header.blockCount == 0 ||
+			header.blockCount > SIZE_MAX / header.blockSize ||
+			header.freeBlocks > header.blockCount ||
+			header.blockBytes != SavedBlockBytes(static_cast<size_t>(header.blockSize), static_cast<size_t>(header.blockCount)) ||
+			header.bitfieldWords != Bitfield::StorageWords(static_cast<size_t>(header.blockCount)) ||
+			header.bitfieldWords > (SIZE_MAX - header.blockBytes) / sizeof(uint64_t))
+		{
+			fclose(pFile);
+			return nullptr;
+		}
+
+		const size_t blockSize = static_cast<size_t>(header.blockSize);
+		const size_t blockCount = static_cast<size_t>(header.blockCount);
+		const size_t blockBytes = static_cast<size_t>(header.blockBytes);
+		const size_t payloadBytes = blockBytes + static_cast<size_t>(header.bitfieldWords) * sizeof(uint64_t);
+
+		// The blocks and the Bitfield's words share one allocation laid out like the file, so the destructor's free of the blocks frees both
+		char* pBlock = reinterpret_cast<char*>(malloc(payloadBytes));
+		if (pBlock == nullptr)
+		{
+			fclose(pFile);
+			return nullptr;
+		}
+
+		Bitfield* pBitfield = Bitfield::Attach(blockCount, static_cast<size_t>(header.freeBlocks), reinterpret_cast<uint64_t*>(pBlock + blockBytes));
+		SmallBlockAllocator* pAllocator = pBitfield != nullptr ? new (std::nothrow) SmallBlockAllocator(blockSize, blockCount, pBlock, pBitfield, true) : nullptr;
+		if (pAllocator == nullptr)
+		{
+			delete pBitfield;
+			free(pBlock);
+			fclose(pFile);
+			return nullptr;
+		}
+
+		// Read after constructing, since an instrumented allocator fills its blocks when it is constructed
+		const bool read = fread(pBlock, payloadBytes, 1, pFile) == 1;
+		fclose(pFile);
+		if (!read)
+		{
+			delete pAllocator;
+			return nullptr;
+		}
+
+		// Attach takes the saved summary levels and the header's free count on trust, and a search through bad summaries
+		// can hand out a block in use or read past the words. Work both out from the saved words instead, and make sure the count agrees.
+		if (!pBitfield->Rescan() || pBitfield->FreeBits() != header.freeBlocks)
+		{
+			delete pAllocator;
+			return nullptr;
+		}
+
+#if defined(SMALLBLOCKALLOCATOR_INSTRUMENT)
+		// The saved free blocks may not hold the freed pattern. The blocks in use have no site.
+		for (size_t i = 0; i < blockCount; i++)
+		{
+			if (!pBitfield->operator[](i))
+				memset(pBlock + i * blockSize, SmallBlockStats::FreedPattern, blockSize);
+		}
+#endif
+		return pAllocator;
+	}
+
+#if defined(SMALLBLOCKALLOCATOR_INSTRUMENT)
+	inline void SmallBlockAllocator::InitInstrumentation()
+	{
+		memset(&_Stats, 0, sizeof(_Stats));
+		// If this fails every allocation is counted as untracked instead
+		_pBlockSites = reinterpret_cast<unsigned char*>(malloc(_BlockCount));
+		if (_pBlockSites != nullptr)
+			memset(_pBlockSites, NoSite, _BlockCount);
+
+		// This commits every page of an Arena up front, which is fine for a debugging build
+		memset(_pBlock, SmallBlockStats::FreedPattern, _BlockSize * _BlockCount);
+	}
+
+	inline bool SmallBlockAllocator::GuardIntact(const unsigned char* pBlock) const
+	{
+		for (size_t i = 0; i < _BlockSize; i++)
+		{
+			if (pBlock[i] != SmallBlockStats::FreedPattern)
+				return false;
+		}
+		return true;
+	}
+#endif
+
+	inline SmallBlockAllocator::SmallBlockAllocator(size_t blockSize, size_t blockCount, void* pBlock, Bitfield* pBitfield, bool ownsMemory, Arena* pArena) :
 		_BlockSize(blockSize),
 		_BlockCount(blockCount),
 		_pBlock(pBlock),
-		_pBitfield(pBitfield)
-	{}
+		_pBitfield(pBitfield),
+		_OwnsMemory(ownsMemory),
+		_pArena(pArena)
+	{
+#if defined(SMALLBLOCKALLOCATOR_INSTRUMENT)
+		InitInstrumentation();
+#endif
+	}
 }
\ No newline at end of file
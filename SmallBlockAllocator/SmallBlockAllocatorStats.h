@@ -0,0 +1,66 @@
+/*
+Instrumentation for the Small Block Allocator.
+Define SMALLBLOCKALLOCATOR_INSTRUMENT to turn it on. Without it the allocator keeps no counters at all,
+and Snapshot only reports what the allocator already knows (its size and how many blocks are free).
+
+When it is on, every allocator counts its allocs and frees, remembers its high water mark, counts allocations by call site,
+and catches double frees and pointers that never came from it.
+Free blocks are filled with FreedPattern and handed out blocks with AllocatedPattern, so a write to a block after it was freed
+is caught the next time that block is handed out.
+
+Pass SMALLBLOCK_SITE to Alloc to record where an allocation came from. It turns into nullptr when instrumentation is off.
+*/
+
+#pragma once
+
+#include <stddef.h>
+
+#if defined(SMALLBLOCKALLOCATOR_INSTRUMENT)
+#define SMALLBLOCK_STRINGIZE_IMPL(x) #x
+#define SMALLBLOCK_STRINGIZE(x) SMALLBLOCK_STRINGIZE_IMPL(x)
+#define SMALLBLOCK_SITE (__FILE__ ":" SMALLBLOCK_STRINGIZE(__LINE__))
+#else
+#define SMALLBLOCK_SITE nullptr
+#endif
+
+namespace Memory
+{
+	// How many allocations came from one call site, and how many of them are still in use.
+	struct SmallBlockSiteCount
+	{
+		const char* site; // NULL for allocations that didn't pass a site.
+		size_t allocs;
+		size_t live; // Still in use at shutdown means leaked.
+	};
+
+	// A copy of an allocator's counters at one point in time.
+	struct SmallBlockStats
+	{
+		// How many call sites are counted separately. Any more are only added to untrackedSiteAllocs.
+		static const size_t MaxSites = 32;
+
+		// What blocks look like while they are free and right after they are handed out.
+		static const unsigned char FreedPattern = 0xDD;
+		static const unsigned char AllocatedPattern = 0xCD;
+
+		bool instrumented; // False if SMALLBLOCKALLOCATOR_INSTRUMENT wasn't defined. Only the next three are filled in then.
+
+		size_t blockSize;
+		size_t blockCount;
+		size_t blocksInUse;
+
+		size_t allocs; // Successful allocations.
+		size_t frees; // Successful frees.
+		size_t failedAllocs; // Allocations that returned NULL.
+		size_t highWater; // The most blocks that were ever in use at once.
+
+		size_t doubleFrees; // Frees of a block that was already free.
+		size_t foreignFrees; // Frees of a pointer that isn't the start of one of our blocks.
+		size_t guardViolations; // Blocks that were written to while they were free.
+
+		size_t siteCount;
+		SmallBlockSiteCount sites[MaxSites];
+		size_t untrackedSiteAllocs; // Allocations from sites past the first MaxSites.
+	};
+
+} // End namespace Memory
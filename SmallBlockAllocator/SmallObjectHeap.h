@@ -0,0 +1,95 @@
+/*
+The SmallObjectHeap hands out memory of any size up to MaxSize by rounding the size up to one of a few size classes.
+Each size class is a chain of pages, and each page is a SmallBlockAllocator for that class's block size.
+When every page of a class is full a new page is added, so the heap grows as it needs to.
+
+Pages are aligned to their size, so Free finds the page a pointer came from with a PageMap lookup
+instead of asking every allocator if it contains the pointer.
+
+Each size class has its own lock, so threads only wait on each other when they use the same size class.
+Global() returns a heap that is never destroyed. SmallObjectHeapNew.cpp uses it as the global operator new and delete
+when SMALLOBJECTHEAP_REPLACE_NEW is defined.
+*/
+
+#pragma once
+
+#include <mutex>
+#include <stddef.h>
+
+#include "PageMap.h"
+#include "SmallBlockAllocator.h"
+
+namespace Memory
+{
+	class SmallObjectHeap
+	{
+	public:
+		// Every page is this big and aligned to its size.
+		static const size_t PageShift = 16;
+		static const size_t PageSize = static_cast<size_t>(1) << PageShift;
+
+		// The largest size the heap will hand out.
+		static const size_t MaxSize = 256;
+		static const size_t ClassCount = 9;
+
+		// Static failsafe constructor. Will return NULL if no memory is available.
+		static SmallObjectHeap* Create();
+		// Frees everything a heap from Create owns.
+		static void Destroy(SmallObjectHeap* pHeap);
+
+		// The heap shared by the whole process. It is never destroyed, so it can still free memory while the program exits.
+		static SmallObjectHeap& Global();
+
+		// Returns NULL if size is bigger than MaxSize or no memory is available.
+		// Blocks of 16 bytes or more are 16 byte aligned. Smaller blocks are aligned to 8.
+		void* Alloc(size_t size);
+		// Does nothing if ptr didn't come from this heap.
+		void Free(void* ptr);
+		// Does ptr belong to a page of this heap?
+		inline bool Owns(const void* ptr) const;
+
+		// Getters
+		static size_t ClassSize(size_t classIndex);
+		size_t PageCount() const;
+
+	private:
+		// Sits at the start of every page. The page's allocator is placed right after it.
+		struct Page
+		{
+			SmallBlockAllocator* pAllocator;
+			Page* pNext;
+			size_t classIndex;
+		};
+
+		struct SizeClass
+		{
+			std::mutex mutex;
+			Page* pPages; // Every page of this class.
+			Page* pCurrent; // The page we try first. Usually the last one that had a free block.
+			size_t pageCount;
+		};
+
+		typedef PageMap<PageShift> HeapPageMap;
+
+		SmallObjectHeap(HeapPageMap* pPageMap);
+		~SmallObjectHeap();
+
+		// Adds a new page to a size class. The class's mutex must be held. Returns NULL if no memory is available.
+		Page* AddPage(size_t classIndex);
+
+		static void* AllocPage();
+		static void FreePage(void* pPage);
+
+		SizeClass _Classes[ClassCount];
+		unsigned char _ClassOfSize[MaxSize / 8 + 1]; // Which class each size falls in, indexed by (size + 7) / 8.
+		HeapPageMap* _pPageMap; // Which page each address belongs to.
+		std::mutex _PageMapMutex; // The PageMap only allows one thread to Set at a time.
+
+		// Make sure nobody tries to copy
+		SmallObjectHeap(const SmallObjectHeap&) = delete;
+		SmallObjectHeap& operator=(const SmallObjectHeap&) = delete;
+	};
+
+} // End namespace Memory
+
+#include "SmallObjectHeap.inl"
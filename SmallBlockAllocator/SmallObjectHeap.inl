@@ -0,0 +1,219 @@
+/*
+An inline file used to define my inline functions for the SmallObjectHeap
+*/
+
+#include <new>
+#include <stdlib.h>
+
+#if defined(_WIN32)
+#include <malloc.h>
+#endif
+
+namespace Memory
+{
+	inline SmallObjectHeap* SmallObjectHeap::Create()
+	{
+		HeapPageMap* pPageMap = HeapPageMap::Create();
+		if (pPageMap == nullptr)
+			return nullptr;
+
+		// malloc rather than new, since this may be what new is using
+		void* pMemory = malloc(sizeof(SmallObjectHeap));
+		if (pMemory == nullptr)
+		{
+			pPageMap->~HeapPageMap();
+			free(pPageMap);
+			return nullptr;
+		}
+		return new (pMemory) SmallObjectHeap(pPageMap);
+	}
+
+	inline void SmallObjectHeap::Destroy(SmallObjectHeap* pHeap)
+	{
+		if (pHeap == nullptr)
+			return;
+
+		pHeap->~SmallObjectHeap();
+		free(pHeap);
+	}
+
+	inline SmallObjectHeap& SmallObjectHeap::Global()
+	{
+		// Built in static memory and never destroyed, so objects destroyed after main can still be deleted
+		alignas(SmallObjectHeap) static unsigned char s_Memory[sizeof(SmallObjectHeap)];
+		static SmallObjectHeap* s_pHeap = new (s_Memory) SmallObjectHeap(HeapPageMap::Create());
+		return *s_pHeap;
+	}
+
+	inline SmallObjectHeap::SmallObjectHeap(HeapPageMap* pPageMap) :
+		_pPageMap(pPageMap)
+	{
+		for (size_t i = 0; i < ClassCount; i++)
+		{
+			_Classes[i].pPages = nullptr;
+			_Classes[i].pCurrent = nullptr;
+			_Classes[i].pageCount = 0;
+		}
+
+		// Build the size to class table once so Alloc doesn't have to search the class sizes
+		size_t classIndex = 0;
+		for (size_t i = 0; i <= MaxSize / 8; i++)
+		{
+			while (ClassSize(classIndex) < i * 8)
+			{
+				classIndex++;
+			}
+			_ClassOfSize[i] = static_cast<unsigned char>(classIndex);
+		}
+	}
+
+	inline SmallObjectHeap::~SmallObjectHeap()
+	{
+		for (size_t i = 0; i < ClassCount; i++)
+		{
+			Page* pPage = _Classes[i].pPages;
+			while (pPage != nullptr)
+			{
+				Page* pNext = pPage->pNext;
+				pPage->pAllocator->~SmallBlockAllocator();
+				FreePage(pPage);
+				pPage = pNext;
+			}
+		}
+
+		if (_pPageMap != nullptr)
+		{
+			_pPageMap->~HeapPageMap();
+			free(_pPageMap);
+		}
+	}
+
+	inline void* SmallObjectHeap::Alloc(size_t size)
+	{
+		if (size > MaxSize || _pPageMap == nullptr)
+			return nullptr;
+
+		const size_t classIndex = _ClassOfSize[(size + 7) / 8];
+		SizeClass& sizeClass = _Classes[classIndex];
+		std::lock_guard<std::mutex> lock(sizeClass.mutex);
+
+		if (sizeClass.pCurrent != nullptr)
+		{
+			void* ptr = sizeClass.pCurrent->pAllocator->Alloc(ClassSize(classIndex));
+			if (ptr != nullptr)
+				return ptr;
+		}
+
+		// The current page is full. Look for another page with a free block before adding a new one.
+		for (Page* pPage = sizeClass.pPages; pPage != nullptr; pPage = pPage->pNext)
+		{
+			if (pPage != sizeClass.pCurrent && pPage->pAllocator->BlocksFree() > 0)
+			{
+				sizeClass.pCurrent = pPage;
+				return pPage->pAllocator->Alloc(ClassSize(classIndex));
+			}
+		}
+
+		Page* pPage = AddPage(classIndex);
+		if (pPage == nullptr)
+			return nullptr;
+
+		sizeClass.pCurrent = pPage;
+		return pPage->pAllocator->Alloc(ClassSize(classIndex));
+	}
+
+	inline void SmallObjectHeap::Free(void* ptr)
+	{
+		if (ptr == nullptr || _pPageMap == nullptr)
+			return;
+
+		Page* pPage = reinterpret_cast<Page*>(_pPageMap->Get(ptr));
+		if (pPage == nullptr)
+			return;
+
+		SizeClass& sizeClass = _Classes[pPage->classIndex];
+		std::lock_guard<std::mutex> lock(sizeClass.mutex);
+		pPage->pAllocator->Free(ptr);
+
+		// If the current page is full, this page now has room, so try it first next time
+		if (sizeClass.pCurrent->pAllocator->BlocksFree() == 0)
+		{
+			sizeClass.pCurrent = pPage;
+		}
+	}
+
+	inline bool SmallObjectHeap::Owns(const void* ptr) const
+	{
+		return _pPageMap != nullptr && _pPageMap->Get(ptr) != nullptr;
+	}
+
+	inline size_t SmallObjectHeap::ClassSize(size_t classIndex)
+	{
+		// Every block size. The ones 16 and up are multiples of 16 so those blocks keep the 16 byte alignment of new.
+		static const size_t s_ClassSizes[ClassCount] = { 8, 16, 32, 48, 64, 96, 128, 192, 256 };
+		return classIndex < ClassCount ? s_ClassSizes[classIndex] : 0;
+	}
+
+	inline size_t SmallObjectHeap::PageCount() const
+	{
+		size_t pageCount = 0;
+		for (size_t i = 0; i < ClassCount; i++)
+		{
+			std::lock_guard<std::mutex> lock(const_cast<std::mutex&>(_Classes[i].mutex));
+			pageCount += _Classes[i].pageCount;
+		}
+		return pageCount;
+	}
+
+	inline SmallObjectHeap::Page* SmallObjectHeap::AddPage(size_t classIndex)
+	{
+		void* pMemory = AllocPage();
+		if (pMemory == nullptr)
+			return nullptr;
+
+		// The page header goes first, then the allocator, its Bitfield and its blocks fill the rest of the page
+		Page* pPage = new (pMemory) Page;
+		void* pNext = reinterpret_cast<char*>(pMemory) + sizeof(Page);
+		const size_t blockCount = SmallBlockAllocator::BlocksThatFit(ClassSize(classIndex), PageSize - sizeof(Page));
+		pPage->pAllocator = SmallBlockAllocator::Create(ClassSize(classIndex), blockCount, pNext);
+		pPage->classIndex = classIndex;
+
+		{
+			std::lock_guard<std::mutex> lock(_PageMapMutex);
+			if (!_pPageMap->Set(pMemory, pPage))
+			{
+				pPage->pAllocator->~SmallBlockAllocator();
+				FreePage(pMemory);
+				return nullptr;
+			}
+		}
+
+		SizeClass& sizeClass = _Classes[classIndex];
+		pPage->pNext = sizeClass.pPages;
+		sizeClass.pPages = pPage;
+		sizeClass.pageCount++;
+		return pPage;
+	}
+
+	inline void* SmallObjectHeap::AllocPage()
+	{
+#if defined(_WIN32)
+		return _aligned_malloc(PageSize, PageSize);
+#else
+		void* pMemory = nullptr;
+		if (posix_memalign(&pMemory, PageSize, PageSize) != 0)
+			return nullptr;
+		return pMemory;
+#endif
+	}
+
+	inline void SmallObjectHeap::FreePage(void* pPage)
+	{
+#if defined(_WIN32)
+		_aligned_free(pPage);
+#else
+		free(pPage);
+#endif
+	}
+
+} // End namespace Memory
@@ -0,0 +1,96 @@
+/*
+Replaces the global operator new and delete with the SmallObjectHeap when SMALLOBJECTHEAP_REPLACE_NEW is defined.
+Sizes up to SmallObjectHeap::MaxSize come from SmallObjectHeap::Global(). Anything bigger, or anything the heap
+can't fit, comes from malloc. Delete asks the heap's PageMap who owns the pointer, so it works for both.
+
+Over aligned new (alignment above 16) is left to the standard library.
+*/
+
+#if defined(SMALLOBJECTHEAP_REPLACE_NEW)
+
+#include <new>
+#include <stdlib.h>
+
+#include "SmallObjectHeap.h"
+
+namespace
+{
+	inline void* HeapAlloc(size_t size)
+	{
+		void* ptr = Memory::SmallObjectHeap::Global().Alloc(size);
+		if (ptr != nullptr)
+			return ptr;
+
+		return malloc(size == 0 ? 1 : size);
+	}
+
+	inline void HeapFree(void* ptr)
+	{
+		if (ptr == nullptr)
+			return;
+
+		Memory::SmallObjectHeap& heap = Memory::SmallObjectHeap::Global();
+		if (heap.Owns(ptr))
+			heap.Free(ptr);
+		else
+			free(ptr);
+	}
+}
+
+void* operator new(size_t size)
+{
+	void* ptr = HeapAlloc(size);
+	if (ptr == nullptr)
+		throw std::bad_alloc();
+	return ptr;
+}
+
+void* operator new[](size_t size)
+{
+	void* ptr = HeapAlloc(size);
+	if (ptr == nullptr)
+		throw std::bad_alloc();
+	return ptr;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	return HeapAlloc(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	return HeapAlloc(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+	HeapFree(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+	HeapFree(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+	HeapFree(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+	HeapFree(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+	HeapFree(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept
+{
+	HeapFree(ptr);
+}
+
+#endif
@@ -0,0 +1,107 @@
+/*
+The Thread Cached Allocator puts a small cache of blocks in front of a ConcurrentSmallBlockAllocator for every thread that uses it.
+Each cache (a magazine) is a stack of blocks that only its own thread touches,
+so most calls to Alloc and Free never touch memory shared with another thread.
+
+When a magazine runs empty it is refilled with half a magazine of blocks in one AllocBatch,
+and when it fills up half of it is given back in one FreeBatch.
+A block can be freed on any thread. It just goes into that thread's magazine.
+When a thread exits, its magazines give their blocks back to the shared allocator.
+
+Blocks sitting in a magazine still count as in use to the shared allocator,
+so Contains returns true for them and BlocksFree doesn't count them.
+That also means the shared allocator can't tell that a block was freed twice. Freeing a block twice is undefined,
+and the block may be handed out twice. Instrumented builds (SMALLBLOCKALLOCATOR_INSTRUMENT) ignore a second Free
+of a block that is still in the calling thread's magazine, but can't see the other threads' magazines.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <stddef.h>
+#include <vector>
+
+namespace Memory
+{
+	class ConcurrentSmallBlockAllocator;
+
+	class ThreadCachedAllocator
+	{
+	public:
+		// Counters for one thread's use of one allocator
+		struct ThreadStats
+		{
+			size_t hits; // Allocs served from the magazine.
+			size_t misses; // Allocs that had to refill the magazine first.
+			size_t drains; // Frees that had to give half the magazine back first.
+		};
+
+		// A failsafe constructor.
+		// BlockSize is how large each block is. BlockCount is how many blocks. MagazineSize is how many blocks each thread can keep.
+		static ThreadCachedAllocator* Create(size_t blockSize, size_t blockCount, size_t magazineSize = 64);
+
+		~ThreadCachedAllocator();
+
+		// Allocate to a block and Free from a Block. Safe to call from any thread.
+		// Alloc returns NULL if size is larger than a block. Free ignores pointers that aren't the start of one of our blocks.
+		void* Alloc(size_t size);
+		void Free(void* ptr);
+
+		// Is the block that contains this pointer being used or sitting in a magazine?
+		bool Contains(void* ptr) const;
+
+		// How many blocks are free and not sitting in a magazine?
+		size_t BlocksFree() const;
+
+		// The counters for the calling thread.
+		ThreadStats Stats();
+
+		// Gives every block in the calling thread's magazine back to the shared allocator.
+		void FlushThread();
+
+	private:
+		// What the magazines need to reach after the ThreadCachedAllocator itself may be gone
+		struct Shared
+		{
+			ConcurrentSmallBlockAllocator* pAllocator;
+			std::atomic<bool> alive;
+			std::mutex mutex; // Stops a thread exiting from draining its magazine while the allocator is being destroyed.
+		};
+
+		// One thread's cache for one allocator
+		struct Magazine
+		{
+			std::shared_ptr<Shared> pShared;
+			size_t allocatorId;
+			std::vector<void*> blocks;
+			ThreadStats stats;
+
+			~Magazine();
+		};
+
+		// Every magazine owned by one thread. Frees them when the thread exits.
+		struct ThreadMagazines
+		{
+			std::vector<Magazine*> magazines;
+			Magazine* pLast; // The last magazine found, since a thread usually uses the same allocator many times in a row.
+
+			ThreadMagazines();
+			~ThreadMagazines();
+		};
+
+		ThreadCachedAllocator(ConcurrentSmallBlockAllocator* pAllocator, size_t magazineSize);
+
+		// Finds or creates the calling thread's magazine for this allocator.
+		Magazine& LocalMagazine();
+		static ThreadMagazines& LocalMagazines();
+
+		std::shared_ptr<Shared> _pShared;
+		size_t _Id; // Unique for every allocator ever created, so a new allocator at an old address doesn't find old magazines.
+		size_t _MagazineSize;
+	};
+
+} // End namespace Memory
+
+#include "ThreadCachedAllocator.inl"
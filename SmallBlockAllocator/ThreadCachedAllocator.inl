@@ -0,0 +1,179 @@
+/*
+An inline file used to define my inline functions for the ThreadCachedAllocator
+*/
+
+#include <algorithm>
+#include <new>
+
+#include "ConcurrentSmallBlockAllocator.h"
+
+namespace Memory
+{
+	inline ThreadCachedAllocator* ThreadCachedAllocator::Create(size_t blockSize, size_t blockCount, size_t magazineSize)
+	{
+		ConcurrentSmallBlockAllocator* pAllocator = ConcurrentSmallBlockAllocator::Create(blockSize, blockCount);
+		if (pAllocator == nullptr)
+			return nullptr;
+
+		ThreadCachedAllocator* pCached = new (std::nothrow) ThreadCachedAllocator(pAllocator, magazineSize < 2 ? 2 : magazineSize);
+		if (pCached == nullptr || !pCached->_pShared)
+		{
+			delete pCached;
+			delete pAllocator;
+			return nullptr;
+		}
+		return pCached;
+	}
+
+	inline ThreadCachedAllocator::ThreadCachedAllocator(ConcurrentSmallBlockAllocator* pAllocator, size_t magazineSize) :
+		_MagazineSize(magazineSize)
+	{
+		static std::atomic<size_t> s_NextId(1);
+		_Id = s_NextId.fetch_add(1);
+
+		Shared* pShared = new (std::nothrow) Shared;
+		if (pShared != nullptr)
+		{
+			pShared->pAllocator = pAllocator;
+			pShared->alive = true;
+			_pShared.reset(pShared);
+		}
+	}
+
+	inline ThreadCachedAllocator::~ThreadCachedAllocator()
+	{
+		if (_pShared)
+		{
+			// Magazines on other threads still point at the shared state. Tell them we're gone before deleting the blocks.
+			std::lock_guard<std::mutex> lock(_pShared->mutex);
+			_pShared->alive = false;
+			delete _pShared->pAllocator;
+			_pShared->pAllocator = nullptr;
+		}
+	}
+
+	inline void* ThreadCachedAllocator::Alloc(size_t size) {
+		if (size > _pShared->pAllocator->BlockSize()) {
+			return nullptr;
+		}
+
+		Magazine& magazine = LocalMagazine();
+
+		if (magazine.blocks.empty()) {
+			// Refill half the magazine so the next few Frees don't have to drain it right away
+			magazine.stats.misses++;
+			magazine.blocks.resize(_MagazineSize / 2);
+			const size_t count = _pShared->pAllocator->AllocBatch(magazine.blocks.size(), magazine.blocks.data());
+			magazine.blocks.resize(count);
+			if (count == 0) {
+				return nullptr;
+			}
+		}
+		else {
+			magazine.stats.hits++;
+		}
+
+		void* ptr = magazine.blocks.back();
+		magazine.blocks.pop_back();
+		return ptr;
+	}
+
+	inline void ThreadCachedAllocator::Free(void* ptr) {
+		// Only our blocks can go in a magazine. This only checks the pool's bounds, which never change, so Free stays off shared memory.
+		if (!_pShared->pAllocator->IsBlock(ptr)) {
+			return;
+		}
+
+		Magazine& magazine = LocalMagazine();
+#if defined(SMALLBLOCKALLOCATOR_INSTRUMENT)
+		// Already in our magazine means it is being freed twice
+		if (std::find(magazine.blocks.begin(), magazine.blocks.end(), ptr) != magazine.blocks.end()) {
+			return;
+		}
+#endif
+		if (magazine.blocks.size() >= _MagazineSize) {
+			// Give the older half back in one batch
+			magazine.stats.drains++;
+			const size_t half = _MagazineSize / 2;
+			_pShared->pAllocator->FreeBatch(magazine.blocks.data(), half);
+			magazine.blocks.erase(magazine.blocks.begin(), magazine.blocks.begin() + half);
+		}
+		magazine.blocks.push_back(ptr);
+	}
+
+	inline bool ThreadCachedAllocator::Contains(void* ptr) const {
+		return _pShared->pAllocator->Contains(ptr);
+	}
+
+	inline size_t ThreadCachedAllocator::BlocksFree() const {
+		return _pShared->pAllocator->BlocksFree();
+	}
+
+	inline ThreadCachedAllocator::ThreadStats ThreadCachedAllocator::Stats() {
+		return LocalMagazine().stats;
+	}
+
+	inline void ThreadCachedAllocator::FlushThread() {
+		Magazine& magazine = LocalMagazine();
+		_pShared->pAllocator->FreeBatch(magazine.blocks.data(), magazine.blocks.size());
+		magazine.blocks.clear();
+	}
+
+	inline ThreadCachedAllocator::Magazine& ThreadCachedAllocator::LocalMagazine() {
+		ThreadMagazines& local = LocalMagazines();
+		if (local.pLast != nullptr && local.pLast->allocatorId == _Id) {
+			return *local.pLast;
+		}
+
+		for (size_t i = 0; i < local.magazines.size(); i++) {
+			if (local.magazines[i]->allocatorId == _Id) {
+				local.pLast = local.magazines[i];
+				return *local.pLast;
+			}
+		}
+
+		// First time this thread has used us. Clean out magazines of allocators that have been destroyed while we're here.
+		for (size_t i = 0; i < local.magazines.size();) {
+			if (!local.magazines[i]->pShared->alive) {
+				delete local.magazines[i];
+				local.magazines[i] = local.magazines.back();
+				local.magazines.pop_back();
+			}
+			else {
+				i++;
+			}
+		}
+
+		Magazine* pMagazine = new Magazine;
+		pMagazine->pShared = _pShared;
+		pMagazine->allocatorId = _Id;
+		pMagazine->blocks.reserve(_MagazineSize);
+		pMagazine->stats = ThreadStats();
+		local.magazines.push_back(pMagazine);
+		local.pLast = pMagazine;
+		return *pMagazine;
+	}
+
+	inline ThreadCachedAllocator::ThreadMagazines& ThreadCachedAllocator::LocalMagazines() {
+		static thread_local ThreadMagazines s_Magazines;
+		return s_Magazines;
+	}
+
+	inline ThreadCachedAllocator::Magazine::~Magazine() {
+		// Give our blocks back if the allocator is still around
+		std::lock_guard<std::mutex> lock(pShared->mutex);
+		if (pShared->alive) {
+			pShared->pAllocator->FreeBatch(blocks.data(), blocks.size());
+		}
+	}
+
+	inline ThreadCachedAllocator::ThreadMagazines::ThreadMagazines() :
+		pLast(nullptr)
+	{}
+
+	inline ThreadCachedAllocator::ThreadMagazines::~ThreadMagazines() {
+		for (size_t i = 0; i < magazines.size(); i++) {
+			delete magazines[i];
+		}
+	}
+}
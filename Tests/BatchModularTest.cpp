@@ -0,0 +1,215 @@
+/*
+Checks the array functions in BatchModular.h against the scalar functions in Functions.h they are named after,
+and pins down how the scalar ModularRange and ModularClamp behave.
+There is no build system here, so build it from the root of the repo with something like
+	g++ -O2 -std=c++11 -I. Tests/BatchModularTest.cpp Math/BatchModular.cpp Math/Functions.cpp Math/Vector3.cpp Math/SIMD.cpp -o BatchModularTest
+It prints every failure and returns 1 if there were any.
+
+The values cover both ends of the space and one float either side of them, one range and many ranges away, NaN,
+and random values within a few ranges. Every count from 0 to 40 is run so the last few values that don't fill a register are covered.
+ModularRange, ModularClamp and ShortestArc must match bit for bit (any NaN matches any NaN).
+ModLerp fuses its multiply and add, so it only has to land on the same point of the space within a few roundings.
+*/
+
+#include <float.h>
+#include <math.h>
+#include <random>
+#include <stdio.h>
+#include <vector>
+
+#include "Math/BatchModular.h"
+#include "Math/Constants.h"
+#include "Math/Functions.h"
+
+namespace
+{
+	int s_Failures = 0;
+
+	struct Space
+	{
+		float min;
+		float max;
+	};
+
+	bool Same(float a, float b)
+	{
+		return (isnan(a) && isnan(b)) || a == b;
+	}
+
+	// Are a and b the same point of the space, give or take a few roundings?
+	bool SamePoint(float a, float b, const Space& space)
+	{
+		if (isnan(a) || isnan(b))
+			return isnan(a) && isnan(b);
+		const float range = space.max - space.min;
+		const float apart = fabsf(a - b);
+		const float around = apart < range - apart ? apart : range - apart;
+		const float scale = fabsf(space.min) > fabsf(space.max) ? fabsf(space.min) : fabsf(space.max);
+		return around <= 4 * FLT_EPSILON * (scale > range ? scale : range);
+	}
+
+	void Check(bool i_Passed, const char* i_Function, const Space& i_Space, size_t i_Count, size_t i_Index, const float* i_pInputs, size_t i_InputCount, float i_Got, float i_Expected)
+	{
+		if (i_Passed)
+			return;
+		if (++s_Failures > 30)
+			return;
+		printf("FAIL %s in [%g, %g) count %zu index %zu inputs", i_Function, i_Space.min, i_Space.max, i_Count, i_Index);
+		for (size_t n = 0; n < i_InputCount; n++)
+			printf(" %.9g", i_pInputs[n]);
+		printf(": got %.9g, scalar %.9g\n", i_Got, i_Expected);
+	}
+
+	// The interesting values of a space
+	void EdgeValues(const Space& space, std::vector<float>& o_Values)
+	{
+		const float range = space.max - space.min;
+		const float bases[] = { space.min, space.max, space.min - range, space.max + range, space.min + 0.5f * range };
+		for (size_t b = 0; b < sizeof(bases) / sizeof(bases[0]); b++)
+		{
+			o_Values.push_back(bases[b]);
+			o_Values.push_back(nextafterf(bases[b], -INFINITY));
+			o_Values.push_back(nextafterf(bases[b], INFINITY));
+		}
+		const float far[] = { 2.0f, 5.0f, 50.0f, 1000.0f };
+		for (size_t f = 0; f < sizeof(far) / sizeof(far[0]); f++)
+		{
+			o_Values.push_back(space.min + far[f] * range + 0.25f * range);
+			o_Values.push_back(space.min - far[f] * range + 0.25f * range);
+		}
+		o_Values.push_back(0.0f);
+		o_Values.push_back(-0.0f);
+		o_Values.push_back(NAN);
+	}
+
+	void CompareSpace(const Space& space, std::mt19937& io_Random)
+	{
+		const float range = space.max - space.min;
+		std::vector<float> values;
+		EdgeValues(space, values);
+		std::uniform_real_distribution<float> near(space.min - 3 * range, space.max + 3 * range);
+		while (values.size() < 160)
+			values.push_back(near(io_Random));
+
+		// Every input array is a shuffle of the same values, so each function sees every pair of edge values sooner or later
+		const size_t MaxCount = 40;
+		const size_t rounds = 200;
+		std::uniform_real_distribution<float> percent(0.0f, 1.0f);
+		for (size_t round = 0; round < rounds; round++)
+		{
+			const size_t count = round % (MaxCount + 1);
+			std::vector<float> a(count), b(count), c(count), t(count), out(count);
+			for (size_t i = 0; i < count; i++)
+			{
+				a[i] = values[io_Random() % values.size()];
+				b[i] = values[io_Random() % values.size()];
+				c[i] = values[io_Random() % values.size()];
+				// Percents include both ends
+				const unsigned int pick = io_Random() % 8;
+				t[i] = pick == 0 ? 0.0f : pick == 1 ? 1.0f : percent(io_Random);
+			}
+
+			Math::Batch::ModularRange(a.data(), out.data(), count, space.min, space.max);
+			for (size_t i = 0; i < count; i++)
+			{
+				const float expected = Math::ModularRange(a[i], space.min, space.max);
+				Check(Same(out[i], expected), "ModularRange", space, count, i, &a[i], 1, out[i], expected);
+			}
+
+			Math::Batch::ModularClamp(a.data(), b.data(), c.data(), out.data(), count, space.min, space.max);
+			for (size_t i = 0; i < count; i++)
+			{
+				const float expected = Math::ModularClamp(a[i], space.min, space.max, b[i], c[i]);
+				const float inputs[] = { a[i], b[i], c[i] };
+				Check(Same(out[i], expected), "ModularClamp", space, count, i, inputs, 3, out[i], expected);
+			}
+
+			Math::Batch::ShortestArc(a.data(), b.data(), out.data(), count, space.min, space.max);
+			for (size_t i = 0; i < count; i++)
+			{
+				const float expected = Math::ShortestArc(a[i], b[i], space.min, space.max);
+				const float inputs[] = { a[i], b[i] };
+				Check(Same(out[i], expected), "ShortestArc", space, count, i, inputs, 2, out[i], expected);
+			}
+
+			Math::Batch::ModLerp(a.data(), b.data(), t.data(), out.data(), count, space.min, space.max);
+			for (size_t i = 0; i < count; i++)
+			{
+				const float expected = Math::ModLerp(a[i], b[i], t[i], space.min, space.max);
+				const float inputs[] = { a[i], b[i], t[i] };
+				Check(SamePoint(out[i], expected, space), "ModLerp", space, count, i, inputs, 3, out[i], expected);
+			}
+		}
+	}
+
+	void Expect(const char* i_What, float i_Got, float i_Expected)
+	{
+		if (!Same(i_Got, i_Expected))
+		{
+			printf("FAIL %s: got %.9g, expected %.9g\n", i_What, i_Got, i_Expected);
+			s_Failures++;
+		}
+	}
+
+	// How the scalar functions behave since they were fixed
+	void PinScalar()
+	{
+		// Values more than one range below min used to come back below min
+		Expect("ModularRange(-725, 0, 360)", Math::ModularRange(-725.0f, 0, 360.0f), 355.0f);
+		Expect("ModularRange(-1000, -180, 180)", Math::ModularRange(-1000.0f, -180.0f, 180.0f), 80.0f);
+		Expect("ModularRange(1085, 0, 360)", Math::ModularRange(1085.0f, 0, 360.0f), 5.0f);
+		// max is the same place as min, and the result is never max
+		Expect("ModularRange(360, 0, 360)", Math::ModularRange(360.0f, 0, 360.0f), 0.0f);
+		Expect("ModularRange(0, 0, 360)", Math::ModularRange(0.0f, 0, 360.0f), 0.0f);
+		// A tiny negative offset rounds up to the whole range, which has to come back as min
+		Expect("ModularRange(-1e-6, 0, 360)", Math::ModularRange(-1e-6f, 0, 360.0f), 0.0f);
+		const float belowMin = nextafterf(0.0f, -INFINITY);
+		const float wrapped = Math::ModularRange(belowMin, 0, 360.0f);
+		if (!(wrapped >= 0 && wrapped < 360.0f))
+		{
+			printf("FAIL ModularRange just below min left the space: %.9g\n", wrapped);
+			s_Failures++;
+		}
+
+		// A clamp that doesn't wrap now sends values outside it to whichever end is closer around the space.
+		// It used to send everything above the max to the min.
+		Expect("ModularClamp(280, [90, 270])", Math::ModularClamp(280.0f, 0, 360.0f, 90.0f, 270.0f), 270.0f);
+		Expect("ModularClamp(350, [90, 270])", Math::ModularClamp(350.0f, 0, 360.0f, 90.0f, 270.0f), 270.0f);
+		Expect("ModularClamp(10, [90, 270])", Math::ModularClamp(10.0f, 0, 360.0f, 90.0f, 270.0f), 90.0f);
+		Expect("ModularClamp(180, [90, 270])", Math::ModularClamp(180.0f, 0, 360.0f, 90.0f, 270.0f), 180.0f);
+		Expect("ModularClamp(90, [90, 270])", Math::ModularClamp(90.0f, 0, 360.0f, 90.0f, 270.0f), 90.0f);
+		// A clamp that wraps past the break point
+		Expect("ModularClamp(300, [270, 90])", Math::ModularClamp(300.0f, 0, 360.0f, 270.0f, 90.0f), 300.0f);
+		Expect("ModularClamp(30, [270, 90])", Math::ModularClamp(30.0f, 0, 360.0f, 270.0f, 90.0f), 30.0f);
+		Expect("ModularClamp(100, [270, 90])", Math::ModularClamp(100.0f, 0, 360.0f, 270.0f, 90.0f), 90.0f);
+		Expect("ModularClamp(260, [270, 90])", Math::ModularClamp(260.0f, 0, 360.0f, 270.0f, 90.0f), 270.0f);
+		// Halfway between the ends goes to the max
+		Expect("ModularClamp(180, [270, 90])", Math::ModularClamp(180.0f, 0, 360.0f, 270.0f, 90.0f), 90.0f);
+		// The clamp ends are wrapped into the space first, and equal ends clamp to that point
+		Expect("ModularClamp(200, [-90, 450])", Math::ModularClamp(200.0f, 0, 360.0f, -90.0f, 450.0f), 270.0f);
+		Expect("ModularClamp(5, [40, 400])", Math::ModularClamp(5.0f, 0, 360.0f, 40.0f, 400.0f), 40.0f);
+
+		Expect("ShortestArc(350, 10)", Math::ShortestArc(350.0f, 10.0f, 0, 360.0f), 20.0f);
+		Expect("ShortestArc(10, 350)", Math::ShortestArc(10.0f, 350.0f, 0, 360.0f), -20.0f);
+	}
+}
+
+int main()
+{
+	const Space spaces[] =
+	{
+		{ 0, 360.0f },
+		{ -180.0f, 180.0f },
+		{ 0, 2 * Math::Pi },
+		{ -Math::Pi, Math::Pi },
+		{ 10.0f, 11.0f },
+	};
+
+	std::mt19937 random(2024);
+	for (size_t s = 0; s < sizeof(spaces) / sizeof(spaces[0]); s++)
+		CompareSpace(spaces[s], random);
+	PinScalar();
+
+	printf("%s: %d failures\n", s_Failures == 0 ? "PASS" : "FAIL", s_Failures);
+	return s_Failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,230 @@
+/*
+Stress tests the ConcurrentBitfield from many threads at once.
+There is no build system here, so build it from the root of the repo with something like
+	g++ -O2 -std=c++17 -pthread -I. Tests/ConcurrentBitfieldTest.cpp -o ConcurrentBitfieldTest
+It prints every failure and returns 1 if there were any. Building with -fsanitize=thread checks the memory ordering too.
+
+Claims: every bit has an owner count. A thread adds one when it claims a bit and takes one away before it releases it,
+so a count above one means the same bit was claimed twice. Releasing a bit we own must report that it was set.
+The field is small so the threads fight over the same words and run it dry.
+Races: every thread sets every bit, then frees every bit, and exactly one thread must see each change happen.
+Then every thread toggles every bit twice, which must leave the field empty.
+After each part the free count must be exact again, and a new claim must get every bit exactly once.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+#include "Bitfield/ConcurrentBitfield.h"
+
+namespace
+{
+	const size_t FieldSize = 1000; // Not a whole number of words, so the last word is partly used.
+	const size_t ThreadCount = 8;
+	const size_t Rounds = 200000;
+	const size_t MaxHeld = 200; // Together the threads want more bits than there are.
+	const size_t MaxBatch = 16;
+
+	std::atomic<int> s_Failures(0);
+
+	void Fail(const char* i_Message, size_t i_Value)
+	{
+		if (s_Failures.fetch_add(1) < 20)
+			printf("FAIL %s (%zu)\n", i_Message, i_Value);
+	}
+
+	struct Shared
+	{
+		ConcurrentBitfield* pField;
+		std::vector<std::atomic<int>> owners; // Claims: how many threads think they own each bit.
+		std::vector<std::atomic<int>> winners; // Races: how many threads saw each bit change.
+
+		Shared() : pField(nullptr), owners(FieldSize), winners(FieldSize) {}
+	};
+
+	void Take(Shared& io_Shared, size_t i_Index, std::vector<size_t>& io_Held)
+	{
+		if (i_Index >= FieldSize)
+		{
+			Fail("a bit past the end of the field was claimed", i_Index);
+			return;
+		}
+		if (io_Shared.owners[i_Index].fetch_add(1, std::memory_order_relaxed) != 0)
+			Fail("a bit was claimed by two owners at once", i_Index);
+		io_Held.push_back(i_Index);
+	}
+
+	size_t Give(Shared& io_Shared, std::vector<size_t>& io_Held)
+	{
+		const size_t index = io_Held.back();
+		io_Held.pop_back();
+		io_Shared.owners[index].fetch_sub(1, std::memory_order_relaxed);
+		return index;
+	}
+
+	void Claimer(Shared& io_Shared, unsigned int i_Seed)
+	{
+		std::mt19937 random(i_Seed);
+		std::vector<size_t> held;
+		size_t batch[MaxBatch];
+
+		for (size_t r = 0; r < Rounds; r++)
+		{
+			const unsigned int action = random() % 4;
+			if (action == 0 && held.size() < MaxHeld)
+			{
+				size_t index;
+				if (io_Shared.pField->ClaimFreeBit(index))
+					Take(io_Shared, index, held);
+			}
+			else if (action == 1 && held.size() + MaxBatch <= MaxHeld)
+			{
+				const size_t got = io_Shared.pField->ClaimFreeBits(1 + random() % MaxBatch, batch);
+				for (size_t i = 0; i < got; i++)
+					Take(io_Shared, batch[i], held);
+			}
+			else if (action == 2 && !held.empty())
+			{
+				std::swap(held[random() % held.size()], held.back());
+				const size_t index = Give(io_Shared, held);
+				if (!io_Shared.pField->FreeBit(index))
+					Fail("freeing a claimed bit found it already free", index);
+			}
+			else if (action == 3 && !held.empty())
+			{
+				const size_t count = std::min(held.size(), static_cast<size_t>(1 + random() % MaxBatch));
+				for (size_t i = 0; i < count; i++)
+					batch[i] = Give(io_Shared, held);
+				if (io_Shared.pField->ReleaseBits(batch, count) != count)
+					Fail("releasing claimed bits found some already free", count);
+			}
+		}
+
+		while (!held.empty())
+		{
+			const size_t index = Give(io_Shared, held);
+			if (!io_Shared.pField->FreeBit(index))
+				Fail("freeing a claimed bit found it already free", index);
+		}
+	}
+
+	// Every thread visits every bit in its own order, so the threads meet on the same words at different times
+	void Racer(Shared& io_Shared, unsigned int i_Seed, int i_Part)
+	{
+		std::vector<size_t> order(FieldSize);
+		for (size_t i = 0; i < FieldSize; i++)
+			order[i] = i;
+		std::shuffle(order.begin(), order.end(), std::mt19937(i_Seed));
+
+		for (size_t i = 0; i < FieldSize; i++)
+		{
+			const size_t index = order[i];
+			if (i_Part == 0 && io_Shared.pField->SetBit(index))
+				io_Shared.winners[index].fetch_add(1, std::memory_order_relaxed);
+			else if (i_Part == 1 && io_Shared.pField->FreeBit(index))
+				io_Shared.winners[index].fetch_add(1, std::memory_order_relaxed);
+			else if (i_Part == 2)
+			{
+				io_Shared.pField->ToggleBit(index);
+				io_Shared.pField->ToggleBit(index);
+			}
+		}
+	}
+
+	template<typename Function>
+	void RunThreads(Function function)
+	{
+		std::vector<std::thread> threads;
+		for (size_t t = 0; t < ThreadCount; t++)
+			threads.push_back(std::thread(function, static_cast<unsigned int>(t + 1)));
+		for (size_t t = 0; t < ThreadCount; t++)
+			threads[t].join();
+	}
+
+	// Once the threads are done the field should be empty, with an exact free count
+	void CheckEmpty(Shared& io_Shared, const char* i_Part)
+	{
+		if (io_Shared.pField->FreeBits() != FieldSize)
+		{
+			printf("FAIL after %s the free count is %zu\n", i_Part, io_Shared.pField->FreeBits());
+			s_Failures++;
+		}
+		for (size_t i = 0; i < FieldSize; i++)
+		{
+			if ((*io_Shared.pField)[i])
+			{
+				printf("FAIL after %s bit %zu is still set\n", i_Part, i);
+				s_Failures++;
+				break;
+			}
+		}
+	}
+
+	void CheckWinners(Shared& io_Shared, const char* i_Part)
+	{
+		for (size_t i = 0; i < FieldSize; i++)
+		{
+			if (io_Shared.winners[i].exchange(0) != 1)
+			{
+				printf("FAIL %s: bit %zu didn't change for exactly one thread\n", i_Part, i);
+				s_Failures++;
+				break;
+			}
+		}
+	}
+}
+
+int main()
+{
+	Shared shared;
+	shared.pField = ConcurrentBitfield::Create(FieldSize);
+	if (shared.pField == nullptr)
+	{
+		printf("FAIL couldn't create the field\n");
+		return 1;
+	}
+
+	RunThreads([&shared](unsigned int seed) { Claimer(shared, seed); });
+	for (size_t i = 0; i < FieldSize; i++)
+	{
+		if (shared.owners[i].load() != 0)
+			Fail("a bit still has an owner", i);
+	}
+	CheckEmpty(shared, "claiming");
+
+	RunThreads([&shared](unsigned int seed) { Racer(shared, seed, 0); });
+	CheckWinners(shared, "setting");
+	if (shared.pField->FreeBits() != 0)
+		Fail("every bit was set but the free count is", shared.pField->FreeBits());
+	RunThreads([&shared](unsigned int seed) { Racer(shared, seed, 1); });
+	CheckWinners(shared, "freeing");
+	CheckEmpty(shared, "setting and freeing");
+
+	RunThreads([&shared](unsigned int seed) { Racer(shared, seed, 2); });
+	CheckEmpty(shared, "toggling");
+
+	// The field is whole again, so one claim should get every bit once and then find nothing
+	std::vector<size_t> all(FieldSize + 1);
+	if (shared.pField->ClaimFreeBits(FieldSize + 1, all.data()) != FieldSize)
+		Fail("couldn't claim every bit again after the threads finished", FieldSize);
+	std::sort(all.begin(), all.begin() + FieldSize);
+	for (size_t i = 0; i < FieldSize; i++)
+	{
+		if (all[i] != i)
+		{
+			Fail("the final claim missed a bit", i);
+			break;
+		}
+	}
+	size_t extra;
+	if (shared.pField->ClaimFreeBit(extra))
+		Fail("a full field gave out another bit", extra);
+
+	delete shared.pField;
+	printf("%s: %d failures\n", s_Failures.load() == 0 ? "PASS" : "FAIL", s_Failures.load());
+	return s_Failures.load() == 0 ? 0 : 1;
+}
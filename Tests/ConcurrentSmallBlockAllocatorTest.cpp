@@ -0,0 +1,181 @@
+/*
+Stress tests the ConcurrentSmallBlockAllocator from many threads at once.
+There is no build system here, so build it from the root of the repo with something like
+	g++ -O2 -std=c++17 -pthread -I. Tests/ConcurrentSmallBlockAllocatorTest.cpp -o ConcurrentSmallBlockAllocatorTest
+It prints every failure and returns 1 if there were any. Building with -fsanitize=thread checks the memory ordering too.
+
+Every block has an owner count. A thread adds one when it gets a block and takes one away before it frees it,
+so a count above one means the same block was handed to two owners at once.
+Each thread also writes its own id over the blocks it holds and checks it is still there before freeing,
+which catches a block handed out twice even if the counts happen to line up.
+The pool is small so the threads fight over the same words and run it dry.
+*/
+
+#include <atomic>
+#include <random>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#include "SmallBlockAllocator/ConcurrentSmallBlockAllocator.h"
+
+namespace
+{
+	const size_t BlockSize = 32;
+	const size_t BlockCount = 1000; // Not a whole number of words, so the last word is partly used.
+	const size_t ThreadCount = 8;
+	const size_t Rounds = 200000;
+	const size_t MaxHeld = 200; // Together the threads want more blocks than there are.
+
+	std::atomic<int> s_Failures(0);
+
+	void Fail(const char* i_Message, size_t i_Value)
+	{
+		if (s_Failures.fetch_add(1) < 20)
+			printf("FAIL %s (%zu)\n", i_Message, i_Value);
+	}
+
+	struct Shared
+	{
+		Memory::ConcurrentSmallBlockAllocator* pAllocator;
+		char* pFirst; // Where block 0 is, found from the first block anyone gets.
+		std::vector<std::atomic<int>> owners;
+
+		Shared() : pAllocator(nullptr), pFirst(nullptr), owners(BlockCount) {}
+	};
+
+	size_t IndexOf(Shared& io_Shared, void* ptr)
+	{
+		return (reinterpret_cast<char*>(ptr) - io_Shared.pFirst) / BlockSize;
+	}
+
+	void Take(Shared& io_Shared, void* ptr, unsigned char i_Id, std::vector<void*>& io_Held)
+	{
+		const size_t index = IndexOf(io_Shared, ptr);
+		if (index >= BlockCount || reinterpret_cast<char*>(ptr) != io_Shared.pFirst + index * BlockSize)
+		{
+			Fail("a block outside the pool was handed out", index);
+			return;
+		}
+		const int before = io_Shared.owners[index].fetch_add(1, std::memory_order_relaxed);
+		if (before != 0)
+			Fail("a block was handed to two owners at once", index);
+		memset(ptr, i_Id, BlockSize);
+		io_Held.push_back(ptr);
+	}
+
+	void Release(Shared& io_Shared, void* ptr, unsigned char i_Id)
+	{
+		const unsigned char* pBytes = reinterpret_cast<unsigned char*>(ptr);
+		for (size_t b = 0; b < BlockSize; b++)
+		{
+			if (pBytes[b] != i_Id)
+			{
+				Fail("another thread wrote to a block we owned", IndexOf(io_Shared, ptr));
+				break;
+			}
+		}
+		io_Shared.owners[IndexOf(io_Shared, ptr)].fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	void Worker(Shared& io_Shared, unsigned char i_Id)
+	{
+		std::mt19937 random(i_Id);
+		std::vector<void*> held;
+		void* batch[16];
+
+		for (size_t r = 0; r < Rounds; r++)
+		{
+			const unsigned int action = random() % 4;
+			if (action == 0 && held.size() < MaxHeld)
+			{
+				void* ptr = io_Shared.pAllocator->Alloc(BlockSize);
+				if (ptr != nullptr)
+					Take(io_Shared, ptr, i_Id, held);
+			}
+			else if (action == 1 && held.size() + 16 <= MaxHeld)
+			{
+				const size_t got = io_Shared.pAllocator->AllocBatch(1 + random() % 16, batch);
+				for (size_t i = 0; i < got; i++)
+					Take(io_Shared, batch[i], i_Id, held);
+			}
+			else if (action == 2 && !held.empty())
+			{
+				const size_t pick = random() % held.size();
+				void* ptr = held[pick];
+				held[pick] = held.back();
+				held.pop_back();
+				Release(io_Shared, ptr, i_Id);
+				io_Shared.pAllocator->Free(ptr);
+			}
+			else if (action == 3 && !held.empty())
+			{
+				const size_t count = held.size() < 16 ? held.size() : 1 + random() % 16;
+				const size_t freeCount = count < held.size() ? count : held.size();
+				for (size_t i = 0; i < freeCount; i++)
+				{
+					batch[i] = held.back();
+					held.pop_back();
+					Release(io_Shared, batch[i], i_Id);
+				}
+				io_Shared.pAllocator->FreeBatch(batch, freeCount);
+			}
+		}
+
+		for (size_t i = 0; i < held.size(); i++)
+		{
+			Release(io_Shared, held[i], i_Id);
+			io_Shared.pAllocator->Free(held[i]);
+		}
+	}
+}
+
+int main()
+{
+	Shared shared;
+	shared.pAllocator = Memory::ConcurrentSmallBlockAllocator::Create(BlockSize, BlockCount);
+	if (shared.pAllocator == nullptr)
+	{
+		printf("FAIL couldn't create the allocator\n");
+		return 1;
+	}
+
+	// Find block 0 by taking every block once. Blocks come out lowest first from an empty pool.
+	std::vector<void*> all(BlockCount);
+	if (shared.pAllocator->AllocBatch(BlockCount, all.data()) != BlockCount || shared.pAllocator->Alloc(BlockSize) != nullptr)
+		Fail("a new pool didn't hand out exactly every block", BlockCount);
+	shared.pFirst = reinterpret_cast<char*>(all[0]);
+	for (size_t i = 1; i < BlockCount; i++)
+	{
+		if (all[i] < shared.pFirst)
+			shared.pFirst = reinterpret_cast<char*>(all[i]);
+	}
+	shared.pAllocator->FreeBatch(all.data(), BlockCount);
+
+	if (shared.pAllocator->Alloc(BlockSize + 1) != nullptr)
+		Fail("Alloc handed out a block smaller than the size asked for", BlockSize + 1);
+
+	std::vector<std::thread> threads;
+	for (size_t t = 0; t < ThreadCount; t++)
+		threads.push_back(std::thread(Worker, std::ref(shared), static_cast<unsigned char>(t + 1)));
+	for (size_t t = 0; t < ThreadCount; t++)
+		threads[t].join();
+
+	// Everything was given back, so the pool should be whole again
+	if (shared.pAllocator->BlocksFree() != BlockCount)
+		Fail("blocks went missing, BlocksFree is", shared.pAllocator->BlocksFree());
+	for (size_t i = 0; i < BlockCount; i++)
+	{
+		if (shared.owners[i].load() != 0)
+			Fail("a block still has an owner", i);
+		if (shared.pAllocator->Contains(shared.pFirst + i * BlockSize))
+			Fail("a block is still marked in use", i);
+	}
+	if (shared.pAllocator->AllocBatch(BlockCount, all.data()) != BlockCount)
+		Fail("couldn't hand out every block again after the threads finished", BlockCount);
+
+	delete shared.pAllocator;
+	printf("%s: %d failures\n", s_Failures.load() == 0 ? "PASS" : "FAIL", s_Failures.load());
+	return s_Failures.load() == 0 ? 0 : 1;
+}
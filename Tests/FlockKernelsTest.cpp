@@ -0,0 +1,204 @@
+/*
+Checks the FlockKernels against sums worked out in double precision.
+There is no build system here, so build it from the root of the repo with something like
+	g++ -O2 -std=c++11 -I. Tests/FlockKernelsTest.cpp Flocking/FlockKernels.cpp Math/SIMD.cpp -o FlockKernelsTest
+It prints every failure and returns 1 if there were any.
+
+FlockKernels.h promises each separation term is within 1e-6 of the exact value relative to its size.
+A single term is checked by filling a block with 8 copies of the same neighbor. Adding copies of one value doubles it exactly,
+so the SIMD kernels' sums are exactly 8 times the term they calculated.
+Blocks of different neighbors also pick up the rounding of adding the terms up, so those are allowed
+1e-6 of the terms' total size plus one float epsilon of it per neighbor.
+*/
+
+#include <float.h>
+#include <math.h>
+#include <random>
+#include <stdio.h>
+
+#include "Flocking/FlockKernels.h"
+#include "Math/SIMD.h"
+
+namespace
+{
+	const double TermBound = 1e-6;
+
+	int s_Failures = 0;
+
+	struct Kernel
+	{
+		const char* name;
+		AI::FlockKernels::AccumulateFunction function;
+		size_t copies; // How many copies of a neighbor make the kernel add it in SIMD lanes.
+	};
+
+	// The exact sums and the total size of what went into each one
+	struct Exact
+	{
+		double sums[9];
+		double sizes[3];
+	};
+
+	void Reference(const AI::NeighborBlock& i_Neighbors, float i_X, float i_Y, float i_Z, Exact& o_Exact)
+	{
+		for (size_t s = 0; s < 9; s++)
+			o_Exact.sums[s] = 0;
+		for (size_t s = 0; s < 3; s++)
+			o_Exact.sizes[s] = 0;
+
+		for (size_t i = 0; i < i_Neighbors.Count(); i++)
+		{
+			const double dx = static_cast<double>(i_X) - i_Neighbors.positionX[i];
+			const double dy = static_cast<double>(i_Y) - i_Neighbors.positionY[i];
+			const double dz = static_cast<double>(i_Z) - i_Neighbors.positionZ[i];
+			const double lengthSqr = dx * dx + dy * dy + dz * dz;
+			if (lengthSqr != 0)
+			{
+				o_Exact.sums[0] += dx / lengthSqr;
+				o_Exact.sums[1] += dy / lengthSqr;
+				o_Exact.sums[2] += dz / lengthSqr;
+				o_Exact.sizes[0] += 1.0 / sqrt(lengthSqr);
+			}
+			o_Exact.sums[3] += i_Neighbors.velocityX[i];
+			o_Exact.sums[4] += i_Neighbors.velocityY[i];
+			o_Exact.sums[5] += i_Neighbors.velocityZ[i];
+			o_Exact.sizes[1] += fabs(i_Neighbors.velocityX[i]) + fabs(i_Neighbors.velocityY[i]) + fabs(i_Neighbors.velocityZ[i]);
+			o_Exact.sums[6] += i_Neighbors.positionX[i];
+			o_Exact.sums[7] += i_Neighbors.positionY[i];
+			o_Exact.sums[8] += i_Neighbors.positionZ[i];
+			o_Exact.sizes[2] += fabs(i_Neighbors.positionX[i]) + fabs(i_Neighbors.positionY[i]) + fabs(i_Neighbors.positionZ[i]);
+		}
+	}
+
+	void Compare(const char* i_Kernel, const char* i_Case, const AI::SteeringSums& i_Sums, const Exact& i_Exact, double i_Scale, const double i_Allowed[3])
+	{
+		const float* pSums = &i_Sums.separationX;
+		static const char* s_Names[9] = { "separationX", "separationY", "separationZ", "velocityX", "velocityY", "velocityZ", "positionX", "positionY", "positionZ" };
+		for (size_t s = 0; s < 9; s++)
+		{
+			const double error = fabs(pSums[s] * i_Scale - i_Exact.sums[s]);
+			if (!(error <= i_Allowed[s / 3]))
+			{
+				printf("FAIL %s %s %s: got %.9g, exact %.9g, error %.3g, allowed %.3g\n", i_Kernel, i_Case, s_Names[s], pSums[s] * i_Scale, i_Exact.sums[s], error, i_Allowed[s / 3]);
+				s_Failures++;
+			}
+		}
+	}
+
+	// One neighbor at distance i_Distance in direction (i_DirX, i_DirY, i_DirZ), checked against the per term bound
+	void CheckTerm(const Kernel& i_Kernel, float i_X, float i_Y, float i_Z, float i_Distance, float i_DirX, float i_DirY, float i_DirZ)
+	{
+		const float length = sqrtf(i_DirX * i_DirX + i_DirY * i_DirY + i_DirZ * i_DirZ);
+		const float nx = i_X + i_DirX / length * i_Distance;
+		const float ny = i_Y + i_DirY / length * i_Distance;
+		const float nz = i_Z + i_DirZ / length * i_Distance;
+		if (nx == i_X && ny == i_Y && nz == i_Z)
+			return;
+
+		AI::NeighborBlock neighbors;
+		for (size_t c = 0; c < i_Kernel.copies; c++)
+			neighbors.Add(nx, ny, nz, 1.0f, -2.0f, 0.5f);
+
+		AI::NeighborBlock one;
+		one.Add(nx, ny, nz, 1.0f, -2.0f, 0.5f);
+		Exact exact;
+		Reference(one, i_X, i_Y, i_Z, exact);
+
+		AI::SteeringSums sums;
+		i_Kernel.function(neighbors, i_X, i_Y, i_Z, sums);
+
+		// Only separation is approximated. The copies of the velocities and positions add up exactly too.
+		const double allowed[3] = { TermBound * exact.sizes[0], FLT_EPSILON * exact.sizes[1], FLT_EPSILON * exact.sizes[2] };
+		char name[64];
+		snprintf(name, sizeof(name), "term at distance %g", i_Distance);
+		Compare(i_Kernel.name, name, sums, exact, 1.0 / i_Kernel.copies, allowed);
+	}
+
+	void CheckTerms(const Kernel& i_Kernel)
+	{
+		std::mt19937 random(7);
+		std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+		std::uniform_real_distribution<float> place(-1000.0f, 1000.0f);
+
+		// Ordinary distances, and neighbors almost on top of the agent down to where the squared distance stops being a normal float
+		const float distances[] = { 50.0f, 10.0f, 1.0f, 0.1f, 1e-3f, 1e-6f, 1e-9f, 1e-12f, 1e-15f, 1e-18f };
+		for (size_t d = 0; d < sizeof(distances) / sizeof(distances[0]); d++)
+		{
+			for (int trial = 0; trial < 200; trial++)
+			{
+				// Tiny distances only survive rounding near the origin
+				const float scale = distances[d] < 1e-3f ? 0.0f : 1.0f;
+				float dx = unit(random), dy = unit(random), dz = unit(random);
+				if (dx == 0 && dy == 0 && dz == 0)
+					dx = 1;
+				CheckTerm(i_Kernel, place(random) * scale, place(random) * scale, place(random) * scale, distances[d], dx, dy, dz);
+			}
+		}
+	}
+
+	void CheckBlocks(const Kernel& i_Kernel)
+	{
+		std::mt19937 random(11);
+		std::uniform_real_distribution<float> offset(-5.0f, 5.0f);
+		std::uniform_real_distribution<float> close(-1e-3f, 1e-3f);
+		std::uniform_real_distribution<float> speed(-10.0f, 10.0f);
+
+		// Every count up to a few full registers, so the scalar tail after the SIMD loop is covered too
+		for (size_t count = 0; count <= 67; count++)
+		{
+			for (int trial = 0; trial < 20; trial++)
+			{
+				const float x = offset(random) * 100.0f, y = offset(random) * 100.0f, z = offset(random) * 100.0f;
+				AI::NeighborBlock neighbors;
+				for (size_t i = 0; i < count; i++)
+				{
+					// Every fifth neighbor is very close, and one of them sits right on the agent
+					if (i == 3)
+						neighbors.Add(x, y, z, speed(random), speed(random), speed(random));
+					else if (i % 5 == 0)
+						neighbors.Add(x + close(random), y + close(random), z + close(random), speed(random), speed(random), speed(random));
+					else
+						neighbors.Add(x + offset(random), y + offset(random), z + offset(random), speed(random), speed(random), speed(random));
+				}
+
+				Exact exact;
+				Reference(neighbors, x, y, z, exact);
+				AI::SteeringSums sums;
+				i_Kernel.function(neighbors, x, y, z, sums);
+
+				const double rounding = static_cast<double>(count + 1) * FLT_EPSILON;
+				const double allowed[3] = { (TermBound + rounding) * exact.sizes[0], rounding * exact.sizes[1], rounding * exact.sizes[2] };
+				char name[64];
+				snprintf(name, sizeof(name), "block of %zu", count);
+				Compare(i_Kernel.name, name, sums, exact, 1.0, allowed);
+			}
+		}
+	}
+}
+
+int main()
+{
+	const Math::SIMD::Level level = Math::SIMD::Supported();
+	Kernel kernels[3] =
+	{
+		{ "Scalar", AI::FlockKernels::AccumulateScalar, 1 },
+		{ "SSE", AI::FlockKernels::AccumulateSSE, 8 },
+		{ "AVX2", AI::FlockKernels::AccumulateAVX2, 8 },
+	};
+	size_t kernelCount = 1;
+	if (level >= Math::SIMD::SSE2)
+		kernelCount = 2;
+	if (level >= Math::SIMD::AVX2)
+		kernelCount = 3;
+
+	for (size_t k = 0; k < kernelCount; k++)
+	{
+		CheckTerms(kernels[k]);
+		CheckBlocks(kernels[k]);
+	}
+	for (size_t k = kernelCount; k < 3; k++)
+		printf("SKIP %s: this CPU doesn't support it\n", kernels[k].name);
+
+	printf("%s: %d failures\n", s_Failures == 0 ? "PASS" : "FAIL", s_Failures);
+	return s_Failures == 0 ? 0 : 1;
+}
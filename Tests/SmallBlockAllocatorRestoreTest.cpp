@@ -0,0 +1,184 @@
+/*
+Checks that SmallBlockAllocator::Restore only trusts which blocks a file marks in use, and rejects files that don't add up.
+There is no build system here, so build it from the root of the repo with something like
+	g++ -O2 -std=c++11 -I. Tests/SmallBlockAllocatorRestoreTest.cpp -o SmallBlockAllocatorRestoreTest
+It prints every failure and returns 1 if there were any. It writes and removes SmallBlockAllocatorRestoreTest.saved in the current directory.
+
+The pool has more than 4096 blocks so its Bitfield keeps summary levels, and a block count that leaves the last word partly used.
+A saved file is the header, then the blocks padded to a whole word, then the Bitfield's words followed by its summary levels.
+Files with zeroed or filled summaries must restore with the same blocks in use, and every later Alloc must hand out a free block.
+Files whose free count or padding bits disagree with the words, or that are cut short, must not restore at all.
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "SmallBlockAllocator/SmallBlockAllocator.h"
+
+namespace
+{
+	const size_t BlockSize = 16;
+	const size_t BlockCount = 6500;
+	const size_t UsedBlocks = 128; // Blocks 0 to 127 are in use when saved.
+	const char* Path = "SmallBlockAllocatorRestoreTest.saved";
+
+	// Where the saved header keeps these. See SmallBlockAllocator::SavedHeader.
+	const size_t HeaderBytes = 64;
+	const size_t FreeBlocksOffset = 32;
+	const size_t BlockBytesOffset = 40;
+	const size_t BitfieldWordsOffset = 48;
+
+	int s_Failures = 0;
+
+	void Fail(const char* i_Case, const char* i_Message)
+	{
+		printf("FAIL %s: %s\n", i_Case, i_Message);
+		s_Failures++;
+	}
+
+	uint64_t ReadField(const std::vector<char>& i_File, size_t i_Offset)
+	{
+		uint64_t value;
+		memcpy(&value, &i_File[i_Offset], sizeof(value));
+		return value;
+	}
+
+	void WriteFile(const std::vector<char>& i_File)
+	{
+		FILE* pFile = fopen(Path, "wb");
+		fwrite(i_File.data(), 1, i_File.size(), pFile);
+		fclose(pFile);
+	}
+
+	std::vector<char> SaveOriginal()
+	{
+		Memory::SmallBlockAllocator* pAllocator = Memory::SmallBlockAllocator::Create(BlockSize, BlockCount);
+		for (size_t i = 0; i < UsedBlocks; i++)
+		{
+			memset(pAllocator->Alloc(BlockSize), static_cast<int>(i), BlockSize);
+		}
+		pAllocator->Save(Path);
+		delete pAllocator;
+
+		std::vector<char> file;
+		FILE* pFile = fopen(Path, "rb");
+		char buffer[4096];
+		size_t read;
+		while ((read = fread(buffer, 1, sizeof(buffer), pFile)) > 0)
+		{
+			file.insert(file.end(), buffer, buffer + read);
+		}
+		fclose(pFile);
+		return file;
+	}
+
+	// Restores the file and checks the same blocks are in use, then allocates until the pool is full and checks every block handed out was free
+	void ExpectRestored(const char* i_Case, const std::vector<char>& i_File)
+	{
+		WriteFile(i_File);
+		Memory::SmallBlockAllocator* pAllocator = Memory::SmallBlockAllocator::Restore(Path);
+		if (pAllocator == nullptr)
+		{
+			Fail(i_Case, "the file was rejected");
+			return;
+		}
+
+		if (pAllocator->BlocksFree() != BlockCount - UsedBlocks)
+			Fail(i_Case, "the free count is wrong");
+		for (size_t i = 0; i < UsedBlocks; i++)
+		{
+			const unsigned char* pBlock = reinterpret_cast<const unsigned char*>(pAllocator->FromHandle(i));
+			if (!pAllocator->Contains(const_cast<unsigned char*>(pBlock)) || pBlock[0] != static_cast<unsigned char>(i))
+			{
+				Fail(i_Case, "a saved block came back free or changed");
+				break;
+			}
+		}
+
+		std::vector<bool> handedOut(BlockCount, false);
+		size_t allocated = 0;
+		while (void* ptr = pAllocator->Alloc(BlockSize))
+		{
+			const size_t handle = pAllocator->HandleOf(ptr);
+			if (handle < UsedBlocks || handle >= BlockCount || handedOut[handle])
+			{
+				Fail(i_Case, "Alloc handed out a block already in use");
+				break;
+			}
+			if (allocated == 0 && handle != UsedBlocks)
+				Fail(i_Case, "the first Alloc didn't take the first free block");
+			handedOut[handle] = true;
+			allocated++;
+		}
+		if (allocated != BlockCount - UsedBlocks && s_Failures == 0)
+			Fail(i_Case, "the pool ran out before every free block was handed out");
+		delete pAllocator;
+	}
+
+	void ExpectRejected(const char* i_Case, const std::vector<char>& i_File)
+	{
+		WriteFile(i_File);
+		Memory::SmallBlockAllocator* pAllocator = Memory::SmallBlockAllocator::Restore(Path);
+		if (pAllocator != nullptr)
+		{
+			Fail(i_Case, "the file was restored");
+			delete pAllocator;
+		}
+	}
+}
+
+int main()
+{
+	const std::vector<char> original = SaveOriginal();
+	const size_t wordsOffset = HeaderBytes + static_cast<size_t>(ReadField(original, BlockBytesOffset));
+	const size_t fieldWords = (BlockCount + 63) / 64;
+	const size_t storageWords = static_cast<size_t>(ReadField(original, BitfieldWordsOffset));
+	if (storageWords <= fieldWords || original.size() != wordsOffset + storageWords * sizeof(uint64_t))
+	{
+		Fail("setup", "the saved file isn't laid out as expected");
+		return 1;
+	}
+	const size_t summaryOffset = wordsOffset + fieldWords * sizeof(uint64_t);
+
+	ExpectRestored("intact", original);
+
+	std::vector<char> file = original;
+	memset(&file[summaryOffset], 0, file.size() - summaryOffset);
+	ExpectRestored("zeroed summaries", file);
+
+	file = original;
+	memset(&file[summaryOffset], 0xFF, file.size() - summaryOffset);
+	ExpectRestored("filled summaries", file);
+
+	// Each summary word is set to whatever its position's byte happens to be
+	file = original;
+	for (size_t i = summaryOffset; i < file.size(); i++)
+	{
+		file[i] = static_cast<char>(i * 37);
+	}
+	ExpectRestored("scrambled summaries", file);
+
+	file = original;
+	const uint64_t freeBlocks = ReadField(original, FreeBlocksOffset) - 1;
+	memcpy(&file[FreeBlocksOffset], &freeBlocks, sizeof(freeBlocks));
+	ExpectRejected("free count one short", file);
+
+	file = original;
+	file[wordsOffset] ^= 1;
+	ExpectRejected("a block's in use bit flipped", file);
+
+	// The last bit of the last field word is past the last block
+	file = original;
+	file[summaryOffset - 1] |= static_cast<char>(0x80);
+	ExpectRejected("a padding bit set", file);
+
+	file = original;
+	file.resize(file.size() - 1);
+	ExpectRejected("cut short", file);
+
+	remove(Path);
+	printf("%s: %d failures\n", s_Failures == 0 ? "PASS" : "FAIL", s_Failures);
+	return s_Failures == 0 ? 0 : 1;
+}
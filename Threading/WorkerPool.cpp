@@ -0,0 +1,139 @@
+/*
+	This is the complementary cpp file for WorkerPool.h
+*/
+
+#include "WorkerPool.h"
+
+namespace Threading
+{
+	WorkerPool* WorkerPool::Create(size_t threadCount)
+	{
+		WorkerPool* pPool = new WorkerPool();
+		if (pPool == nullptr)
+		{
+			return nullptr;
+		}
+
+		try
+		{
+			for (size_t i = 1; i < threadCount; i++)
+			{
+				pPool->m_Threads.push_back(std::thread(&WorkerPool::WorkerMain, pPool, i));
+			}
+		}
+		catch (...)
+		{
+			// Could not start every thread. The destructor stops the ones that did start.
+			delete pPool;
+			return nullptr;
+		}
+
+		return pPool;
+	}
+
+	WorkerPool::WorkerPool() :
+		m_pJob(nullptr),
+		m_Count(0),
+		m_ChunkSize(1),
+		m_ChunkCount(0),
+		m_Generation(0),
+		m_Quit(false),
+		m_NextChunk(0),
+		m_WorkersBusy(0)
+	{
+	}
+
+	WorkerPool::~WorkerPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Quit = true;
+		}
+		m_WorkReady.notify_all();
+
+		for (size_t i = 0; i < m_Threads.size(); i++)
+		{
+			m_Threads[i].join();
+		}
+	}
+
+	void WorkerPool::ParallelFor(size_t count, size_t chunkSize, const Job& i_Job)
+	{
+		if (count == 0)
+		{
+			return;
+		}
+		if (chunkSize == 0)
+		{
+			chunkSize = 1;
+		}
+
+		// Nothing to split up, so don't bother waking anyone
+		if (m_Threads.empty() || count <= chunkSize)
+		{
+			i_Job(0, count, 0);
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_pJob = &i_Job;
+			m_Count = count;
+			m_ChunkSize = chunkSize;
+			m_ChunkCount = (count + chunkSize - 1) / chunkSize;
+			m_NextChunk = 0;
+			m_WorkersBusy = m_Threads.size();
+			m_Generation++;
+		}
+		m_WorkReady.notify_all();
+
+		// Help out instead of sitting idle
+		RunChunks(0);
+
+		// Wait for the workers to let go of the job before it goes out of scope
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		m_WorkDone.wait(lock, [this] { return m_WorkersBusy == 0; });
+		m_pJob = nullptr;
+	}
+
+	void WorkerPool::WorkerMain(size_t i_Worker)
+	{
+		size_t generation = 0;
+		for (;;)
+		{
+			{
+				std::unique_lock<std::mutex> lock(m_Mutex);
+				m_WorkReady.wait(lock, [this, generation] { return m_Quit || m_Generation != generation; });
+				if (m_Quit)
+				{
+					return;
+				}
+				generation = m_Generation;
+			}
+
+			RunChunks(i_Worker);
+
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				m_WorkersBusy--;
+			}
+			m_WorkDone.notify_one();
+		}
+	}
+
+	void WorkerPool::RunChunks(size_t i_Worker)
+	{
+		for (;;)
+		{
+			const size_t chunk = m_NextChunk.fetch_add(1);
+			if (chunk >= m_ChunkCount)
+			{
+				return;
+			}
+
+			const size_t begin = chunk * m_ChunkSize;
+			const size_t end = begin + m_ChunkSize < m_Count ? begin + m_ChunkSize : m_Count;
+			(*m_pJob)(begin, end, i_Worker);
+		}
+	}
+}
@@ -0,0 +1,64 @@
+/*
+The WorkerPool owns a set of threads that sleep until they are given work.
+ParallelFor splits a range of indices into chunks and hands the chunks out to the workers.
+The thread that calls ParallelFor works on chunks as well, and does not return until every chunk is done.
+
+Which worker runs a chunk changes from call to call, so a job should only use the worker index
+to pick scratch memory, never to decide what result to write.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Threading
+{
+	class WorkerPool
+	{
+	public:
+		// The job run on each chunk. Gets the range [begin, end) and the index of the worker running it.
+		typedef std::function<void(size_t i_Begin, size_t i_End, size_t i_Worker)> Job;
+
+		// Static failsafe constructor. Will return NULL if the threads could not be started.
+		// threadCount includes the calling thread, so a pool of 1 starts no threads and runs everything inline.
+		static WorkerPool* Create(size_t threadCount);
+
+		~WorkerPool();
+
+		// Runs i_Job over [0, count) in chunks of at most chunkSize. Blocks until every chunk is done.
+		void ParallelFor(size_t count, size_t chunkSize, const Job& i_Job);
+
+		// How many threads work on a ParallelFor, including the calling thread.
+		size_t ThreadCount() const { return m_Threads.size() + 1; }
+
+	private:
+		WorkerPool();
+
+		// The loop each worker thread runs until the pool is destroyed.
+		void WorkerMain(size_t i_Worker);
+		// Takes chunks from the current job until there are none left.
+		void RunChunks(size_t i_Worker);
+
+		std::vector<std::thread> m_Threads;
+		std::mutex m_Mutex;
+		std::condition_variable m_WorkReady;
+		std::condition_variable m_WorkDone;
+
+		// The current job. Only changed while no worker is running chunks.
+		const Job* m_pJob;
+		size_t m_Count;
+		size_t m_ChunkSize;
+		size_t m_ChunkCount;
+		size_t m_Generation; // Increased for every job so sleeping workers know there is new work.
+		bool m_Quit;
+
+		std::atomic<size_t> m_NextChunk;
+		size_t m_WorkersBusy; // Workers that have not finished with the current job. Guarded by m_Mutex.
+	};
+}